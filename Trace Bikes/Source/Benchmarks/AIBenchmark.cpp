@@ -0,0 +1,175 @@
+#include "Benchmarks.h"
+#include "../TraceSim/BikeAI.h"
+#include <algorithm>
+#include <fstream>
+
+namespace GameDev2D
+{
+	struct AIScenario
+	{
+		const char* name;
+		unsigned int players;
+		unsigned int aiplayers; // The first players are the AI's, the rest are scripted.
+	};
+
+	const AIScenario AI_BENCHMARK_SCENARIOS[] =
+	{
+		{ "ai_vs_scripted", 2, 1 },
+		{ "ai_vs_ai", 2, 2 },
+		{ "8_ai", 8, 8 },
+	};
+
+	const unsigned int AI_BENCHMARK_ROUNDS = 10;
+	const float AI_BENCHMARK_ARENA_WIDTH = 1024.0f;
+	const float AI_BENCHMARK_ARENA_HEIGHT = 768.0f;
+	const double AI_BENCHMARK_OVERSHOOT_TOLERANCE = AI_TICK_BUDGET / 10.0; // A tick is over budget past this, a search notices the deadline a position late.
+
+	struct AIScenarioResult
+	{
+		unsigned int rounds;
+		unsigned long long ticks;
+		std::vector<double> searchseconds;
+		std::vector<unsigned int> depths;
+		unsigned long long evaluations;
+		std::vector<double> overshoots; // How far each tick's searches ran past the tick's budget, in seconds, negative if they finished early.
+		unsigned int aiwins;
+		unsigned int scriptedwins;
+		unsigned int draws;
+	};
+
+	// Plays the rounds with the AI deciding on the benchmark's thread, the way the AIController's worker does: once
+	// per cell a bike enters, with the tick's budget split between the bikes deciding in it.
+	static void PlayAIScenario(const AIScenario& scenario, AIScenarioResult& result)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		TraceSim sim(AI_BENCHMARK_ARENA_WIDTH, AI_BENCHMARK_ARENA_HEIGHT, scenario.players);
+		AISnapshot snapshot(sim);
+		BikeAI ai(sim);
+		Clock::duration tickbudget = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(AI_TICK_BUDGET));
+
+		std::vector<int> decidedcolumns(scenario.players, -1);
+		std::vector<int> decidedrows(scenario.players, -1);
+		std::vector<int> decideddirections(scenario.players, 0);
+		std::vector<unsigned int> deciding;
+		std::vector<TurnInput> inputs;
+		unsigned int seed = 1;
+
+		while (result.rounds < AI_BENCHMARK_ROUNDS)
+		{
+			inputs.clear();
+			snapshot.Take(sim);
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				deciding.clear();
+				TurnInput input;
+				for (unsigned int player = 0; player < scenario.players; player++)
+				{
+					if (player >= scenario.aiplayers)
+					{
+						if (ScriptBenchmarkTurn(sim, player, seed, input))
+							inputs.push_back(input);
+						continue;
+					}
+
+					int direction = snapshot.directionx[player] * 2 + snapshot.directiony[player] * 4;
+					if (!snapshot.alive[player] || (snapshot.columns[player] == decidedcolumns[player] && snapshot.rows[player] == decidedrows[player] &&
+						direction == decideddirections[player])) continue;
+
+					decidedcolumns[player] = snapshot.columns[player];
+					decidedrows[player] = snapshot.rows[player];
+					decideddirections[player] = direction;
+					deciding.push_back(player);
+				}
+
+				Clock::time_point tickdeadline = Clock::now() + tickbudget;
+				for (unsigned int index = 0; index < deciding.size(); index++)
+				{
+					Clock::time_point start = Clock::now();
+					Clock::time_point deadline = start + (tickdeadline - start) / (long long)(deciding.size() - index);
+
+					input.player = deciding[index];
+					input.time = 0.0f;
+					if (ai.ChooseTurn(snapshot, deciding[index], deadline, input.direction))
+						inputs.push_back(input);
+
+					result.searchseconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+					result.depths.push_back(ai.GetLastDepth());
+					result.evaluations += ai.GetLastEvaluations();
+				}
+
+				if (!deciding.empty())
+					result.overshoots.push_back(std::chrono::duration<double>(Clock::now() - tickdeadline).count());
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			result.ticks++;
+
+			if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				const BikeStates& bikes = sim.GetBikes();
+				unsigned int winner = scenario.players;
+				for (unsigned int player = 0; player < scenario.players; player++)
+				{
+					if (bikes.alive[player])
+						winner = player;
+				}
+
+				if (winner == scenario.players)
+					result.draws++;
+				else if (winner < scenario.aiplayers)
+					result.aiwins++;
+				else
+					result.scriptedwins++;
+
+				result.rounds++;
+				sim.Reset();
+				std::fill(decidedcolumns.begin(), decidedcolumns.end(), -1);
+			}
+		}
+	}
+
+	void RunAIBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		// The overshoot's maximum includes the times the thread was preempted mid search, the percentiles show
+		// wether the budget holds.
+		output << "scenario,players,ai_players,rounds,ticks,searches,budget_us,search_us_mean,search_us_p99,search_us_max,overshoot_us_p99,"
+			"overshoot_us_p999,overshoot_us_max,ticks_over_budget,"
+			"depth_min,depth_mean,depth_max,evaluations_per_search,ai_wins,scripted_wins,draws" << std::endl;
+
+		for (const AIScenario& scenario : AI_BENCHMARK_SCENARIOS)
+		{
+			AIScenarioResult result = AIScenarioResult();
+			PlayAIScenario(scenario, result);
+
+			size_t searches = result.searchseconds.size();
+			std::vector<double> sorted = result.searchseconds;
+			std::sort(sorted.begin(), sorted.end());
+
+			double totalseconds = 0.0;
+			unsigned long long depthsum = 0;
+			for (size_t search = 0; search < searches; search++)
+			{
+				totalseconds += result.searchseconds[search];
+				depthsum += result.depths[search];
+			}
+
+			std::vector<double> overshoots = result.overshoots;
+			std::sort(overshoots.begin(), overshoots.end());
+			size_t deciding = overshoots.size();
+			size_t overbudget = overshoots.end() - std::upper_bound(overshoots.begin(), overshoots.end(), AI_BENCHMARK_OVERSHOOT_TOLERANCE);
+
+			unsigned int mindepth = searches > 0 ? *std::min_element(result.depths.begin(), result.depths.end()) : 0;
+			unsigned int maxdepth = searches > 0 ? *std::max_element(result.depths.begin(), result.depths.end()) : 0;
+			double divisor = (double)std::max(searches, (size_t)1);
+
+			output << scenario.name << "," << scenario.players << "," << scenario.aiplayers << "," << result.rounds << "," << result.ticks << "," << searches << ","
+				<< AI_TICK_BUDGET * 1e6 << "," << totalseconds / divisor * 1e6 << "," << (searches > 0 ? sorted[searches * 99 / 100] * 1e6 : 0.0) << ","
+				<< (searches > 0 ? sorted.back() * 1e6 : 0.0) << "," << (deciding > 0 ? overshoots[deciding * 99 / 100] * 1e6 : 0.0) << ","
+				<< (deciding > 0 ? overshoots[deciding * 999 / 1000] * 1e6 : 0.0) << "," << (deciding > 0 ? overshoots.back() * 1e6 : 0.0) << "," << overbudget << "," << mindepth << "," << depthsum / divisor << ","
+				<< maxdepth << "," << result.evaluations / divisor << "," << result.aiwins << "," << result.scriptedwins << "," << result.draws << std::endl;
+		}
+	}
+}
@@ -0,0 +1,260 @@
+#include "Benchmarks.h"
+#include "../TraceSim/Replay.h"
+#include "../TraceSim/TraceSim.h"
+#include "../TraceSim/WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace GameDev2D
+{
+	const char* const BATCH_MATCHES_PATH = "BatchMatches.csv"; // Every match of the run on all the hardware threads.
+	const unsigned int BATCH_SCRIPTED_MATCHES = 4096;
+	const unsigned int BATCH_REPLAY_MATCHES = 64; // Replays are played whole, a match the game recorded can be long.
+	const unsigned int BATCH_PLAYERS = PLAYER_COUNT;
+	const float BATCH_ARENA_WIDTH = 1024.0f;
+	const float BATCH_ARENA_HEIGHT = 768.0f;
+	const unsigned int BATCH_MATCH_WINS = 3; // A scripted match is won by the first player to win 3 rounds,
+	const unsigned int BATCH_MATCH_MAX_ROUNDS = 9; // or ends in a draw after 9.
+	const unsigned int BATCH_NO_WINNER = UINT_MAX;
+
+	struct BatchMatchResult
+	{
+		unsigned int rounds;
+		unsigned int ticks;
+		unsigned int winner; // BATCH_NO_WINNER for a draw.
+		unsigned long long statehash; // Every tick's state hash folded together, for comparing the runs.
+		bool desynced;
+		double seconds;
+	};
+
+	// Returns the player left alive at the end of a round, or BATCH_NO_WINNER if it was a tie.
+	static unsigned int GetRoundWinner(const TraceSim& sim)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+		{
+			if (bikes.alive[player])
+				return player;
+		}
+		return BATCH_NO_WINNER;
+	}
+
+	// Plays scripted rounds until one player has won the match. Each match drives its players from its own seed,
+	// so it plays out the same on any thread.
+	static void PlayScriptedMatch(unsigned int seed, BatchMatchResult& result)
+	{
+		TraceSim sim(BATCH_ARENA_WIDTH, BATCH_ARENA_HEIGHT, BATCH_PLAYERS);
+		std::vector<TurnInput> inputs;
+		inputs.reserve(BATCH_PLAYERS);
+
+		unsigned int wins[BATCH_PLAYERS] = {};
+		result.winner = BATCH_NO_WINNER;
+
+		while (result.winner == BATCH_NO_WINNER && result.rounds < BATCH_MATCH_MAX_ROUNDS)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < BATCH_PLAYERS; player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			result.statehash = FoldStateHash(result.statehash, sim.GetStateHash());
+			result.ticks++;
+
+			if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				unsigned int winner = GetRoundWinner(sim);
+				if (winner != BATCH_NO_WINNER && ++wins[winner] == BATCH_MATCH_WINS)
+					result.winner = winner;
+
+				result.rounds++;
+				sim.Reset();
+			}
+		}
+	}
+
+	// Plays a recorded match whole, the winner is the player that won the most rounds.
+	static void PlayReplayMatch(const ReplayFile& replay, BatchMatchResult& result)
+	{
+		const ReplayHeader& header = replay.GetHeader();
+		TraceSim sim(header.arenawidth, header.arenaheight, header.playercount);
+		ReplayPlayer player(replay, sim);
+
+		std::vector<unsigned int> wins(header.playercount, 0);
+		RoundState roundstate = sim.GetRoundState();
+
+		while (player.StepTick())
+		{
+			result.statehash = FoldStateHash(result.statehash, sim.GetStateHash());
+			result.ticks++;
+
+			if (roundstate != RoundState::GameOver && sim.GetRoundState() == RoundState::GameOver)
+			{
+				unsigned int winner = GetRoundWinner(sim);
+				if (winner != BATCH_NO_WINNER)
+					wins[winner]++;
+				result.rounds++;
+			}
+			roundstate = sim.GetRoundState();
+		}
+
+		result.desynced = player.IsDesynced();
+		result.winner = BATCH_NO_WINNER;
+
+		unsigned int mostwins = 0;
+		for (unsigned int index = 0; index < header.playercount; index++)
+		{
+			if (wins[index] > mostwins)
+			{
+				mostwins = wins[index];
+				result.winner = index;
+			}
+			else if (wins[index] == mostwins)
+			{
+				result.winner = BATCH_NO_WINNER;
+			}
+		}
+	}
+
+	// Plays every match on the pool, one task per match, and returns the wall clock time of the whole batch.
+	static double RunBatch(WorkStealingPool& pool, const ReplayFile* replay, std::vector<BatchMatchResult>& results)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		Clock::time_point start = Clock::now();
+
+		for (unsigned int match = 0; match < results.size(); match++)
+		{
+			BatchMatchResult* result = &results[match];
+
+			pool.Submit([replay, match, result]()
+			{
+				Clock::time_point matchstart = Clock::now();
+
+				*result = BatchMatchResult();
+				if (replay != nullptr)
+					PlayReplayMatch(*replay, *result);
+				else
+					PlayScriptedMatch(match + 1, *result);
+
+				result->seconds = std::chrono::duration<double>(Clock::now() - matchstart).count();
+			});
+		}
+
+		pool.Wait();
+
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	static void WriteMatchReport(const std::vector<BatchMatchResult>& results, bool isreplay)
+	{
+		std::ofstream output(BATCH_MATCHES_PATH);
+		output << "match,seed,rounds,ticks,winner,seconds,state_hash,desynced" << std::endl;
+
+		for (unsigned int match = 0; match < results.size(); match++)
+		{
+			const BatchMatchResult& result = results[match];
+
+			output << match << ",";
+			if (!isreplay)
+				output << match + 1;
+			output << "," << result.rounds << "," << result.ticks << ",";
+			if (result.winner != BATCH_NO_WINNER)
+				output << result.winner;
+			output << "," << result.seconds << "," << std::hex << result.statehash << std::dec << "," << result.desynced << std::endl;
+		}
+	}
+
+	// Plays the batch on every thread count, the matches are scripted without a replay.
+	static void RunBatches(const std::string& outputpath, const ReplayFile* replay, const std::string& inputname)
+	{
+		bool isreplay = replay != nullptr;
+		unsigned int matchcount = isreplay ? BATCH_REPLAY_MATCHES : BATCH_SCRIPTED_MATCHES;
+
+		// Powers of two up to every hardware thread.
+		unsigned int hardwarethreads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<unsigned int> threadcounts;
+		for (unsigned int threads = 1; threads < hardwarethreads; threads *= 2)
+			threadcounts.push_back(threads);
+		threadcounts.push_back(hardwarethreads);
+
+		std::ofstream output(outputpath);
+		output << "input,threads,matches,seconds,matches_per_second,matches_per_second_per_thread,scaling_efficiency,steals,"
+			"match_ms_min,match_ms_mean,match_ms_max,rounds,ticks,draws,identical_results" << std::endl;
+
+		std::vector<BatchMatchResult> firstresults;
+		double singlethreadrate = 0.0;
+
+		for (unsigned int threads : threadcounts)
+		{
+			std::vector<BatchMatchResult> results(matchcount);
+			WorkStealingPool pool(threads);
+
+			double seconds = RunBatch(pool, replay, results);
+			double rate = matchcount / seconds;
+			if (threads == 1)
+				singlethreadrate = rate;
+
+			double minseconds = results[0].seconds;
+			double maxseconds = 0.0;
+			double totalseconds = 0.0;
+			unsigned long long rounds = 0;
+			unsigned long long ticks = 0;
+			unsigned int draws = 0;
+			for (const BatchMatchResult& result : results)
+			{
+				minseconds = std::min(minseconds, result.seconds);
+				maxseconds = std::max(maxseconds, result.seconds);
+				totalseconds += result.seconds;
+				rounds += result.rounds;
+				ticks += result.ticks;
+				if (result.winner == BATCH_NO_WINNER)
+					draws++;
+			}
+
+			// The matches must come out the same however they were spread over the threads.
+			bool identical = true;
+			if (firstresults.empty())
+				firstresults = results;
+			for (unsigned int match = 0; match < matchcount; match++)
+			{
+				if (results[match].statehash != firstresults[match].statehash || results[match].winner != firstresults[match].winner || results[match].desynced)
+					identical = false;
+			}
+
+			output << inputname << "," << threads << "," << matchcount << "," << seconds << "," << rate << "," << rate / threads << ","
+				<< rate / (singlethreadrate * threads) << "," << pool.GetStealCount() << "," << minseconds * 1000.0 << "," << totalseconds / matchcount * 1000.0 << ","
+				<< maxseconds * 1000.0 << "," << rounds << "," << ticks << "," << draws << "," << identical << std::endl;
+
+			if (threads == hardwarethreads)
+				WriteMatchReport(results, isreplay);
+		}
+	}
+
+	void RunBatchBenchmark(const std::string& outputpath)
+	{
+		RunBatches(outputpath, nullptr, "scripted");
+	}
+
+	void RunBatchReplayBenchmark(const std::string& outputpath, const std::string& replaypath)
+	{
+		ReplayFile replay;
+		if (!replay.Open(replaypath))
+		{
+			std::ofstream output(outputpath);
+			output << "error" << std::endl << replaypath << " isn't a replay" << std::endl;
+			return;
+		}
+
+		RunBatches(outputpath, &replay, replaypath);
+	}
+}
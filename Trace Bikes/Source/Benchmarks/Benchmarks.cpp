@@ -0,0 +1,61 @@
+#include "Benchmarks.h"
+#include <sstream>
+
+namespace GameDev2D
+{
+	struct BenchmarkEntry
+	{
+		const char* name;
+		void (*run)(const std::string& outputpath);
+		void (*runreplay)(const std::string& outputpath, const std::string& replaypath); // Null if it can't play a replay.
+	};
+
+	const BenchmarkEntry BENCHMARKS[] =
+	{
+		{ "TrailCollision", RunTrailCollisionBenchmark, nullptr },
+		{ "Simulation", RunSimulationBenchmark, nullptr },
+		{ "TrailMemory", RunTrailMemoryBenchmark, nullptr },
+		{ "EventDispatch", RunEventDispatchBenchmark, nullptr },
+		{ "InputLatency", RunInputLatencyBenchmark, nullptr },
+		{ "Replay", RunReplayBenchmark, nullptr },
+		{ "Batch", RunBatchBenchmark, RunBatchReplayBenchmark },
+		{ "Bitboard", RunBitboardBenchmark, nullptr },
+		{ "AI", RunAIBenchmark, nullptr },
+		{ "Rollback", RunRollbackBenchmark, nullptr },
+		{ "TrailBuffer", RunTrailBufferBenchmark, nullptr },
+		{ "LargeArena", RunLargeArenaBenchmark, nullptr },
+		{ "Broadphase", RunBroadphaseBenchmark, nullptr },
+		{ "Server", RunServerBenchmark, nullptr },
+		{ "Snapshot", RunSnapshotBenchmark, nullptr },
+	};
+
+	bool RunBenchmarkFromCommandLine(const std::string& commandline)
+	{
+		std::stringstream arguments(commandline);
+		std::string argument;
+		std::string name;
+		std::string replaypath;
+
+		while (arguments >> argument)
+		{
+			if (argument == "-benchmark")
+				arguments >> name;
+			else if (argument == "-replay")
+				arguments >> replaypath;
+		}
+
+		for (const BenchmarkEntry& benchmark : BENCHMARKS)
+		{
+			if (name == benchmark.name)
+			{
+				if (!replaypath.empty() && benchmark.runreplay != nullptr)
+					benchmark.runreplay(name + "Benchmark.csv", replaypath);
+				else
+					benchmark.run(name + "Benchmark.csv");
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+
+namespace GameDev2D
+{
+	class TraceSim;
+	struct TurnInput;
+
+	// Runs the benchmark named on the command line ("-benchmark <name>") and writes its results to
+	// <name>Benchmark.csv in the working directory. The benchmarks that can play a recorded match play the one
+	// given with "-replay <path>", if any. Returns false if no benchmark was requested.
+	bool RunBenchmarkFromCommandLine(const std::string& commandline);
+
+	// Plays a scripted 10 minute round and reports the per-frame cost of the linked list trail
+	// collision walk, the TrailGrid lookup and the trail run tests, as the trails grow.
+	void RunTrailCollisionBenchmark(const std::string& outputpath);
+
+	// Steps a headless TraceSim through scripted rounds with 2, 8 and 64 players and reports simulation ticks
+	// per second for each, hashing the state every tick. The hashes only match the last run's if it played out
+	// the same.
+	void RunSimulationBenchmark(const std::string& outputpath);
+
+	// Plays 10 minutes of scripted rounds and reports, for every minute, the memory held by the trails' runs and
+	// an estimate of the canvas tiles and OpenGL objects the game draws them with, against an estimate of one
+	// Sprite per 8 pixel trail segment.
+	void RunTrailMemoryBenchmark(const std::string& outputpath);
+
+	// Dispatches an event through 10k listeners and reports the cost per dispatch of the old linear
+	// handler scan against the EventDispatcher's per event code handler lists.
+	void RunEventDispatchBenchmark(const std::string& outputpath);
+
+	// Presses the game's turn keys through the InputManager from one producer thread per player and reports the
+	// latency from the key press until the simulation step that applies the turn, with the GameLoop's fixed
+	// updates run back to back at the start of every frame, at the target frame rate and at a higher one.
+	void RunInputLatencyBenchmark(const std::string& outputpath);
+
+	// Memory-maps the match the game last recorded, or records ten minutes of scripted rounds if there's none, and
+	// reports how much faster than real time the replay plays headless, hashing the state every tick, and wether it
+	// played out the same.
+	void RunReplayBenchmark(const std::string& outputpath);
+
+	// Plays a batch of headless scripted matches on a work-stealing pool of 1, 2, 4... threads up to every
+	// hardware thread, and reports the matches per second per thread and wether every match came out the same.
+	// Every match of the last run is written to BatchMatches.csv.
+	void RunBatchBenchmark(const std::string& outputpath);
+
+	// The same, with every match played from a replay. Only reports an error if the file isn't a replay.
+	void RunBatchReplayBenchmark(const std::string& outputpath, const std::string& replaypath);
+
+	// Takes the arena's bitboard at the end of scripted rounds with 2, 8 and 64 players, and reports the cost of
+	// reachable area counts and territory splits with every kernel the processor supports, against a breadth
+	// first search a cell at a time.
+	void RunBitboardBenchmark(const std::string& outputpath);
+
+	// Plays rounds of an AI bike against a scripted one, two AI bikes, and eight, with the AI searching within its
+	// per-tick budget, and reports the time each search took, how far the ticks ran past the budget, the depth
+	// the searches reached and the rounds the AI won.
+	void RunAIBenchmark(const std::string& outputpath);
+
+	// Plays a minute of scripted rounds with 2, 8 and 64 players, and of 8 and 64 bikes laying long serpentine
+	// trails, rolling back to the start of every frame and playing it again. Reports the cost of 60 saves per
+	// frame, and of 60 restores each with the step after it, with snapshots against copying the whole sim, and
+	// wether the rolled back frames came out the same.
+	void RunRollbackBenchmark(const std::string& outputpath);
+
+	// Lays trails of 64, 1k and 16k runs a round and clears them, and reports the cost per run added and per reset
+	// of a linked list of heap nodes, a std::vector and the TrailBuffer ring, with and without a fading limit. Then
+	// plays an hour of scripted rounds and reports the most memory the trails held, with and without the limit.
+	void RunTrailBufferBenchmark(const std::string& outputpath);
+
+	// Plays ten minutes of rounds with 8 bikes that steer clear of the trails, in arenas 1, 2, 4 and 8 screens on a
+	// side, and reports the ticks per second, how long the trails grew, and the chunks and canvas tiles they were
+	// filed in and drawn on against the whole arena's.
+	void RunLargeArenaBenchmark(const std::string& outputpath);
+
+	// Plays a minute of scripted rounds with 64 and 256 bikes, and reports the cost per tick of finding the pairs
+	// of bike heads whose boxes overlap by testing every pair, by sweep and prune sorted from scratch, and by the
+	// sim's sweep and prune kept sorted between ticks, wether they found the same pairs, and the sim's ticks per
+	// second.
+	void RunBroadphaseBenchmark(const std::string& outputpath);
+
+	// Hosts 256, 1k and 4k matches on a loopback MatchServer, played for 10 seconds by LoopbackBots in the same
+	// process, and reports the matches a core could keep stepping, the server's tick latency percentiles and the
+	// time from a bot's turn until its bike was seen turning.
+	void RunServerBenchmark(const std::string& outputpath);
+
+	// Plays a minute of scripted rounds with 2, 8 and 64 players for a client on a LAN and on links with 100 ms round
+	// trips and lost snapshots, and reports the bytes per tick and the encode and decode cost of delta snapshots
+	// against serializing the whole state every tick, and wether the client rebuilt the sim's state from every
+	// snapshot it got.
+	void RunSnapshotBenchmark(const std::string& outputpath);
+
+	// Scripted driver shared by the benchmarks: steers away from the arena walls, otherwise turns at random.
+	// Returns false if the player doesn't turn this tick, or has crashed.
+	bool ScriptBenchmarkTurn(const TraceSim& sim, unsigned int player, unsigned int& seed, TurnInput& input);
+}
@@ -0,0 +1,235 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	struct BitboardScenario
+	{
+		unsigned int players;
+		float arenawidth;
+		float arenaheight;
+	};
+
+	const BitboardScenario BITBOARD_BENCHMARK_SCENARIOS[] =
+	{
+		{ 2, 1024.0f, 768.0f },
+		{ 8, 1024.0f, 768.0f },
+		{ 64, 4096.0f, 3072.0f },
+	};
+
+	const unsigned int BITBOARD_BENCHMARK_REACHABLE_QUERIES = 10000;
+	const unsigned int BITBOARD_BENCHMARK_TERRITORY_QUERIES = 1000;
+	const int BITBOARD_NOT_REACHED = -1;
+	const int BITBOARD_CONTESTED = -2;
+
+	// The arena and the bikes' cells at the end of a scripted round, when the trails cover the most of it.
+	struct BitboardSnapshot
+	{
+		BitboardArena arena;
+		std::vector<int> columns;
+		std::vector<int> rows;
+	};
+
+	static BitboardSnapshot PlayScriptedRound(const BitboardScenario& scenario)
+	{
+		TraceSim sim(scenario.arenawidth, scenario.arenaheight, scenario.players);
+		std::vector<TurnInput> inputs;
+		unsigned int seed = 1;
+
+		while (sim.GetRoundState() != RoundState::GameOver)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < scenario.players; player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+		}
+
+		std::vector<int> columns;
+		std::vector<int> rows;
+		for (unsigned int player = 0; player < scenario.players; player++)
+		{
+			columns.push_back((int)(sim.GetBikes().x[player] / ARENA_CELL_SIZE));
+			rows.push_back((int)(sim.GetBikes().y[player] / ARENA_CELL_SIZE));
+		}
+
+		BitboardSnapshot snapshot = { sim.GetArena(), columns, rows };
+		return snapshot;
+	}
+
+	// The reference the bitboard queries are checked against, a breadth first search over a cell at a time.
+	class ReferenceArena
+	{
+	public:
+		ReferenceArena(const BitboardArena& arena) :
+			m_Columns(arena.GetColumns()),
+			m_Rows(arena.GetRows())
+		{
+			m_Open.resize(m_Columns * m_Rows);
+			m_Owners.resize(m_Columns * m_Rows);
+			m_Layers.resize(m_Columns * m_Rows);
+
+			for (int row = 0; row < m_Rows; row++)
+			{
+				for (int column = 0; column < m_Columns; column++)
+					m_Open[row * m_Columns + column] = arena.IsOpen(column, row) ? 1 : 0;
+			}
+		}
+
+		unsigned int CountReachable(int column, int row)
+		{
+			int sources[] = { column };
+			int sourcerows[] = { row };
+			unsigned int territory = 0;
+			GetTerritory(sources, sourcerows, 1, &territory);
+			return territory;
+		}
+
+		// Grows every source a layer at a time, a cell reached in the same layer by two sources is contested and
+		// grows no further.
+		void GetTerritory(const int* columns, const int* rows, unsigned int count, unsigned int* territories)
+		{
+			std::fill(m_Owners.begin(), m_Owners.end(), BITBOARD_NOT_REACHED);
+			m_Frontier.clear();
+
+			for (unsigned int source = 0; source < count; source++)
+			{
+				territories[source] = 0;
+				if (columns[source] < 0 || columns[source] >= m_Columns || rows[source] < 0 || rows[source] >= m_Rows) continue;
+
+				int cell = rows[source] * m_Columns + columns[source];
+				m_Owners[cell] = (int)source;
+				m_Layers[cell] = 0;
+				m_Frontier.push_back(cell);
+			}
+
+			for (int layer = 1; !m_Frontier.empty(); layer++)
+			{
+				m_Next.clear();
+
+				for (int cell : m_Frontier)
+				{
+					int owner = m_Owners[cell];
+					if (owner == BITBOARD_CONTESTED) continue;
+
+					int column = cell % m_Columns;
+					int row = cell / m_Columns;
+					int neighbours[] = { column > 0 ? cell - 1 : -1, column < m_Columns - 1 ? cell + 1 : -1, row > 0 ? cell - m_Columns : -1, row < m_Rows - 1 ? cell + m_Columns : -1 };
+
+					for (int neighbour : neighbours)
+					{
+						if (neighbour < 0 || !m_Open[neighbour]) continue;
+
+						if (m_Owners[neighbour] == BITBOARD_NOT_REACHED)
+						{
+							m_Owners[neighbour] = owner;
+							m_Layers[neighbour] = layer;
+							m_Next.push_back(neighbour);
+						}
+						else if (m_Layers[neighbour] == layer && m_Owners[neighbour] != owner)
+						{
+							m_Owners[neighbour] = BITBOARD_CONTESTED;
+						}
+					}
+				}
+
+				m_Frontier.swap(m_Next);
+			}
+
+			for (size_t cell = 0; cell < m_Owners.size(); cell++)
+			{
+				if (m_Open[cell] && m_Owners[cell] >= 0)
+					territories[m_Owners[cell]]++;
+			}
+		}
+
+	private:
+		int m_Columns;
+		int m_Rows;
+		std::vector<unsigned char> m_Open;
+		std::vector<int> m_Owners;
+		std::vector<int> m_Layers;
+		std::vector<int> m_Frontier;
+		std::vector<int> m_Next;
+	};
+
+	// Runs the queries on the reference, or on the bitboard with a kernel, and returns the sum of their results.
+	template<typename Arena>
+	static unsigned long long RunQueries(Arena& arena, const BitboardSnapshot& snapshot, bool isterritory, unsigned int queries)
+	{
+		unsigned int players = (unsigned int)snapshot.columns.size();
+		std::vector<unsigned int> territories(players);
+		unsigned long long sum = 0;
+
+		for (unsigned int query = 0; query < queries; query++)
+		{
+			if (isterritory)
+			{
+				arena.GetTerritory(snapshot.columns.data(), snapshot.rows.data(), players, territories.data());
+				for (unsigned int territory : territories)
+					sum += territory;
+			}
+			else
+			{
+				unsigned int player = query % players;
+				sum += arena.CountReachable(snapshot.columns[player], snapshot.rows[player]);
+			}
+		}
+
+		return sum;
+	}
+
+	void RunBitboardBenchmark(const std::string& outputpath)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		const char* kernelnames[] = { "scalar", "sse2", "avx2" };
+		const BitboardKernel kernels[] = { BitboardKernel::Scalar, BitboardKernel::SSE2, BitboardKernel::AVX2 };
+
+		std::ofstream output(outputpath);
+		output << "players,columns,rows,open_cells,query,implementation,queries,seconds,ns_per_query,speedup,result_sum,matches_reference" << std::endl;
+
+		for (const BitboardScenario& scenario : BITBOARD_BENCHMARK_SCENARIOS)
+		{
+			BitboardSnapshot snapshot = PlayScriptedRound(scenario);
+			BitboardArena& arena = snapshot.arena;
+			ReferenceArena reference(arena);
+
+			for (int isterritory = 0; isterritory < 2; isterritory++)
+			{
+				const char* queryname = isterritory ? "territory" : "reachable";
+				unsigned int queries = isterritory ? BITBOARD_BENCHMARK_TERRITORY_QUERIES : BITBOARD_BENCHMARK_REACHABLE_QUERIES;
+
+				Clock::time_point start = Clock::now();
+				unsigned long long referencesum = RunQueries(reference, snapshot, isterritory != 0, queries);
+				double referenceseconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+				output << scenario.players << "," << arena.GetColumns() << "," << arena.GetRows() << "," << arena.GetOpenCount() << "," << queryname << ",reference,"
+					<< queries << "," << referenceseconds << "," << referenceseconds / queries * 1e9 << ",1," << referencesum << ",1" << std::endl;
+
+				for (unsigned int kernel = 0; kernel < 3; kernel++)
+				{
+					if (!arena.SetKernel(kernels[kernel])) continue;
+
+					start = Clock::now();
+					unsigned long long sum = RunQueries(arena, snapshot, isterritory != 0, queries);
+					double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+					output << scenario.players << "," << arena.GetColumns() << "," << arena.GetRows() << "," << arena.GetOpenCount() << "," << queryname << ","
+						<< kernelnames[kernel] << "," << queries << "," << seconds << "," << seconds / queries * 1e9 << "," << referenceseconds / seconds << ","
+						<< sum << "," << (sum == referencesum) << std::endl;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,200 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const unsigned int BROADPHASE_BENCHMARK_PLAYER_COUNTS[] = { 64, 256 };
+	const unsigned int BROADPHASE_BENCHMARK_TICKS = (unsigned int)FIXED_TICK_RATE * 60; // A minute of play for each player count.
+	const float BROADPHASE_BENCHMARK_ARENA_WIDTH = 1024.0f;
+	const float BROADPHASE_BENCHMARK_LANE_HEIGHT = 64.0f; // The Simulation benchmark's arenas, two bikes per lane.
+	const float BROADPHASE_BENCHMARK_REACH = 0.25f; // Seconds ahead the boxes cover, so bikes about to meet pair up.
+
+	enum class BroadphaseMethod
+	{
+		BruteForce,
+		FullSort,
+		Incremental
+	};
+
+	const char* const BROADPHASE_METHOD_NAMES[] = { "brute_force", "full_sort", "incremental" };
+
+	static bool IsOverlapping(const BroadphaseBox& a, const BroadphaseBox& b)
+	{
+		return a.minx <= b.maxx && b.minx <= a.maxx && a.miny <= b.maxy && b.miny <= a.maxy;
+	}
+
+	static bool IsPairBefore(const BroadphasePair& a, const BroadphasePair& b)
+	{
+		return a.first != b.first ? a.first < b.first : a.second < b.second;
+	}
+
+	// Every box against every other.
+	static void FindPairsBruteForce(const std::vector<BroadphaseBox>& boxes, const std::vector<unsigned char>& active, std::vector<BroadphasePair>& pairs)
+	{
+		pairs.clear();
+		unsigned int count = (unsigned int)boxes.size();
+
+		for (unsigned int first = 0; first < count; first++)
+		{
+			if (!active[first]) continue;
+
+			for (unsigned int second = first + 1; second < count; second++)
+			{
+				if (active[second] && IsOverlapping(boxes[first], boxes[second]))
+				{
+					BroadphasePair pair = { first, second };
+					pairs.push_back(pair);
+				}
+			}
+		}
+	}
+
+	// Sweep and prune without keeping the order, the live boxes are sorted from scratch every tick.
+	static void FindPairsFullSort(const std::vector<BroadphaseBox>& boxes, const std::vector<unsigned char>& active, std::vector<unsigned int>& order,
+		std::vector<BroadphasePair>& pairs)
+	{
+		order.clear();
+		for (unsigned int index = 0; index < boxes.size(); index++)
+		{
+			if (active[index])
+				order.push_back(index);
+		}
+
+		std::sort(order.begin(), order.end(), [&boxes](unsigned int a, unsigned int b) { return boxes[a].miny < boxes[b].miny; });
+
+		pairs.clear();
+		for (size_t place = 0; place < order.size(); place++)
+		{
+			const BroadphaseBox& box = boxes[order[place]];
+			for (size_t next = place + 1; next < order.size() && boxes[order[next]].miny <= box.maxy; next++)
+			{
+				const BroadphaseBox& otherbox = boxes[order[next]];
+				if (otherbox.maxx < box.minx || otherbox.minx > box.maxx) continue;
+
+				BroadphasePair pair = { std::min(order[place], order[next]), std::max(order[place], order[next]) };
+				pairs.push_back(pair);
+			}
+		}
+	}
+
+	static void RunBroadphaseScenario(std::ofstream& output, unsigned int playercount)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		float arenaheight = (playercount + 1) / 2 * BROADPHASE_BENCHMARK_LANE_HEIGHT;
+		TraceSim sim(BROADPHASE_BENCHMARK_ARENA_WIDTH, arenaheight, playercount);
+		SweepAndPrune broadphase(playercount);
+
+		std::vector<TurnInput> inputs;
+		std::vector<BroadphaseBox> boxes(playercount);
+		std::vector<unsigned char> active(playercount);
+		std::vector<unsigned int> order;
+		std::vector<BroadphasePair> pairs[3];
+		std::vector<BroadphasePair> expected;
+
+		unsigned int seed = 1;
+		unsigned int rounds = 0;
+		unsigned long long pairtotal = 0;
+		unsigned long long swaptotal = 0;
+		unsigned int matching[3] = {};
+		double seconds[3] = {};
+		double simseconds = 0.0;
+		int margin = ToFixed(BIKE_SIZE * 0.5f + BIKE_SPEED * BROADPHASE_BENCHMARK_REACH);
+
+		for (unsigned int tick = 0; tick < BROADPHASE_BENCHMARK_TICKS; tick++)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < playercount; player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+			else if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				sim.Reset();
+				rounds++;
+			}
+
+			Clock::time_point start = Clock::now();
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			simseconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+			// The heads' boxes over the tick, from where each bike was to where it is and as far as it gets in the reach
+			// either way, outside the timing.
+			const BikeStates& bikes = sim.GetBikes();
+			for (unsigned int player = 0; player < playercount; player++)
+			{
+				int previousx = ToFixed(bikes.previousx[player]);
+				int previousy = ToFixed(bikes.previousy[player]);
+				BroadphaseBox box = { std::min(previousx, bikes.fixedx[player]) - margin, std::min(previousy, bikes.fixedy[player]) - margin,
+					std::max(previousx, bikes.fixedx[player]) + margin, std::max(previousy, bikes.fixedy[player]) + margin };
+				boxes[player] = box;
+				active[player] = bikes.alive[player];
+			}
+
+			start = Clock::now();
+			FindPairsBruteForce(boxes, active, pairs[(int)BroadphaseMethod::BruteForce]);
+			Clock::time_point end = Clock::now();
+			seconds[(int)BroadphaseMethod::BruteForce] += std::chrono::duration<double>(end - start).count();
+
+			start = Clock::now();
+			FindPairsFullSort(boxes, active, order, pairs[(int)BroadphaseMethod::FullSort]);
+			end = Clock::now();
+			seconds[(int)BroadphaseMethod::FullSort] += std::chrono::duration<double>(end - start).count();
+
+			start = Clock::now();
+			for (unsigned int player = 0; player < playercount; player++)
+			{
+				if (active[player])
+					broadphase.SetBox(player, boxes[player]);
+				else
+					broadphase.RemoveBox(player);
+			}
+			broadphase.Sort();
+			broadphase.FindPairs();
+			end = Clock::now();
+			seconds[(int)BroadphaseMethod::Incremental] += std::chrono::duration<double>(end - start).count();
+			pairs[(int)BroadphaseMethod::Incremental] = broadphase.GetPairs();
+
+			// Every method has to find the same pairs, in any order.
+			for (std::vector<BroadphasePair>& found : pairs)
+				std::sort(found.begin(), found.end(), IsPairBefore);
+
+			expected = pairs[(int)BroadphaseMethod::BruteForce];
+			for (unsigned int method = 0; method < 3; method++)
+			{
+				bool issame = pairs[method].size() == expected.size();
+				for (size_t index = 0; issame && index < expected.size(); index++)
+					issame = pairs[method][index].first == expected[index].first && pairs[method][index].second == expected[index].second;
+				matching[method] += issame;
+			}
+
+			pairtotal += expected.size();
+			swaptotal += broadphase.GetSwapCount();
+		}
+
+		for (unsigned int method = 0; method < 3; method++)
+		{
+			output << BROADPHASE_METHOD_NAMES[method] << "," << playercount << "," << BROADPHASE_BENCHMARK_TICKS << "," << rounds << ","
+				<< (double)pairtotal / BROADPHASE_BENCHMARK_TICKS << "," << ((BroadphaseMethod)method == BroadphaseMethod::Incremental ? (double)swaptotal / BROADPHASE_BENCHMARK_TICKS : 0.0) << ","
+				<< seconds[method] * 1e9 / BROADPHASE_BENCHMARK_TICKS << "," << matching[method] << "," << BROADPHASE_BENCHMARK_TICKS / simseconds << std::endl;
+		}
+	}
+
+	void RunBroadphaseBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "method,players,ticks,rounds,pairs_per_tick,swaps_per_tick,ns_per_update,ticks_matching,sim_ticks_per_second" << std::endl;
+
+		for (unsigned int playercount : BROADPHASE_BENCHMARK_PLAYER_COUNTS)
+			RunBroadphaseScenario(output, playercount);
+	}
+}
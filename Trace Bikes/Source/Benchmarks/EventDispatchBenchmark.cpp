@@ -0,0 +1,151 @@
+#include "Benchmarks.h"
+#include "../Framework/Events/EventDispatcher.h"
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+namespace GameDev2D
+{
+	const unsigned int EVENT_BENCHMARK_LISTENER_COUNT = 10000;
+	const unsigned int EVENT_BENCHMARK_DISPATCH_COUNT = 2000;
+	const unsigned int EVENT_BENCHMARK_OTHER_CODE_COUNT = 8; // Listeners not on the dispatched code are spread over this many other codes.
+
+	// DRAW_EVENT isn't logged when dispatched, so only the dispatch itself is timed.
+	const unsigned int EVENT_BENCHMARK_CODE = DRAW_EVENT;
+	const unsigned int EVENT_BENCHMARK_FIRST_OTHER_CODE = 100;
+
+	// Counts the events it receives, optionally removing itself from the dispatcher when it gets one.
+	class BenchmarkListener : public EventHandler
+	{
+	public:
+		BenchmarkListener() : m_Count(0), m_RemoveOnEvent(false) {}
+
+		void HandleEvent(Event* event)
+		{
+			m_Count++;
+
+			if (m_RemoveOnEvent)
+				event->GetDispatcher()->RemoveEventListener(this, event->GetEventCode());
+		}
+
+		unsigned long long m_Count;
+		bool m_RemoveOnEvent;
+	};
+
+	// The single (handler, event code) vector the EventDispatcher scanned before handlers were bucketed by event code.
+	class LinearDispatcher
+	{
+	public:
+		void AddEventListener(EventHandler* handler, unsigned int eventcode)
+		{
+			m_HandlerEntries.push_back(std::make_pair(handler, eventcode));
+		}
+
+		void RemoveEventListener(EventHandler* handler, unsigned int eventcode)
+		{
+			for (unsigned int i = 0; i < m_HandlerEntries.size(); i++)
+			{
+				if (m_HandlerEntries.at(i).second == eventcode && m_HandlerEntries.at(i).first == handler)
+					m_HandlerEntries.erase(m_HandlerEntries.begin() + i);
+			}
+		}
+
+		void DispatchEvent(Event& event)
+		{
+			for (unsigned int i = 0; i < m_HandlerEntries.size(); i++)
+			{
+				if (m_HandlerEntries.at(i).second == event.GetEventCode())
+					m_HandlerEntries.at(i).first->HandleEvent(&event);
+			}
+		}
+
+	private:
+		std::vector<std::pair<EventHandler*, unsigned int>> m_HandlerEntries;
+	};
+
+	// Dispatches the benchmark event to 10k listeners, of which listenercount listen for it. Every
+	// dispatch, removecount of those listeners remove themselves and are added back afterwards, the
+	// linear dispatcher can't have handlers removed mid-dispatch so it removes them after the dispatch.
+	static void RunEventDispatchScenario(std::ofstream& output, const char* name, unsigned int listenercount, unsigned int removecount)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		std::vector<BenchmarkListener> listeners(EVENT_BENCHMARK_LISTENER_COUNT);
+		EventDispatcher bucketed;
+		LinearDispatcher linear;
+
+		// Interleave the listeners so the linear scan can't skip over a block of other codes.
+		unsigned int stride = EVENT_BENCHMARK_LISTENER_COUNT / listenercount;
+		for (unsigned int i = 0; i < EVENT_BENCHMARK_LISTENER_COUNT; i++)
+		{
+			bool isdispatched = i % stride == 0 && i / stride < listenercount;
+			unsigned int eventcode = isdispatched ? EVENT_BENCHMARK_CODE : EVENT_BENCHMARK_FIRST_OTHER_CODE + i % EVENT_BENCHMARK_OTHER_CODE_COUNT;
+			bucketed.AddEventListener(&listeners[i], eventcode);
+			linear.AddEventListener(&listeners[i], eventcode);
+		}
+
+		std::vector<BenchmarkListener*> removed;
+		for (unsigned int i = 0; i < removecount; i++)
+			removed.push_back(&listeners[i * stride]);
+
+		Event event(EVENT_BENCHMARK_CODE);
+
+		// Old path: scan every entry, remove with mid-vector erases.
+		Clock::time_point start = Clock::now();
+		for (unsigned int dispatch = 0; dispatch < EVENT_BENCHMARK_DISPATCH_COUNT; dispatch++)
+		{
+			linear.DispatchEvent(event);
+
+			for (BenchmarkListener* listener : removed)
+				linear.RemoveEventListener(listener, EVENT_BENCHMARK_CODE);
+			for (BenchmarkListener* listener : removed)
+				linear.AddEventListener(listener, EVENT_BENCHMARK_CODE);
+		}
+
+		unsigned long long linearcount = 0;
+		for (BenchmarkListener& listener : listeners)
+		{
+			linearcount += listener.m_Count;
+			listener.m_Count = 0;
+		}
+
+		for (BenchmarkListener* listener : removed)
+			listener->m_RemoveOnEvent = true;
+
+		// New path: only the event code's handlers, removed listeners are tombstoned during the dispatch.
+		Clock::time_point middle = Clock::now();
+		for (unsigned int dispatch = 0; dispatch < EVENT_BENCHMARK_DISPATCH_COUNT; dispatch++)
+		{
+			bucketed.DispatchEvent(event);
+
+			for (BenchmarkListener* listener : removed)
+				bucketed.AddEventListener(listener, EVENT_BENCHMARK_CODE);
+		}
+		Clock::time_point end = Clock::now();
+
+		unsigned long long bucketedcount = 0;
+		for (BenchmarkListener& listener : listeners)
+			bucketedcount += listener.m_Count;
+
+		double linearus = std::chrono::duration<double, std::micro>(middle - start).count() / EVENT_BENCHMARK_DISPATCH_COUNT;
+		double bucketedus = std::chrono::duration<double, std::micro>(end - middle).count() / EVENT_BENCHMARK_DISPATCH_COUNT;
+
+		output << name << "," << EVENT_BENCHMARK_LISTENER_COUNT << "," << listenercount << "," << removecount << ","
+			<< linearus << "," << bucketedus << "," << (linearcount == bucketedcount ? "yes" : "no") << std::endl;
+	}
+
+	void RunEventDispatchBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "scenario,listeners,listeners_for_event,removed_per_dispatch,linear_us_per_dispatch,bucketed_us_per_dispatch,same_deliveries" << std::endl;
+
+		// Typical frame: a handful of UPDATE/DRAW listeners among many listening for other events.
+		RunEventDispatchScenario(output, "few_listeners_for_event", 100, 0);
+
+		// Every listener is listening for the event, bucketing can't skip anything.
+		RunEventDispatchScenario(output, "all_listeners_for_event", EVENT_BENCHMARK_LISTENER_COUNT, 0);
+
+		// Animators and sprites coming and going while the event is dispatched.
+		RunEventDispatchScenario(output, "removing_during_dispatch", 1000, 100);
+	}
+}
@@ -0,0 +1,182 @@
+#include "Benchmarks.h"
+#include <GameDev2D.h>
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace GameDev2D
+{
+	const unsigned int INPUT_LATENCY_EVENTS_PER_PRODUCER = 400; // One producer thread per player.
+	const double INPUT_LATENCY_MIN_GAP = 0.001; // Seconds between two key presses of the same player.
+	const double INPUT_LATENCY_MAX_GAP = 0.010;
+	const double INPUT_LATENCY_SPIN_TIME = 0.002; // Waits sleep until this close to the deadline, then spin.
+
+	// The game's turn keys, as Game::HandleKeyDown maps them, indexed by player and then by Direction.
+	const Keyboard::Key INPUT_LATENCY_KEYS[PLAYER_COUNT][4] =
+	{
+		{ Keyboard::A, Keyboard::D, Keyboard::W, Keyboard::S },
+		{ Keyboard::Left, Keyboard::Right, Keyboard::Up, Keyboard::Down },
+	};
+
+	// A turn handed to the key down callback, waiting for the fixed update that simulates past its press.
+	struct LatencyTurn
+	{
+		TurnInput input;
+		double presstime;
+	};
+
+	static void WaitUntil(double time)
+	{
+		while (time - GameLoop::GetTime() > INPUT_LATENCY_SPIN_TIME)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		while (GameLoop::GetTime() < time)
+			;
+	}
+
+	// Presses a player's turn keys at random intervals, like the input thread does: a key down and a key up,
+	// queued through the InputManager and timestamped with GameLoop::GetTime().
+	static void ProduceTurns(InputManager* inputmanager, unsigned int player)
+	{
+		unsigned int random = 12345 + player * 7919;
+		double next = GameLoop::GetTime();
+
+		for (unsigned int i = 0; i < INPUT_LATENCY_EVENTS_PER_PRODUCER; i++)
+		{
+			random = random * 1664525 + 1013904223;
+			next += INPUT_LATENCY_MIN_GAP + (INPUT_LATENCY_MAX_GAP - INPUT_LATENCY_MIN_GAP) * ((random >> 8) & 0xFFFF) / 65535.0;
+			WaitUntil(next);
+
+			unsigned int key = INPUT_LATENCY_KEYS[player][(random >> 24) % 4];
+			double timestamp = GameLoop::GetTime();
+
+			while (!inputmanager->QueueKeyEvent(key, InputEvent::KeyDown, timestamp))
+				std::this_thread::yield();
+
+			while (!inputmanager->QueueKeyEvent(key, InputEvent::KeyUp, timestamp))
+				std::this_thread::yield();
+		}
+	}
+
+	// Runs the game's input path at a frame rate, paced like the GameLoop: every frame the time since the last one
+	// is accumulated and as many fixed updates as fit run back to back. Like Application::Update, each one handles
+	// the InputManager's queue first, so the first update of a frame gets the keys pressed since the last frame and
+	// the rest only the few pressed during the burst. Like Game::Update, a turn is handed to the first update that
+	// simulates past its press. The latency of a turn is the time from its key press until that Step returns.
+	static void RunInputLatencyScenario(std::ofstream& output, const char* name, double framerate)
+	{
+		InputManager* inputmanager = new InputManager();
+		TraceSim sim(1024.0f, 768.0f);
+		std::vector<LatencyTurn> pending;
+
+		inputmanager->RegisterKeyDownCallback([inputmanager, &pending](Keyboard::Key key)
+		{
+			for (unsigned int player = 0; player < PLAYER_COUNT; player++)
+			{
+				for (unsigned int direction = 0; direction < 4; direction++)
+				{
+					if (INPUT_LATENCY_KEYS[player][direction] == key)
+					{
+						LatencyTurn turn;
+						turn.input.player = player;
+						turn.input.direction = (Direction)direction;
+						turn.input.time = 0.0f;
+						turn.presstime = inputmanager->GetKeyPressTime();
+						pending.push_back(turn);
+					}
+				}
+			}
+		});
+
+		std::vector<std::thread> producers;
+		for (unsigned int player = 0; player < PLAYER_COUNT; player++)
+			producers.push_back(std::thread(ProduceTurns, inputmanager, player));
+
+		unsigned int expected = INPUT_LATENCY_EVENTS_PER_PRODUCER * PLAYER_COUNT;
+		std::vector<double> latencies;
+		std::vector<double> presstimes;
+		std::vector<TurnInput> inputs;
+		double delta = 1.0 / FIXED_UPDATE_RATE;
+		double accumulator = 0.0;
+		double frametime = GameLoop::GetTime();
+		double next = frametime;
+
+		while (latencies.size() < expected)
+		{
+			next += 1.0 / framerate;
+			WaitUntil(next);
+
+			double previous = frametime;
+			frametime = GameLoop::GetTime();
+			accumulator += frametime - previous;
+
+			unsigned int updates = 0;
+			while (accumulator >= delta && updates < MAX_UPDATES_PER_FRAME)
+			{
+				double stepend = frametime - (accumulator - delta);
+				inputmanager->ProcessInputQueue();
+
+				inputs.clear();
+				presstimes.clear();
+				unsigned int kept = 0;
+
+				for (const LatencyTurn& turn : pending)
+				{
+					if (turn.presstime < stepend)
+					{
+						TurnInput input = turn.input;
+						input.time = (float)(turn.presstime - (stepend - delta));
+						inputs.push_back(input);
+						presstimes.push_back(turn.presstime);
+					}
+					else
+						pending[kept++] = turn;
+				}
+				pending.resize(kept);
+
+				sim.Step(delta, inputs);
+				double applied = GameLoop::GetTime();
+
+				if (sim.GetRoundState() == RoundState::GameOver)
+					sim.Reset();
+
+				for (double presstime : presstimes)
+					latencies.push_back(applied - presstime);
+
+				accumulator -= delta;
+				updates++;
+			}
+
+			if (accumulator >= delta)
+				accumulator = fmod(accumulator, delta);
+		}
+
+		for (std::thread& producer : producers)
+			producer.join();
+
+		delete inputmanager;
+
+		std::sort(latencies.begin(), latencies.end());
+		output << name << "," << framerate << "," << FIXED_UPDATE_RATE << "," << latencies.size()
+			<< "," << latencies[latencies.size() / 2] * 1000000.0
+			<< "," << latencies[latencies.size() * 95 / 100] * 1000000.0
+			<< "," << latencies[latencies.size() * 99 / 100] * 1000000.0
+			<< "," << latencies.back() * 1000000.0 << std::endl;
+	}
+
+	void RunInputLatencyBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "scenario,frame_rate_hz,fixed_update_hz,events,p50_us,p95_us,p99_us,max_us" << std::endl;
+
+		// The game's pacing, four fixed updates back to back every 60 fps frame.
+		RunInputLatencyScenario(output, "target_fps", TARGET_FPS);
+
+		// A high refresh rate display, the fixed updates are spread over more, shorter bursts.
+		RunInputLatencyScenario(output, "high_refresh", 144.0);
+	}
+}
@@ -0,0 +1,189 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const unsigned int LARGE_ARENA_BENCHMARK_SCALES[] = { 1, 2, 4, 8 }; // The arena's sides as multiples of the screen's.
+	const float LARGE_ARENA_BENCHMARK_SCREEN_WIDTH = 1024.0f;
+	const float LARGE_ARENA_BENCHMARK_SCREEN_HEIGHT = 768.0f;
+	const unsigned int LARGE_ARENA_BENCHMARK_PLAYERS = 8;
+	const unsigned int LARGE_ARENA_BENCHMARK_TICKS = (unsigned int)FIXED_TICK_RATE * 600; // Ten minutes of play at every size.
+	const int LARGE_ARENA_BENCHMARK_LOOKAHEAD = 3; // Cells the driver looks ahead for trails and walls.
+	const unsigned int LARGE_ARENA_BENCHMARK_TURN_CHANCE = 60; // One random turn every 60 ticks on average.
+	const float LARGE_ARENA_BENCHMARK_TILE_SIZE = 512.0f; // The Game's CANVAS_TILE_SIZE.
+
+	// Returns wether the cells ahead of a cell, and the cells either side of them, are open. A bike passing a trail
+	// in the next row of cells would touch it. The arena's edges count as blocked.
+	static bool IsClearAhead(const BitboardArena& arena, int column, int row, int directionx, int directiony)
+	{
+		for (int step = 1; step <= LARGE_ARENA_BENCHMARK_LOOKAHEAD; step++)
+		{
+			for (int side = -1; side <= 1; side++)
+			{
+				int aheadcolumn = column + directionx * step - directiony * side;
+				int aheadrow = row + directiony * step + directionx * side;
+				if (aheadcolumn < 0 || aheadrow < 0 || aheadcolumn >= arena.GetColumns() || aheadrow >= arena.GetRows() || !arena.IsOpen(aheadcolumn, aheadrow))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	static Direction GetTurnDirection(int directionx, int directiony)
+	{
+		if (directionx != 0)
+			return directionx < 0 ? Direction::Left : Direction::Right;
+		return directiony > 0 ? Direction::Up : Direction::Down;
+	}
+
+	// Steers away from the trails and walls a few cells ahead, and otherwise turns now and then to a side that's
+	// clear, so the bikes last and lay long trails across the whole arena. The scripted benchmark driver turns at
+	// random and most of its rounds end before the trails are long.
+	static bool SteerLargeArenaTurn(const TraceSim& sim, unsigned int player, unsigned int& seed, TurnInput& input)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		if (!bikes.alive[player])
+			return false;
+
+		const BitboardArena& arena = sim.GetArena();
+		int column = (int)(bikes.x[player] / ARENA_CELL_SIZE);
+		int row = (int)(bikes.y[player] / ARENA_CELL_SIZE);
+		int directionx = bikes.directionx[player];
+		int directiony = bikes.directiony[player];
+
+		seed = seed * 1664525u + 1013904223u;
+		bool isahead = IsClearAhead(arena, column, row, directionx, directiony);
+		if (isahead && (seed >> 8) % LARGE_ARENA_BENCHMARK_TURN_CHANCE != 0)
+			return false;
+
+		// The two sides, in a random order, the first that's clear.
+		int side = (seed >> 20) % 2 == 0 ? 1 : -1;
+		for (unsigned int attempt = 0; attempt < 2; attempt++, side = -side)
+		{
+			int sidex = -directiony * side;
+			int sidey = directionx * side;
+			if (IsClearAhead(arena, column, row, sidex, sidey))
+			{
+				input.player = player;
+				input.direction = GetTurnDirection(sidex, sidey);
+				input.time = 0.0f;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Returns the canvas tiles the trails are drawn over, as the Game allocates them. The trails are BIKE_SIZE wide.
+	static unsigned int CountCanvasTiles(const TraceSim& sim, std::vector<unsigned char>& tiles, int tilecolumns, int tilerows)
+	{
+		std::fill(tiles.begin(), tiles.end(), 0);
+		unsigned int count = 0;
+
+		for (const TrailBuffer& trail : sim.GetBikes().trail)
+		{
+			for (size_t index = 0; index < trail.GetCount(); index++)
+			{
+				const TrailRun& run = trail[index];
+				float margin = BIKE_SIZE * 0.5f;
+				int firstcolumn = std::max((int)((ToPixels(std::min(run.startx, run.endx)) - margin) / LARGE_ARENA_BENCHMARK_TILE_SIZE), 0);
+				int lastcolumn = std::min((int)((ToPixels(std::max(run.startx, run.endx)) + margin) / LARGE_ARENA_BENCHMARK_TILE_SIZE), tilecolumns - 1);
+				int firstrow = std::max((int)((ToPixels(std::min(run.starty, run.endy)) - margin) / LARGE_ARENA_BENCHMARK_TILE_SIZE), 0);
+				int lastrow = std::min((int)((ToPixels(std::max(run.starty, run.endy)) + margin) / LARGE_ARENA_BENCHMARK_TILE_SIZE), tilerows - 1);
+
+				for (int row = firstrow; row <= lastrow; row++)
+				{
+					for (int column = firstcolumn; column <= lastcolumn; column++)
+					{
+						count += tiles[row * tilecolumns + column] == 0;
+						tiles[row * tilecolumns + column] = 1;
+					}
+				}
+			}
+		}
+
+		return count;
+	}
+
+	static void RunLargeArenaScenario(std::ofstream& output, unsigned int scale)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		float width = LARGE_ARENA_BENCHMARK_SCREEN_WIDTH * scale;
+		float height = LARGE_ARENA_BENCHMARK_SCREEN_HEIGHT * scale;
+		TraceSim sim(width, height, LARGE_ARENA_BENCHMARK_PLAYERS);
+
+		int tilecolumns = (int)ceilf(width / LARGE_ARENA_BENCHMARK_TILE_SIZE);
+		int tilerows = (int)ceilf(height / LARGE_ARENA_BENCHMARK_TILE_SIZE);
+		std::vector<unsigned char> tiles(tilecolumns * tilerows);
+		std::vector<TurnInput> inputs;
+
+		unsigned int seed = 1;
+		unsigned int rounds = 0;
+		unsigned long long runs = 0;
+		size_t maxruns = 0;
+		size_t maxchunks = 0;
+		size_t maxchunkbytes = 0;
+		unsigned int maxtiles = 0;
+		unsigned long long statehash = 0;
+		double seconds = 0.0;
+
+		for (unsigned int tick = 0; tick < LARGE_ARENA_BENCHMARK_TICKS; tick++)
+		{
+			Clock::time_point start = Clock::now();
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < LARGE_ARENA_BENCHMARK_PLAYERS; player++)
+				{
+					if (SteerLargeArenaTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			statehash = statehash * 31 + sim.GetStateHash();
+			seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+			// The trails are longest as the round ends, count what they hold then, outside the timing.
+			if (sim.GetRoundState() == RoundState::GameOver || tick + 1 == LARGE_ARENA_BENCHMARK_TICKS)
+			{
+				for (const TrailBuffer& trail : sim.GetBikes().trail)
+				{
+					runs += trail.GetCount();
+					maxruns = std::max(maxruns, trail.GetCount());
+				}
+
+				maxchunks = std::max(maxchunks, sim.GetTrailChunks().GetUsedCount());
+				maxchunkbytes = std::max(maxchunkbytes, sim.GetTrailChunks().GetMemoryUsage());
+				maxtiles = std::max(maxtiles, CountCanvasTiles(sim, tiles, tilecolumns, tilerows));
+
+				sim.Reset();
+				rounds++;
+			}
+		}
+
+		size_t tilebytes = (size_t)(LARGE_ARENA_BENCHMARK_TILE_SIZE * LARGE_ARENA_BENCHMARK_TILE_SIZE) * 4;
+
+		output << scale << "," << width << "," << height << "," << LARGE_ARENA_BENCHMARK_PLAYERS << "," << LARGE_ARENA_BENCHMARK_TICKS << "," << rounds << ","
+			<< LARGE_ARENA_BENCHMARK_TICKS / seconds << "," << (double)runs / (rounds * LARGE_ARENA_BENCHMARK_PLAYERS) << "," << maxruns << ","
+			<< maxchunks << "," << sim.GetTrailChunks().GetChunkCount() << "," << maxchunkbytes << "," << maxtiles << "," << tiles.size() << ","
+			<< maxtiles * tilebytes << "," << (size_t)(width * height) * 4 << "," << std::hex << statehash << std::dec << std::endl;
+	}
+
+	void RunLargeArenaBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "scale,arena_width,arena_height,players,ticks,rounds,ticks_per_second,average_trail_runs,max_trail_runs,max_chunks_used,chunks,"
+			"max_chunk_bytes,max_canvas_tiles,canvas_tiles,max_tiled_canvas_bytes,full_canvas_bytes,state_hash" << std::endl;
+
+		for (unsigned int scale : LARGE_ARENA_BENCHMARK_SCALES)
+			RunLargeArenaScenario(output, scale);
+	}
+}
@@ -0,0 +1,85 @@
+#include "Benchmarks.h"
+#include "../TraceSim/Replay.h"
+#include "../TraceSim/TraceSim.h"
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const char* const REPLAY_BENCHMARK_SCRIPTED_PATH = "ScriptedMatch.replay";
+	const unsigned int REPLAY_BENCHMARK_SCRIPTED_PLAYERS = 8;
+	const unsigned int REPLAY_BENCHMARK_SCRIPTED_TICKS = 240 * 60 * 10; // Ten minutes of scripted rounds.
+	const unsigned int REPLAY_BENCHMARK_PASSES = 5;
+
+	// Records scripted rounds, for when there's no match recorded by the game to play.
+	static void RecordScriptedMatch(const std::string& path)
+	{
+		TraceSim sim(1024.0f, 768.0f, REPLAY_BENCHMARK_SCRIPTED_PLAYERS);
+		ReplayRecorder recorder(path, sim);
+		std::vector<TurnInput> inputs;
+
+		unsigned int seed = 1;
+
+		for (unsigned int tick = 0; tick < REPLAY_BENCHMARK_SCRIPTED_TICKS; tick++)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < sim.GetPlayerCount(); player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+			else if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				sim.Reset();
+				recorder.RecordReset();
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			recorder.RecordStep(inputs);
+		}
+	}
+
+	void RunReplayBenchmark(const std::string& outputpath)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		std::string path = MATCH_REPLAY_PATH;
+		ReplayFile replay;
+
+		if (!replay.Open(path))
+		{
+			path = REPLAY_BENCHMARK_SCRIPTED_PATH;
+			RecordScriptedMatch(path);
+
+			if (!replay.Open(path))
+				return;
+		}
+
+		std::ofstream output(outputpath);
+		output << "replay,pass,players,ticks,records,file_bytes,seconds,ticks_per_second,realtime_factor,desynced" << std::endl;
+
+		const ReplayHeader& header = replay.GetHeader();
+		size_t filebytes = sizeof(ReplayHeader) + replay.GetRecordCount() * sizeof(ReplayRecord);
+
+		for (unsigned int pass = 1; pass <= REPLAY_BENCHMARK_PASSES; pass++)
+		{
+			TraceSim sim(header.arenawidth, header.arenaheight, header.playercount);
+			ReplayPlayer player(replay, sim);
+
+			Clock::time_point start = Clock::now();
+
+			while (player.StepTick())
+				;
+
+			double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+			output << path << "," << pass << "," << header.playercount << "," << header.tickcount << "," << replay.GetRecordCount() << "," << filebytes << ","
+				<< seconds << "," << header.tickcount / seconds << "," << header.tickcount / (double)header.tickrate / seconds << "," << player.IsDesynced() << std::endl;
+		}
+	}
+}
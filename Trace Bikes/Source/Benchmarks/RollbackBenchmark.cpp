@@ -0,0 +1,174 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	struct RollbackScenario
+	{
+		unsigned int playercount;
+		bool isserpentine; // Steered along serpentines for long trails, rather than scripted turns.
+	};
+
+	const RollbackScenario ROLLBACK_BENCHMARK_SCENARIOS[] = { { 2, false }, { 8, false }, { 64, false }, { 8, true }, { 64, true } };
+	const unsigned int ROLLBACK_BENCHMARK_FRAMES = 3600; // A minute at 60 frames per second.
+	const unsigned int ROLLBACK_BENCHMARK_TICKS_PER_FRAME = (unsigned int)(FIXED_TICK_RATE / 60);
+	const unsigned int ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME = 60;
+	const unsigned int ROLLBACK_BENCHMARK_ROLLBACK_TICKS = 4; // Each timed restore rolls back this many ticks, then steps one.
+	const double ROLLBACK_BENCHMARK_FRAME_SECONDS = 1.0 / 60.0;
+	const float ROLLBACK_BENCHMARK_ARENA_WIDTH = 1024.0f;
+	const float ROLLBACK_BENCHMARK_ARENA_HEIGHT = 768.0f;
+	const float ROLLBACK_BENCHMARK_LANE_HEIGHT = 64.0f;
+	const float ROLLBACK_BENCHMARK_SERPENTINE_ARENA_WIDTH = 16384.0f; // Wide enough that the serpentines don't meet within the minute.
+	const float ROLLBACK_BENCHMARK_SERPENTINE_STEP = 32.0f; // Length of the serpentines' runs, two trail widths apart.
+
+	struct RollbackTotals
+	{
+		double saveseconds;
+		double restoreseconds; // The restores and the step after each, the step finishes what the restore left to do.
+	};
+
+	// Steers a bike along a serpentine, ahead and across by ROLLBACK_BENCHMARK_SERPENTINE_STEP in turn, so its
+	// trail grows by a run every few ticks. Even players go up first and odd players down, away from their lanes'
+	// neighbours. Returns false if the bike keeps going.
+	static bool SteerSerpentine(const TraceSim& sim, unsigned int player, TurnInput& input)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		const TrailBuffer& trail = bikes.trail[player];
+		if (!bikes.alive[player] || ToPixels(trail.GetNewest().GetLength()) < ROLLBACK_BENCHMARK_SERPENTINE_STEP) return false;
+
+		input.player = player;
+		input.time = 0.0f;
+
+		// The runs across are every other one, the next is added as run GetAddedCount().
+		if (bikes.directiony[player] != 0)
+			input.direction = player % 2 == 0 ? Direction::Right : Direction::Left;
+		else if ((trail.GetAddedCount() % 4 == 1) == (player % 2 == 0))
+			input.direction = Direction::Up;
+		else
+			input.direction = Direction::Down;
+		return true;
+	}
+
+	// Saves the sim's state, and restores it ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME times after playing
+	// ROLLBACK_BENCHMARK_ROLLBACK_TICKS on, with snapshots or by copying the whole sim. Adds the time the saves took,
+	// and the restores with the step after each. The sim is left as it was.
+	static void TimeSnapshots(TraceSim& sim, SimSnapshot& snapshot, TraceSim& copy, bool iscopy, RollbackTotals& totals)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		std::vector<TurnInput> inputs;
+
+		Clock::time_point start = Clock::now();
+		for (unsigned int index = 0; index < ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME; index++)
+		{
+			if (iscopy)
+				copy = sim;
+			else
+				sim.Save(snapshot);
+		}
+		totals.saveseconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+		for (unsigned int index = 0; index < ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME; index++)
+		{
+			for (unsigned int tick = 1; tick < ROLLBACK_BENCHMARK_ROLLBACK_TICKS; tick++)
+				sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+
+			start = Clock::now();
+			if (iscopy)
+				sim = copy;
+			else
+				sim.Restore(snapshot);
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			totals.restoreseconds += std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		if (iscopy)
+			sim = copy;
+		else
+			sim.Restore(snapshot);
+	}
+
+	static void RunRollbackScenario(std::ofstream& output, const RollbackScenario& scenario)
+	{
+		unsigned int playercount = scenario.playercount;
+		float arenawidth = scenario.isserpentine ? ROLLBACK_BENCHMARK_SERPENTINE_ARENA_WIDTH : ROLLBACK_BENCHMARK_ARENA_WIDTH;
+		float arenaheight = std::max(ROLLBACK_BENCHMARK_ARENA_HEIGHT, (playercount + 1) / 2 * ROLLBACK_BENCHMARK_LANE_HEIGHT);
+		TraceSim sim(arenawidth, arenaheight, playercount);
+		TraceSim copy = sim;
+		SimSnapshot framesnapshot;
+		SimSnapshot snapshot;
+
+		std::vector<std::vector<TurnInput>> frameinputs(ROLLBACK_BENCHMARK_TICKS_PER_FRAME);
+		RollbackTotals totals[2] = {};
+		unsigned int seed = 1;
+		unsigned int rollbacks = 0;
+		unsigned int matching = 0;
+		size_t maxruns = 0;
+
+		for (unsigned int frame = 0; frame < ROLLBACK_BENCHMARK_FRAMES; frame++)
+		{
+			if (sim.GetRoundState() == RoundState::GameOver)
+				sim.Reset();
+
+			// Play the frame's ticks, then roll back to its start and play them again, like a late input would.
+			sim.Save(framesnapshot);
+			for (std::vector<TurnInput>& inputs : frameinputs)
+			{
+				inputs.clear();
+				if (sim.GetRoundState() == RoundState::Running)
+				{
+					TurnInput input;
+					for (unsigned int player = 0; player < playercount; player++)
+					{
+						if (scenario.isserpentine ? SteerSerpentine(sim, player, input) : ScriptBenchmarkTurn(sim, player, seed, input))
+							inputs.push_back(input);
+					}
+				}
+				sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			}
+
+			unsigned long long statehash = sim.GetStateHash();
+			unsigned int opencells = sim.GetArena().GetOpenCount();
+
+			if (sim.Restore(framesnapshot))
+			{
+				for (const std::vector<TurnInput>& inputs : frameinputs)
+					sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+
+				rollbacks++;
+				if (sim.GetStateHash() == statehash && sim.GetArena().GetOpenCount() == opencells)
+					matching++;
+			}
+
+			for (unsigned int player = 0; player < playercount; player++)
+				maxruns = std::max(maxruns, sim.GetBikes().trail[player].GetCount());
+
+			TimeSnapshots(sim, snapshot, copy, false, totals[0]);
+			TimeSnapshots(sim, snapshot, copy, true, totals[1]);
+		}
+
+		const char* steering = scenario.isserpentine ? "serpentine" : "scripted";
+		const char* methods[] = { "snapshot", "full_copy" };
+		double count = (double)ROLLBACK_BENCHMARK_FRAMES * ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME;
+
+		for (unsigned int method = 0; method < 2; method++)
+		{
+			double frameseconds = (totals[method].saveseconds + totals[method].restoreseconds) / ROLLBACK_BENCHMARK_FRAMES;
+
+			output << playercount << "," << steering << "," << methods[method] << "," << ROLLBACK_BENCHMARK_FRAMES << "," << ROLLBACK_BENCHMARK_SNAPSHOTS_PER_FRAME << ","
+				<< totals[method].saveseconds / count * 1e9 << "," << totals[method].restoreseconds / count * 1e9 << "," << frameseconds * 1e6 << ","
+				<< frameseconds / ROLLBACK_BENCHMARK_FRAME_SECONDS * 100.0 << "," << maxruns << "," << rollbacks << "," << matching << std::endl;
+		}
+	}
+
+	void RunRollbackBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "players,steering,method,frames,snapshots_per_frame,ns_per_save,ns_per_restore_and_step,us_per_frame,frame_budget_percent,max_trail_runs,rollbacks,rollbacks_matching" << std::endl;
+
+		for (const RollbackScenario& scenario : ROLLBACK_BENCHMARK_SCENARIOS)
+			RunRollbackScenario(output, scenario);
+	}
+}
@@ -0,0 +1,52 @@
+#include "Benchmarks.h"
+#include "../TraceSim/LoopbackBots.h"
+#include "../TraceSim/MatchServer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace GameDev2D
+{
+	const unsigned int SERVER_BENCHMARK_MATCH_COUNTS[] = { 256, 1024, 4096 };
+	const double SERVER_BENCHMARK_SECONDS = 10.0; // Each match count is played this long, rounds start after a 3 second countdown.
+	const unsigned int SERVER_BENCHMARK_BOT_THREADS = 1;
+
+	static void RunServerScenario(std::ofstream& output, unsigned int matchcount, unsigned int threadcount)
+	{
+		MatchServer server(matchcount, threadcount, true);
+		if (!server.Start(0))
+			return;
+
+		LoopbackBots bots(server, SERVER_BENCHMARK_BOT_THREADS);
+		if (bots.Start())
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(SERVER_BENCHMARK_SECONDS));
+			bots.Stop();
+		}
+		server.Stop();
+
+		ServerStats stats = server.GetStats();
+		BotStats botstats = bots.GetStats();
+
+		WriteServerStats(output, server, stats);
+		output << "," << botstats.joinedplayers << "," << botstats.statesreceived << "," << botstats.turnssent << "," << botstats.turnsseen;
+		for (double latency : botstats.turnlatencypercentiles)
+			output << "," << latency * 1e3;
+		output << std::endl;
+	}
+
+	void RunServerBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		WriteServerStatsHeader(output);
+		output << ",joined_players,bot_states_received,bot_turns_sent,bot_turns_seen,turn_ms_p50,turn_ms_p90,turn_ms_p99" << std::endl;
+
+		// The server gets every hardware thread but the bots'.
+		unsigned int hardwarethreads = std::max(std::thread::hardware_concurrency(), 1u);
+		unsigned int threadcount = std::max(hardwarethreads - std::min(hardwarethreads, SERVER_BENCHMARK_BOT_THREADS), 1u);
+
+		for (unsigned int matchcount : SERVER_BENCHMARK_MATCH_COUNTS)
+			RunServerScenario(output, matchcount, threadcount);
+	}
+}
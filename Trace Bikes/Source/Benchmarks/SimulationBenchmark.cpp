@@ -0,0 +1,112 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const unsigned int SIMULATION_BENCHMARK_BIKE_TICKS = 10000000; // Each player count steps this many bikes in total.
+	const unsigned int SIMULATION_BENCHMARK_PLAYER_COUNTS[] = { 2, 8, 64 };
+	const double SIMULATION_BENCHMARK_DELTA = 1.0 / 240.0;
+	const float SIMULATION_BENCHMARK_ARENA_WIDTH = 1024.0f;
+	const float SIMULATION_BENCHMARK_ARENA_HEIGHT = 768.0f;
+	const float SIMULATION_BENCHMARK_LANE_HEIGHT = 64.0f; // Taller arenas for more players, two bikes per lane.
+	const float SIMULATION_BENCHMARK_WALL_DISTANCE = 32.0f;
+	const unsigned int SIMULATION_BENCHMARK_TURN_CHANCE = 120; // One random turn every 120 ticks on average.
+
+	bool ScriptBenchmarkTurn(const TraceSim& sim, unsigned int player, unsigned int& seed, TurnInput& input)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		if (!bikes.alive[player])
+			return false;
+
+		float x = bikes.x[player];
+		float y = bikes.y[player];
+		int directionx = bikes.directionx[player];
+		int directiony = bikes.directiony[player];
+		input.player = player;
+		input.time = 0.0f;
+
+		bool wallahead = (directionx > 0 && x > sim.GetArenaWidth() - SIMULATION_BENCHMARK_WALL_DISTANCE) ||
+			(directionx < 0 && x < SIMULATION_BENCHMARK_WALL_DISTANCE) ||
+			(directiony > 0 && y > sim.GetArenaHeight() - SIMULATION_BENCHMARK_WALL_DISTANCE) ||
+			(directiony < 0 && y < SIMULATION_BENCHMARK_WALL_DISTANCE);
+
+		if (wallahead)
+		{
+			if (directionx != 0)
+				input.direction = y < sim.GetArenaHeight() * 0.5f ? Direction::Up : Direction::Down;
+			else
+				input.direction = x < sim.GetArenaWidth() * 0.5f ? Direction::Right : Direction::Left;
+			return true;
+		}
+
+		seed = seed * 1664525u + 1013904223u;
+		if ((seed >> 8) % SIMULATION_BENCHMARK_TURN_CHANCE != 0)
+			return false;
+
+		input.direction = (Direction)((seed >> 20) % 4);
+		return true;
+	}
+
+	static void RunSimulationScenario(std::ofstream& output, unsigned int playercount)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		float arenaheight = std::max(SIMULATION_BENCHMARK_ARENA_HEIGHT, (playercount + 1) / 2 * SIMULATION_BENCHMARK_LANE_HEIGHT);
+		unsigned int ticks = SIMULATION_BENCHMARK_BIKE_TICKS / playercount;
+
+		TraceSim sim(SIMULATION_BENCHMARK_ARENA_WIDTH, arenaheight, playercount);
+		std::vector<TurnInput> inputs;
+		inputs.reserve(playercount);
+
+		unsigned int seed = 1;
+		unsigned int rounds = 0;
+		unsigned long long runs = 0;
+		unsigned long long statehash = 0; // Every tick's state hash folded together, equal between runs of the same build and script.
+
+		Clock::time_point start = Clock::now();
+
+		for (unsigned int tick = 0; tick < ticks; tick++)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < playercount; player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+			else if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				for (unsigned int player = 0; player < playercount; player++)
+					runs += sim.GetBikes().trail[player].GetCount();
+
+				sim.Reset();
+				rounds++;
+			}
+
+			sim.Step(SIMULATION_BENCHMARK_DELTA, inputs);
+			statehash = statehash * 31 + sim.GetStateHash();
+		}
+
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		output << playercount << "," << ticks << "," << rounds << "," << seconds << "," << ticks / seconds << "," << ticks * playercount / seconds << ","
+			<< ticks * SIMULATION_BENCHMARK_DELTA << "," << (rounds > 0 ? (double)runs / (rounds * playercount) : 0.0) << ","
+			<< std::hex << statehash << std::dec << std::endl;
+	}
+
+	void RunSimulationBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "players,ticks,rounds,seconds,ticks_per_second,bike_ticks_per_second,simulated_seconds,average_trail_runs,state_hash" << std::endl;
+
+		for (unsigned int playercount : SIMULATION_BENCHMARK_PLAYER_COUNTS)
+			RunSimulationScenario(output, playercount);
+	}
+}
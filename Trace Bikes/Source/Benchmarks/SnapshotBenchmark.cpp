@@ -0,0 +1,322 @@
+#include "Benchmarks.h"
+#include "../TraceSim/SnapshotCodec.h"
+#include "../TraceSim/UdpSocket.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <string.h>
+
+namespace GameDev2D
+{
+	const unsigned int SNAPSHOT_BENCHMARK_PLAYER_COUNTS[] = { 2, 8, 64 };
+	const unsigned int SNAPSHOT_BENCHMARK_TICKS = (unsigned int)FIXED_TICK_RATE * 60; // A minute of play for each player count and link.
+	const float SNAPSHOT_BENCHMARK_ARENA_WIDTH = 1024.0f;
+	const float SNAPSHOT_BENCHMARK_ARENA_HEIGHT = 768.0f;
+	const float SNAPSHOT_BENCHMARK_LANE_HEIGHT = 64.0f;
+
+	// How the snapshots get to the client: the ticks until its ack is back at the server, and the snapshots lost
+	// on the way.
+	struct SnapshotLink
+	{
+		const char* name;
+		unsigned int roundtripticks;
+		unsigned int losspercent;
+	};
+
+	const SnapshotLink SNAPSHOT_BENCHMARK_LINKS[] =
+	{
+		{ "lan", 1, 0 },
+		{ "internet", 24, 2 }, // 100 ms.
+		{ "lossy", 24, 10 },
+	};
+
+	const char* const SNAPSHOT_METHOD_NAMES[] = { "delta", "full_state" };
+
+	// The full state serializer's layout, written as it's laid out in memory: the round, then each bike followed by
+	// every run of its trail.
+	struct FullStateHeader
+	{
+		unsigned int tick;
+		unsigned int round;
+		unsigned int playercount;
+		unsigned int traillimit;
+		long long time;
+		unsigned char roundstate; // A RoundState.
+		unsigned char reserved[3];
+		float countdown;
+	};
+
+	struct FullStateBike
+	{
+		int x;
+		int y;
+		signed char directionx;
+		signed char directiony;
+		unsigned char alive;
+		unsigned char reserved;
+		unsigned int runcount; // Runs the trail holds, they follow the bike.
+		unsigned long long addedcount;
+	};
+
+	struct SnapshotTotals
+	{
+		unsigned long long bytes;
+		unsigned long long decodedbytes;
+		size_t maxbytes;
+		unsigned int overmtu; // Snapshots too big for one datagram.
+		unsigned int decoded;
+		unsigned int full;
+		unsigned int matching;
+		double encodeseconds;
+		double decodeseconds;
+	};
+
+	static void EncodeFullState(const TraceSim& sim, SimSnapshot& snapshot, unsigned int tick, std::vector<unsigned char>& output)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		unsigned int count = bikes.GetCount();
+		sim.Save(snapshot);
+
+		FullStateHeader header;
+		memset(&header, 0, sizeof(header));
+		header.tick = tick;
+		header.round = snapshot.round;
+		header.playercount = count;
+		header.traillimit = count > 0 ? (unsigned int)bikes.trail[0].GetLimit() : 0;
+		header.time = snapshot.time;
+		header.roundstate = (unsigned char)snapshot.roundstate;
+		header.countdown = snapshot.timer.GetPercentage();
+
+		output.resize(sizeof(header));
+		memcpy(output.data(), &header, sizeof(header));
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			const TrailBuffer& trail = bikes.trail[player];
+
+			FullStateBike bike;
+			memset(&bike, 0, sizeof(bike));
+			bike.x = bikes.fixedx[player];
+			bike.y = bikes.fixedy[player];
+			bike.directionx = (signed char)bikes.directionx[player];
+			bike.directiony = (signed char)bikes.directiony[player];
+			bike.alive = bikes.alive[player];
+			bike.runcount = (unsigned int)trail.GetCount();
+			bike.addedcount = trail.GetAddedCount();
+
+			size_t offset = output.size();
+			output.resize(offset + sizeof(bike) + trail.GetCount() * sizeof(TrailRun));
+			memcpy(&output[offset], &bike, sizeof(bike));
+			offset += sizeof(bike);
+
+			for (size_t index = 0; index < trail.GetCount(); index++, offset += sizeof(TrailRun))
+				memcpy(&output[offset], &trail[index], sizeof(TrailRun));
+		}
+	}
+
+	static bool DecodeFullState(const std::vector<unsigned char>& input, ReplicaState& state)
+	{
+		if (input.size() < sizeof(FullStateHeader)) return false;
+
+		FullStateHeader header;
+		memcpy(&header, input.data(), sizeof(header));
+
+		state.tick = header.tick;
+		state.round = header.round;
+		state.roundstate = (RoundState)header.roundstate;
+		state.time = header.time;
+		state.countdown = header.countdown;
+		state.traillimit = header.traillimit;
+
+		unsigned int count = header.playercount;
+		state.fixedx.resize(count);
+		state.fixedy.resize(count);
+		state.directionx.resize(count);
+		state.directiony.resize(count);
+		state.alive.resize(count);
+		state.trails.resize(count);
+		state.runcounts.resize(count);
+
+		size_t offset = sizeof(header);
+		for (unsigned int player = 0; player < count; player++)
+		{
+			FullStateBike bike;
+			if (offset + sizeof(bike) > input.size()) return false;
+			memcpy(&bike, &input[offset], sizeof(bike));
+			offset += sizeof(bike);
+
+			state.fixedx[player] = bike.x;
+			state.fixedy[player] = bike.y;
+			state.directionx[player] = bike.directionx;
+			state.directiony[player] = bike.directiony;
+			state.alive[player] = bike.alive;
+			state.runcounts[player] = bike.addedcount;
+
+			if (offset + bike.runcount * sizeof(TrailRun) > input.size()) return false;
+
+			std::deque<TrailRun>& trail = state.trails[player];
+			trail.clear();
+			for (unsigned int index = 0; index < bike.runcount; index++, offset += sizeof(TrailRun))
+			{
+				TrailRun run;
+				memcpy(&run, &input[offset], sizeof(run));
+				trail.push_back(run);
+			}
+		}
+
+		return true;
+	}
+
+	static bool IsSameRun(const TrailRun& a, const TrailRun& b)
+	{
+		return a.startx == b.startx && a.starty == b.starty && a.endx == b.endx && a.endy == b.endy && a.time == b.time;
+	}
+
+	// Wether the client rebuilt the sim's state, every run of every trail included.
+	static bool IsReplicaMatching(const TraceSim& sim, const SimSnapshot& snapshot, const ReplicaState& state)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		unsigned int count = bikes.GetCount();
+
+		if (state.round != snapshot.round || state.roundstate != snapshot.roundstate || state.time != snapshot.time || state.trails.size() != count)
+			return false;
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			const TrailBuffer& trail = bikes.trail[player];
+			const std::deque<TrailRun>& runs = state.trails[player];
+
+			if (state.fixedx[player] != bikes.fixedx[player] || state.fixedy[player] != bikes.fixedy[player] ||
+				state.directionx[player] != bikes.directionx[player] || state.directiony[player] != bikes.directiony[player] ||
+				state.alive[player] != bikes.alive[player] || state.runcounts[player] != trail.GetAddedCount() || runs.size() != trail.GetCount())
+				return false;
+
+			for (size_t index = 0; index < runs.size(); index++)
+			{
+				if (!IsSameRun(runs[index], trail[index]))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	static void RunSnapshotScenario(std::ofstream& output, unsigned int playercount, const SnapshotLink& link)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		float arenaheight = std::max(SNAPSHOT_BENCHMARK_ARENA_HEIGHT, (playercount + 1) / 2 * SNAPSHOT_BENCHMARK_LANE_HEIGHT);
+		TraceSim sim(SNAPSHOT_BENCHMARK_ARENA_WIDTH, arenaheight, playercount);
+
+		SnapshotEncoder encoder;
+		SnapshotDecoder decoder;
+		SimSnapshot fullsnapshot;
+		ReplicaState fullstate;
+		std::vector<unsigned char> buffers[2];
+
+		// Acks in the order they get back to the server, with the tick they get there.
+		std::deque<std::pair<unsigned int, unsigned int>> acks;
+
+		SnapshotTotals totals[2];
+		memset(totals, 0, sizeof(totals));
+
+		std::vector<TurnInput> inputs;
+		unsigned int seed = 1;
+		unsigned int lossseed = 7;
+
+		for (unsigned int tick = 1; tick <= SNAPSHOT_BENCHMARK_TICKS; tick++)
+		{
+			if (sim.GetRoundState() == RoundState::GameOver)
+				sim.Reset();
+
+			inputs.clear();
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < playercount; player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+
+			while (!acks.empty() && acks.front().first <= tick)
+			{
+				encoder.Acknowledge(acks.front().second);
+				acks.pop_front();
+			}
+
+			Clock::time_point start = Clock::now();
+			encoder.Encode(sim, tick, buffers[0]);
+			Clock::time_point encoded = Clock::now();
+			EncodeFullState(sim, fullsnapshot, tick, buffers[1]);
+			Clock::time_point fullencoded = Clock::now();
+
+			totals[0].encodeseconds += std::chrono::duration<double>(encoded - start).count();
+			totals[1].encodeseconds += std::chrono::duration<double>(fullencoded - encoded).count();
+			totals[0].full += encoder.WasFull();
+			totals[1].full++;
+
+			for (unsigned int method = 0; method < 2; method++)
+			{
+				totals[method].bytes += buffers[method].size();
+				totals[method].maxbytes = std::max(totals[method].maxbytes, buffers[method].size());
+				totals[method].overmtu += buffers[method].size() > NET_MAX_DATAGRAM;
+			}
+
+			// Both methods lose the same snapshots.
+			lossseed = lossseed * 1664525u + 1013904223u;
+			if ((lossseed >> 8) % 100 < link.losspercent) continue;
+
+			start = Clock::now();
+			bool isdecoded = decoder.Decode(buffers[0].data(), buffers[0].size());
+			Clock::time_point decoded = Clock::now();
+			bool isfulldecoded = DecodeFullState(buffers[1], fullstate);
+			Clock::time_point fulldecoded = Clock::now();
+
+			totals[0].decodeseconds += std::chrono::duration<double>(decoded - start).count();
+			totals[1].decodeseconds += std::chrono::duration<double>(fulldecoded - decoded).count();
+
+			if (isdecoded)
+			{
+				acks.push_back(std::make_pair(tick + link.roundtripticks, tick));
+				totals[0].decoded++;
+				totals[0].decodedbytes += buffers[0].size();
+				totals[0].matching += IsReplicaMatching(sim, fullsnapshot, decoder.GetState());
+			}
+
+			if (isfulldecoded)
+			{
+				totals[1].decoded++;
+				totals[1].decodedbytes += buffers[1].size();
+				totals[1].matching += IsReplicaMatching(sim, fullsnapshot, fullstate);
+			}
+		}
+
+		for (unsigned int method = 0; method < 2; method++)
+		{
+			const SnapshotTotals& total = totals[method];
+
+			output << playercount << "," << link.name << "," << link.roundtripticks << "," << link.losspercent << "," << SNAPSHOT_METHOD_NAMES[method] << ","
+				<< SNAPSHOT_BENCHMARK_TICKS << "," << total.full << "," << (double)total.bytes / SNAPSHOT_BENCHMARK_TICKS << "," << total.maxbytes << ","
+				<< total.overmtu * 100.0 / SNAPSHOT_BENCHMARK_TICKS << "," << total.encodeseconds / SNAPSHOT_BENCHMARK_TICKS * 1e9 << ","
+				<< total.decodeseconds / std::max(total.decoded, 1u) * 1e9 << "," << total.bytes / 1e6 / total.encodeseconds << "," << total.decodedbytes / 1e6 / total.decodeseconds << ","
+				<< total.decoded << "," << total.matching << std::endl;
+		}
+	}
+
+	void RunSnapshotBenchmark(const std::string& outputpath)
+	{
+		std::ofstream output(outputpath);
+		output << "players,link,roundtrip_ticks,loss_percent,method,ticks,full_snapshots,bytes_per_tick,max_bytes,over_mtu_percent,ns_per_encode,"
+			"ns_per_decode,encode_mb_per_s,decode_mb_per_s,decoded,decoded_matching" << std::endl;
+
+		for (unsigned int playercount : SNAPSHOT_BENCHMARK_PLAYER_COUNTS)
+		{
+			for (const SnapshotLink& link : SNAPSHOT_BENCHMARK_LINKS)
+				RunSnapshotScenario(output, playercount, link);
+		}
+	}
+}
@@ -0,0 +1,164 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const size_t TRAIL_BUFFER_BENCHMARK_LENGTHS[] = { 64, 1024, 16384 }; // Runs laid per round.
+	const size_t TRAIL_BUFFER_BENCHMARK_RUNS = 4000000; // Every length lays this many runs in total.
+	const size_t TRAIL_BUFFER_BENCHMARK_FADING_RUNS = 8;
+	const unsigned int TRAIL_BUFFER_BENCHMARK_MINUTES = 60; // Of scripted rounds, for the memory held over a long session.
+
+	// A trail as the linked list of heap nodes it was before the runs, freed a node at a time.
+	struct TrailNode
+	{
+		TrailRun run;
+		TrailNode* next;
+	};
+
+	struct TrailBufferTimes
+	{
+		double addseconds;
+		double resetseconds;
+		size_t peakbytes;
+	};
+
+	static TrailRun MakeRun(size_t index)
+	{
+		TrailRun run = { (int)index, 0, (int)index + 1, 0, (long long)index };
+		return run;
+	}
+
+	// Lays rounds of length runs and clears the trail after each, on a linked list, a std::vector that starts every
+	// round empty, or a TrailBuffer with the limit. Returns a checksum of the runs, so nothing is optimized away.
+	static long long TimeTrail(unsigned int method, size_t length, size_t limit, TrailBufferTimes& times)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		TrailNode* head = nullptr;
+		std::vector<TrailRun> vector;
+		TrailBuffer buffer(limit);
+		long long checksum = 0;
+		times = TrailBufferTimes();
+
+		for (size_t round = 0; round < TRAIL_BUFFER_BENCHMARK_RUNS / length; round++)
+		{
+			Clock::time_point start = Clock::now();
+			for (size_t index = 0; index < length; index++)
+			{
+				if (method == 0)
+				{
+					TrailNode* node = new TrailNode();
+					node->run = MakeRun(index);
+					node->next = head;
+					head = node;
+				}
+				else if (method == 1)
+					vector.push_back(MakeRun(index));
+				else
+					buffer.Add(MakeRun(index));
+			}
+			Clock::time_point added = Clock::now();
+
+			if (method == 0)
+			{
+				checksum += head->run.time;
+				times.peakbytes = std::max(times.peakbytes, length * sizeof(TrailNode));
+				while (head != nullptr)
+				{
+					TrailNode* next = head->next;
+					delete head;
+					head = next;
+				}
+			}
+			else if (method == 1)
+			{
+				checksum += vector.back().time;
+				times.peakbytes = std::max(times.peakbytes, vector.capacity() * sizeof(TrailRun));
+				std::vector<TrailRun>().swap(vector);
+			}
+			else
+			{
+				checksum += buffer.GetNewest().time;
+				times.peakbytes = std::max(times.peakbytes, buffer.GetCapacity() * sizeof(TrailRun));
+				buffer.Clear();
+			}
+			Clock::time_point cleared = Clock::now();
+
+			times.addseconds += std::chrono::duration<double>(added - start).count();
+			times.resetseconds += std::chrono::duration<double>(cleared - added).count();
+		}
+
+		return checksum;
+	}
+
+	// Plays scripted rounds for an hour, with the trails limited or not, and returns the most memory they held.
+	static size_t GetSessionTrailMemory(unsigned int limit, unsigned int& rounds)
+	{
+		TraceSim sim(1024.0f, 768.0f);
+		sim.SetTrailLimit(limit);
+		sim.Reset();
+
+		std::vector<TurnInput> inputs;
+		unsigned int seed = 1;
+		size_t peakbytes = 0;
+		rounds = 0;
+
+		for (unsigned long long tick = 0; tick < TRAIL_BUFFER_BENCHMARK_MINUTES * 60ull * FIXED_TICK_RATE; tick++)
+		{
+			inputs.clear();
+
+			if (sim.GetRoundState() == RoundState::Running)
+			{
+				TurnInput input;
+				for (unsigned int player = 0; player < sim.GetPlayerCount(); player++)
+				{
+					if (ScriptBenchmarkTurn(sim, player, seed, input))
+						inputs.push_back(input);
+				}
+			}
+			else if (sim.GetRoundState() == RoundState::GameOver)
+			{
+				sim.Reset();
+				rounds++;
+			}
+
+			sim.Step(1.0 / FIXED_TICK_RATE, inputs);
+			peakbytes = std::max(peakbytes, sim.GetTrailMemoryUsage());
+		}
+
+		return peakbytes;
+	}
+
+	void RunTrailBufferBenchmark(const std::string& outputpath)
+	{
+		const char* methods[] = { "linked_list", "vector", "ring_buffer", "ring_buffer_fading" };
+
+		std::ofstream output(outputpath);
+		output << "test,method,runs_per_round,rounds,ns_per_add,ns_per_reset,peak_bytes,checksum" << std::endl;
+
+		for (size_t length : TRAIL_BUFFER_BENCHMARK_LENGTHS)
+		{
+			for (unsigned int method = 0; method < 4; method++)
+			{
+				TrailBufferTimes times;
+				size_t rounds = TRAIL_BUFFER_BENCHMARK_RUNS / length;
+				long long checksum = TimeTrail(std::min(method, 2u), length, method == 3 ? TRAIL_BUFFER_BENCHMARK_FADING_RUNS : 0, times);
+
+				output << "trail," << methods[method] << "," << length << "," << rounds << "," << times.addseconds / (rounds * length) * 1e9 << ","
+					<< times.resetseconds / rounds * 1e9 << "," << times.peakbytes << "," << checksum << std::endl;
+			}
+		}
+
+		// A session of scripted rounds, the peak memory of limited trails is fixed when the limit is set.
+		for (unsigned int fading = 0; fading < 2; fading++)
+		{
+			unsigned int rounds = 0;
+			size_t peakbytes = GetSessionTrailMemory(fading ? (unsigned int)TRAIL_BUFFER_BENCHMARK_FADING_RUNS : 0, rounds);
+
+			output << "session," << methods[2 + fading] << ",," << rounds << ",,," << peakbytes << "," << std::endl;
+		}
+	}
+}
@@ -0,0 +1,226 @@
+#include "Benchmarks.h"
+#include "../TraceSim/TraceSim.h"
+#include "TrailGrid.h"
+#include <chrono>
+#include <fstream>
+#include <math.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	const double TRAIL_BENCHMARK_DURATION = 600.0; // Ten minute round.
+	const double TRAIL_BENCHMARK_DELTA = 1.0 / 60.0;
+	const float TRAIL_BENCHMARK_HALF_SIZE = BIKE_SIZE * 0.5f;
+	const float TRAIL_BENCHMARK_LANE_SPACING = 32.0f;
+	const float TRAIL_BENCHMARK_SEGMENT_DISTANCE = 8.0f; // The Segment trail laid a piece every 8 pixels.
+	const unsigned int TRAIL_BENCHMARK_IGNORE_COUNT = 9; // And didn't check a bike against its own newest pieces.
+
+	// Large enough that both bikes survive the whole round running lanes in their own half.
+	const float TRAIL_BENCHMARK_ARENA_WIDTH = 4096.0f;
+	const float TRAIL_BENCHMARK_ARENA_HEIGHT = 3072.0f;
+
+	// Mirrors the Segment linked list, newest piece first, one heap node per piece.
+	struct BenchmarkSegment
+	{
+		float x;
+		float y;
+		BenchmarkSegment* next;
+	};
+
+	// A bike that sweeps back and forth across lanes between minx and maxx, climbing one lane at every end.
+	struct BenchmarkBike
+	{
+		float x;
+		float y;
+		float directionx;
+		float directiony;
+		float nextdirectionx;
+		float minx;
+		float maxx;
+		float lanetarget;
+		float lastx;
+		float lasty;
+		unsigned int trail;
+		BenchmarkSegment* segments;
+		TrailBuffer runs;
+	};
+
+	static void AddBenchmarkSegment(BenchmarkBike& bike, TrailGrid& grid)
+	{
+		bike.segments = new BenchmarkSegment{ bike.x, bike.y, bike.segments };
+		bike.lastx = bike.x;
+		bike.lasty = bike.y;
+		grid.Add(bike.trail, bike.x, bike.y, TRAIL_BENCHMARK_HALF_SIZE, TRAIL_BENCHMARK_HALF_SIZE);
+	}
+
+	static void AddBenchmarkRun(BenchmarkBike& bike)
+	{
+		TrailRun run;
+		run.startx = run.endx = ToFixed(bike.x);
+		run.starty = run.endy = ToFixed(bike.y);
+		run.time = 0;
+		bike.runs.Add(run);
+	}
+
+	static void MoveBenchmarkBike(BenchmarkBike& bike, TrailGrid& grid, float distance)
+	{
+		bike.x += bike.directionx * distance;
+		bike.y += bike.directiony * distance;
+		bike.runs.GetNewest().endx = ToFixed(bike.x);
+		bike.runs.GetNewest().endy = ToFixed(bike.y);
+
+		// Scripted turns, each one places a segment just like Game::Turn.
+		if ((bike.directionx > 0.0f && bike.x >= bike.maxx) || (bike.directionx < 0.0f && bike.x <= bike.minx))
+		{
+			bike.nextdirectionx = -bike.directionx;
+			bike.lanetarget = bike.y + TRAIL_BENCHMARK_LANE_SPACING;
+			bike.directionx = 0.0f;
+			bike.directiony = 1.0f;
+			AddBenchmarkSegment(bike, grid);
+			AddBenchmarkRun(bike);
+		}
+		else if (bike.directiony > 0.0f && bike.y >= bike.lanetarget)
+		{
+			bike.directionx = bike.nextdirectionx;
+			bike.directiony = 0.0f;
+			AddBenchmarkSegment(bike, grid);
+			AddBenchmarkRun(bike);
+		}
+
+		if (fabsf(bike.x - bike.lastx) >= TRAIL_BENCHMARK_SEGMENT_DISTANCE || fabsf(bike.y - bike.lasty) >= TRAIL_BENCHMARK_SEGMENT_DISTANCE)
+			AddBenchmarkSegment(bike, grid);
+	}
+
+	// The collision walk Game::CheckBikesIntersections used before the TrailGrid.
+	static bool IsHittingLinkedTrail(const BenchmarkBike& bike, const BenchmarkSegment* segment, unsigned int ignorecount)
+	{
+		unsigned int count = 0;
+
+		while (segment != nullptr)
+		{
+			count++;
+
+			if (count > ignorecount &&
+				!(segment->x - TRAIL_BENCHMARK_HALF_SIZE > bike.x + TRAIL_BENCHMARK_HALF_SIZE || segment->x + TRAIL_BENCHMARK_HALF_SIZE < bike.x - TRAIL_BENCHMARK_HALF_SIZE ||
+				  segment->y - TRAIL_BENCHMARK_HALF_SIZE > bike.y + TRAIL_BENCHMARK_HALF_SIZE || segment->y + TRAIL_BENCHMARK_HALF_SIZE < bike.y - TRAIL_BENCHMARK_HALF_SIZE))
+				return true;
+
+			segment = segment->next;
+		}
+
+		return false;
+	}
+
+	static bool IsHittingGridTrail(const BenchmarkBike& bike, const TrailGrid& grid, unsigned int trail, unsigned int ignorecount)
+	{
+		unsigned int count = grid.GetCount(trail);
+		if (count <= ignorecount)
+			return false;
+
+		return grid.Overlaps(trail, count - ignorecount, bike.x, bike.y, TRAIL_BENCHMARK_HALF_SIZE, TRAIL_BENCHMARK_HALF_SIZE);
+	}
+
+	void RunTrailCollisionBenchmark(const std::string& outputpath)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		TrailGrid grid(TRAIL_BENCHMARK_ARENA_WIDTH, TRAIL_BENCHMARK_ARENA_HEIGHT, TRAIL_BENCHMARK_SEGMENT_DISTANCE, PLAYER_COUNT);
+
+		float halfwidth = TRAIL_BENCHMARK_ARENA_WIDTH * 0.5f;
+		BenchmarkBike bikes[PLAYER_COUNT] =
+		{
+			{ 16.0f, 16.0f, 1.0f, 0.0f, 0.0f, 16.0f, halfwidth - 16.0f, 0.0f, 0.0f, 0.0f, RED_PLAYER, nullptr, TrailBuffer() },
+			{ halfwidth + 16.0f, 16.0f, 1.0f, 0.0f, 0.0f, halfwidth + 16.0f, TRAIL_BENCHMARK_ARENA_WIDTH - 16.0f, 0.0f, 0.0f, 0.0f, BLUE_PLAYER, nullptr, TrailBuffer() },
+		};
+
+		for (BenchmarkBike& bike : bikes)
+		{
+			AddBenchmarkSegment(bike, grid);
+			AddBenchmarkRun(bike);
+		}
+
+		std::ofstream output(outputpath);
+		output << "second,trail_length,trail_runs,linked_list_us_per_frame,grid_us_per_frame,runs_us_per_frame" << std::endl;
+
+		unsigned int ignorecount = TRAIL_BENCHMARK_IGNORE_COUNT;
+		unsigned int framespersecond = (unsigned int)(1.0 / TRAIL_BENCHMARK_DELTA + 0.5);
+		unsigned int framecount = (unsigned int)(TRAIL_BENCHMARK_DURATION / TRAIL_BENCHMARK_DELTA);
+		unsigned int mismatches = 0;
+		unsigned int hits = 0;
+		double linkedtotal = 0.0;
+		double gridtotal = 0.0;
+		double runstotal = 0.0;
+
+		for (unsigned int frame = 0; frame < framecount; frame++)
+		{
+			for (BenchmarkBike& bike : bikes)
+				MoveBenchmarkBike(bike, grid, (float)(BIKE_SPEED * TRAIL_BENCHMARK_DELTA));
+
+			// Old path: walk both linked lists for both bikes.
+			Clock::time_point start = Clock::now();
+			bool linkedhit[PLAYER_COUNT];
+			for (unsigned int i = 0; i < PLAYER_COUNT; i++)
+			{
+				const BenchmarkBike& other = bikes[(i + 1) % PLAYER_COUNT];
+				linkedhit[i] = IsHittingLinkedTrail(bikes[i], other.segments, 0) || IsHittingLinkedTrail(bikes[i], bikes[i].segments, ignorecount);
+			}
+
+			// New path: grid lookups only.
+			Clock::time_point middle = Clock::now();
+			bool gridhit[PLAYER_COUNT];
+			for (unsigned int i = 0; i < PLAYER_COUNT; i++)
+			{
+				const BenchmarkBike& other = bikes[(i + 1) % PLAYER_COUNT];
+				gridhit[i] = IsHittingGridTrail(bikes[i], grid, other.trail, 0) || IsHittingGridTrail(bikes[i], grid, bikes[i].trail, ignorecount);
+			}
+
+			// Trail runs: one box test per turn.
+			Clock::time_point gridend = Clock::now();
+			bool runhit[PLAYER_COUNT];
+			for (unsigned int i = 0; i < PLAYER_COUNT; i++)
+			{
+				const BenchmarkBike& other = bikes[(i + 1) % PLAYER_COUNT];
+				int x = ToFixed(bikes[i].x);
+				int y = ToFixed(bikes[i].y);
+				runhit[i] = TraceSim::IsBoxHittingTrail(other.runs, x, y, ToFixed(TRAIL_BENCHMARK_HALF_SIZE), 0) ||
+					TraceSim::IsBoxHittingTrail(bikes[i].runs, x, y, ToFixed(TRAIL_BENCHMARK_HALF_SIZE), ToFixed(TRAIL_IGNORE_DISTANCE));
+			}
+			Clock::time_point end = Clock::now();
+
+			for (unsigned int i = 0; i < PLAYER_COUNT; i++)
+			{
+				mismatches += linkedhit[i] != gridhit[i] ? 1 : 0;
+				mismatches += linkedhit[i] != runhit[i] ? 1 : 0;
+				hits += gridhit[i] ? 1 : 0;
+			}
+
+			linkedtotal += std::chrono::duration<double, std::micro>(middle - start).count();
+			gridtotal += std::chrono::duration<double, std::micro>(gridend - middle).count();
+			runstotal += std::chrono::duration<double, std::micro>(end - gridend).count();
+
+			if ((frame + 1) % framespersecond == 0)
+			{
+				unsigned int length = grid.GetCount(RED_PLAYER) + grid.GetCount(BLUE_PLAYER);
+				size_t runs = bikes[RED_PLAYER].runs.GetCount() + bikes[BLUE_PLAYER].runs.GetCount();
+				output << (frame + 1) / framespersecond << "," << length << "," << runs << "," << linkedtotal / framespersecond
+					<< "," << gridtotal / framespersecond << "," << runstotal / framespersecond << std::endl;
+				linkedtotal = 0.0;
+				gridtotal = 0.0;
+				runstotal = 0.0;
+			}
+		}
+
+		// The scripted round is collision free, all paths must agree on that.
+		output << "# hits: " << hits << ", mismatches: " << mismatches << std::endl;
+
+		for (BenchmarkBike& bike : bikes)
+		{
+			while (bike.segments != nullptr)
+			{
+				BenchmarkSegment* next = bike.segments->next;
+				delete bike.segments;
+				bike.segments = next;
+			}
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#include "TrailGrid.h"
+#include <algorithm>
+#include <math.h>
+
+namespace GameDev2D
+{
+	TrailGrid::TrailGrid(float width, float height, float cellsize, unsigned int ownercount) :
+		m_CellSize(cellsize),
+		m_MaxHalfExtent(0.0f),
+		m_Columns((int)ceilf(width / cellsize) + 1),
+		m_Rows((int)ceilf(height / cellsize) + 1)
+	{
+		m_Cells.assign(m_Columns * m_Rows, -1);
+		m_Counts.assign(ownercount, 0);
+	}
+
+	unsigned int TrailGrid::Add(unsigned int owner, float x, float y, float halfwidth, float halfheight)
+	{
+		int cell = GetRow(y) * m_Columns + GetColumn(x);
+
+		Entry entry;
+		entry.x = x;
+		entry.y = y;
+		entry.halfwidth = halfwidth;
+		entry.halfheight = halfheight;
+		entry.owner = owner;
+		entry.order = m_Counts[owner]++;
+		entry.next = m_Cells[cell];
+
+		m_Cells[cell] = (int)m_Entries.size();
+		m_Entries.push_back(entry);
+
+		m_MaxHalfExtent = std::max(m_MaxHalfExtent, std::max(halfwidth, halfheight));
+
+		return entry.order;
+	}
+
+	bool TrailGrid::Overlaps(unsigned int owner, unsigned int orderlimit, float x, float y, float halfwidth, float halfheight) const
+	{
+		// Any piece that can touch the box has its center within this range.
+		int firstcolumn = GetColumn(x - halfwidth - m_MaxHalfExtent);
+		int lastcolumn = GetColumn(x + halfwidth + m_MaxHalfExtent);
+		int firstrow = GetRow(y - halfheight - m_MaxHalfExtent);
+		int lastrow = GetRow(y + halfheight + m_MaxHalfExtent);
+
+		for (int row = firstrow; row <= lastrow; row++)
+		{
+			for (int column = firstcolumn; column <= lastcolumn; column++)
+			{
+				int index = m_Cells[row * m_Columns + column];
+
+				while (index != -1)
+				{
+					const Entry& entry = m_Entries[index];
+
+					if (entry.owner == owner && entry.order < orderlimit &&
+						!(entry.x - entry.halfwidth > x + halfwidth || entry.x + entry.halfwidth < x - halfwidth ||
+						  entry.y - entry.halfheight > y + halfheight || entry.y + entry.halfheight < y - halfheight))
+						return true;
+
+					index = entry.next;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	unsigned int TrailGrid::GetCount(unsigned int owner) const
+	{
+		return m_Counts[owner];
+	}
+
+	void TrailGrid::Clear()
+	{
+		std::fill(m_Cells.begin(), m_Cells.end(), -1);
+		std::fill(m_Counts.begin(), m_Counts.end(), 0);
+		m_Entries.clear();
+		m_MaxHalfExtent = 0.0f;
+	}
+
+	int TrailGrid::GetColumn(float x) const
+	{
+		// Pieces outside the arena are clamped into the border cells.
+		return std::min(std::max((int)floorf(x / m_CellSize), 0), m_Columns - 1);
+	}
+
+	int TrailGrid::GetRow(float y) const
+	{
+		return std::min(std::max((int)floorf(y / m_CellSize), 0), m_Rows - 1);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+namespace GameDev2D
+{
+	// Uniform grid spatial index for trail pieces. Every piece is bucketed into the cell that
+	// contains its center, so an overlap query only has to visit the handful of cells around
+	// the queried box instead of every piece of every trail. The sim doesn't use it, it's the
+	// TrailCollision benchmark's baseline.
+	class TrailGrid
+	{
+	public:
+		TrailGrid(float width, float height, float cellsize, unsigned int ownercount);
+
+		// Adds a trail piece for an owner, returns its order within the owner's trail (0 being the oldest).
+		unsigned int Add(unsigned int owner, float x, float y, float halfwidth, float halfheight);
+
+		// Returns wether the box overlaps any piece of the owner's trail whose order is below orderlimit.
+		bool Overlaps(unsigned int owner, unsigned int orderlimit, float x, float y, float halfwidth, float halfheight) const;
+
+		// Returns the number of pieces added for an owner.
+		unsigned int GetCount(unsigned int owner) const;
+
+		// Removes every trail piece.
+		void Clear();
+
+	private:
+		struct Entry
+		{
+			float x;
+			float y;
+			float halfwidth;
+			float halfheight;
+			unsigned int owner;
+			unsigned int order;
+			int next; // Next entry in the same cell, -1 terminates.
+		};
+
+		int GetColumn(float x) const;
+		int GetRow(float y) const;
+
+		std::vector<int> m_Cells; // Head entry per cell, -1 when empty.
+		std::vector<Entry> m_Entries;
+		std::vector<unsigned int> m_Counts;
+
+		float m_CellSize;
+		float m_MaxHalfExtent;
+		int m_Columns;
+		int m_Rows;
+	};
+}
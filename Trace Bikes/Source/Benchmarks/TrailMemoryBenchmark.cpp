@@ -0,0 +1,151 @@
+#include "Benchmarks.h"
+#include "../Framework/Graphics/Sprite.h"
+#include "../TraceSim/TraceSim.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace GameDev2D
+{
+	const unsigned int TRAIL_MEMORY_BENCHMARK_MINUTES = 10;
+	const double TRAIL_MEMORY_BENCHMARK_DELTA = 1.0 / 240.0;
+	const unsigned int TRAIL_MEMORY_BENCHMARK_TICKS_PER_MINUTE = 240 * 60;
+	const unsigned int TRAIL_MEMORY_SHARED_SPRITES = PLAYER_COUNT; // One segment sprite per trail color.
+	const float TRAIL_MEMORY_SEGMENT_DISTANCE = 8.0f; // A Segment was laid at every turn and every 8 pixels in between.
+	const float TRAIL_MEMORY_CANVAS_TILE_SIZE = 512.0f; // As the game's CANVAS_TILE_SIZE, the runs are drawn to tiles of the arena.
+	const size_t TRAIL_MEMORY_CANVAS_TILE_BYTES = 512 * 512 * 4; // An RGBA texture per tile.
+
+	// What a segment cost when every one of them was a Sprite linked to the next: the Sprite and its link, its
+	// VertexData, the VertexBuffer with the client copy of the quad and its attribute lists, and the GPU buffer.
+	static size_t GetSpriteSegmentBytes()
+	{
+		size_t vertexbytes = SPRITE_VERTEX_SIZE * SPRITE_VERTEX_COUNT * sizeof(float);
+		return sizeof(Sprite) + sizeof(Sprite*) + sizeof(VertexData) + sizeof(VertexBuffer) + 2 * (sizeof(int) + sizeof(unsigned int)) + vertexbytes * 2;
+	}
+
+	// Marks the canvas tiles a run is drawn to, and returns how many weren't marked yet.
+	static size_t MarkCanvasTiles(const TrailRun& run, std::vector<bool>& tiles, int columns, int rows)
+	{
+		int firstcolumn = std::max((int)(ToPixels(std::min(run.startx, run.endx)) / TRAIL_MEMORY_CANVAS_TILE_SIZE), 0);
+		int lastcolumn = std::min((int)(ToPixels(std::max(run.startx, run.endx)) / TRAIL_MEMORY_CANVAS_TILE_SIZE), columns - 1);
+		int firstrow = std::max((int)(ToPixels(std::min(run.starty, run.endy)) / TRAIL_MEMORY_CANVAS_TILE_SIZE), 0);
+		int lastrow = std::min((int)(ToPixels(std::max(run.starty, run.endy)) / TRAIL_MEMORY_CANVAS_TILE_SIZE), rows - 1);
+		size_t marked = 0;
+
+		for (int row = firstrow; row <= lastrow; row++)
+		{
+			for (int column = firstcolumn; column <= lastcolumn; column++)
+			{
+				if (!tiles[row * columns + column])
+				{
+					tiles[row * columns + column] = true;
+					marked++;
+				}
+			}
+		}
+
+		return marked;
+	}
+
+	// The number of Segments the trail would have been made of.
+	static size_t GetSegmentCount(const TrailBuffer& trail)
+	{
+		size_t segments = 0;
+
+		for (size_t index = 0; index < trail.GetCount(); index++)
+			segments += (size_t)(ToPixels(trail[index].GetLength()) / TRAIL_MEMORY_SEGMENT_DISTANCE) + 1;
+
+		return segments;
+	}
+
+	void RunTrailMemoryBenchmark(const std::string& outputpath)
+	{
+		TraceSim sim(1024.0f, 768.0f);
+		std::vector<TurnInput> inputs;
+		inputs.reserve(PLAYER_COUNT);
+
+		unsigned int seed = 1;
+		size_t spritebytes = GetSpriteSegmentBytes();
+		size_t countedruns[PLAYER_COUNT] = {}; // Runs and Segments of the current round's trails already counted.
+		size_t countedsegments[PLAYER_COUNT] = {};
+
+		// The game keeps the tiles of earlier rounds for the next ones, it holds as many as the most a round used.
+		int columns = (int)ceilf(sim.GetArenaWidth() / TRAIL_MEMORY_CANVAS_TILE_SIZE);
+		int rows = (int)ceilf(sim.GetArenaHeight() / TRAIL_MEMORY_CANVAS_TILE_SIZE);
+		std::vector<bool> roundtiles(columns * rows, false);
+		size_t roundtilecount = 0;
+		size_t pooledtiles = 0;
+
+		std::ofstream output(outputpath);
+		// The benchmark runs without an OpenGL context, the Graphics counters can't be read. The trail bytes are the
+		// sim's, the rest are estimates of what the game and the Sprite per segment version would hold.
+		output << "minute,rounds,runs_added,peak_runs,trail_bytes,est_canvas_tiles,est_canvas_bytes,est_record_gl_objects,segments_added,peak_segments,est_sprite_bytes,est_sprite_gl_objects,est_sprite_gl_objects_created" << std::endl;
+
+		for (unsigned int minute = 1; minute <= TRAIL_MEMORY_BENCHMARK_MINUTES; minute++)
+		{
+			unsigned int rounds = 0;
+			size_t addedruns = 0;
+			size_t addedsegments = 0;
+			size_t peakruns = 0;
+			size_t peaksegments = 0;
+			size_t peakbytes = 0;
+
+			for (unsigned int tick = 0; tick < TRAIL_MEMORY_BENCHMARK_TICKS_PER_MINUTE; tick++)
+			{
+				inputs.clear();
+
+				if (sim.GetRoundState() == RoundState::Running)
+				{
+					TurnInput input;
+					for (unsigned int player = 0; player < PLAYER_COUNT; player++)
+					{
+						if (ScriptBenchmarkTurn(sim, player, seed, input))
+							inputs.push_back(input);
+					}
+				}
+				else if (sim.GetRoundState() == RoundState::GameOver)
+				{
+					sim.Reset();
+					rounds++;
+
+					for (unsigned int player = 0; player < PLAYER_COUNT; player++)
+						countedruns[player] = countedsegments[player] = 0;
+
+					std::fill(roundtiles.begin(), roundtiles.end(), false);
+					roundtilecount = 0;
+				}
+
+				sim.Step(TRAIL_MEMORY_BENCHMARK_DELTA, inputs);
+
+				size_t runs = 0;
+				size_t segments = 0;
+				for (unsigned int player = 0; player < PLAYER_COUNT; player++)
+				{
+					const TrailBuffer& trail = sim.GetBikes().trail[player];
+					size_t segmentcount = GetSegmentCount(trail);
+
+					// The newest run counted may have grown since.
+					for (size_t index = std::max(countedruns[player], (size_t)1) - 1; index < trail.GetCount(); index++)
+						roundtilecount += MarkCanvasTiles(trail[index], roundtiles, columns, rows);
+
+					addedruns += trail.GetCount() - std::min(trail.GetCount(), countedruns[player]);
+					addedsegments += segmentcount - std::min(segmentcount, countedsegments[player]);
+					countedruns[player] = trail.GetCount();
+					countedsegments[player] = segmentcount;
+					runs += trail.GetCount();
+					segments += segmentcount;
+				}
+
+				peakruns = std::max(peakruns, runs);
+				peaksegments = std::max(peaksegments, segments);
+				peakbytes = std::max(peakbytes, sim.GetTrailMemoryUsage());
+				pooledtiles = std::max(pooledtiles, roundtilecount);
+			}
+
+			// Every Sprite owns a vertex array and a vertex buffer, every tile a texture and a framebuffer.
+			output << minute << "," << rounds << "," << addedruns << "," << peakruns << "," << peakbytes
+				<< "," << pooledtiles << "," << pooledtiles * TRAIL_MEMORY_CANVAS_TILE_BYTES << "," << TRAIL_MEMORY_SHARED_SPRITES * 2 + pooledtiles * 2
+				<< "," << addedsegments << "," << peaksegments << "," << peaksegments * spritebytes << "," << peaksegments * 2 << "," << addedsegments * 2 << std::endl;
+		}
+	}
+}
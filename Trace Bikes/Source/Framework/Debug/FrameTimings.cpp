@@ -0,0 +1,176 @@
+#include "FrameTimings.h"
+#include <fstream>
+#include <math.h>
+#include <string.h>
+
+
+namespace GameDev2D
+{
+    FrameTimings::FrameTimings() :
+        m_FrameNumber(0),
+        m_Head(0),
+        m_Count(0)
+    {
+        Clear();
+    }
+
+    void FrameTimings::Add(double aUpdate, double aDraw, double aTotal)
+    {
+        //Remove the frame that's about to be overwritten from the histogram, and from the max queues
+        if (m_Count == FRAME_TIMINGS_CAPACITY)
+        {
+            unsigned long long oldest = m_FrameNumber - FRAME_TIMINGS_CAPACITY;
+            for (unsigned int i = 0; i < FrameTiming_Count; i++)
+            {
+                m_Histogram[i][GetBucket(m_Frames[m_Head][i])]--;
+
+                if (m_MaxCount[i] > 0 && m_MaxFrames[i][m_MaxStart[i]] == oldest)
+                {
+                    m_MaxStart[i] = (m_MaxStart[i] + 1) % FRAME_TIMINGS_CAPACITY;
+                    m_MaxCount[i]--;
+                }
+            }
+        }
+        else
+        {
+            m_Count++;
+        }
+
+        m_Frames[m_Head][FrameTiming_Update] = static_cast<float>(aUpdate);
+        m_Frames[m_Head][FrameTiming_Draw] = static_cast<float>(aDraw);
+        m_Frames[m_Head][FrameTiming_Total] = static_cast<float>(aTotal);
+
+        for (unsigned int i = 0; i < FrameTiming_Count; i++)
+        {
+            m_Histogram[i][GetBucket(m_Frames[m_Head][i])]++;
+
+            //Frames no slower than this one can't be the max anymore, it outlasts them
+            float time = m_Frames[m_Head][i];
+            while (m_MaxCount[i] > 0)
+            {
+                unsigned int newest = (m_MaxStart[i] + m_MaxCount[i] - 1) % FRAME_TIMINGS_CAPACITY;
+                if (m_Frames[m_MaxFrames[i][newest] % FRAME_TIMINGS_CAPACITY][i] > time)
+                {
+                    break;
+                }
+                m_MaxCount[i]--;
+            }
+
+            m_MaxFrames[i][(m_MaxStart[i] + m_MaxCount[i]) % FRAME_TIMINGS_CAPACITY] = m_FrameNumber;
+            m_MaxCount[i]++;
+        }
+
+        m_Head = (m_Head + 1) % FRAME_TIMINGS_CAPACITY;
+        m_FrameNumber++;
+    }
+
+    void FrameTimings::Clear()
+    {
+        memset(m_Frames, 0, sizeof(m_Frames));
+        memset(m_Histogram, 0, sizeof(m_Histogram));
+        memset(m_MaxFrames, 0, sizeof(m_MaxFrames));
+        memset(m_MaxStart, 0, sizeof(m_MaxStart));
+        memset(m_MaxCount, 0, sizeof(m_MaxCount));
+        m_FrameNumber = 0;
+        m_Head = 0;
+        m_Count = 0;
+    }
+
+    unsigned int FrameTimings::GetCount() const
+    {
+        return m_Count;
+    }
+
+    double FrameTimings::GetPercentile(FrameTiming aTiming, double aPercentile) const
+    {
+        if (m_Count == 0)
+        {
+            return 0.0;
+        }
+
+        //The rank of the frame at the percentile, the first frame is rank 1
+        unsigned int rank = static_cast<unsigned int>(ceil(aPercentile * 0.01 * static_cast<double>(m_Count)));
+        rank = rank < 1 ? 1 : (rank > m_Count ? m_Count : rank);
+
+        //Walk the histogram until we've seen enough frames and report the bucket's upper bound, 
+        //which is never more than the slowest frame. The last bucket has no upper bound
+        double max = GetMax(aTiming);
+        unsigned int frames = 0;
+        for (unsigned int bucket = 0; bucket < FRAME_TIMINGS_BUCKET_COUNT - 1; bucket++)
+        {
+            frames += m_Histogram[aTiming][bucket];
+            if (frames >= rank)
+            {
+                double time = static_cast<double>(bucket + 1) * FRAME_TIMINGS_BUCKET_SIZE;
+                return time < max ? time : max;
+            }
+        }
+        return max;
+    }
+
+    double FrameTimings::GetMax(FrameTiming aTiming) const
+    {
+        if (m_MaxCount[aTiming] == 0)
+        {
+            return 0.0;
+        }
+
+        //Frames are written at their frame number's slot, see Add()
+        unsigned long long slowest = m_MaxFrames[aTiming][m_MaxStart[aTiming]];
+        return static_cast<double>(m_Frames[slowest % FRAME_TIMINGS_CAPACITY][aTiming]);
+    }
+
+    bool FrameTimings::Export(const std::string& aPath) const
+    {
+        std::ofstream file(aPath.c_str());
+        if (file.is_open() == false)
+        {
+            return false;
+        }
+
+        file << "frame,update_ms,draw_ms,total_ms\n";
+
+        //The oldest frame is at the head once the ring buffer has wrapped around
+        unsigned int start = m_Count == FRAME_TIMINGS_CAPACITY ? m_Head : 0;
+        unsigned long long frameNumber = m_FrameNumber - m_Count;
+        for (unsigned int i = 0; i < m_Count; i++)
+        {
+            const float* frame = m_Frames[(start + i) % FRAME_TIMINGS_CAPACITY];
+            file << frameNumber + i << "," << frame[FrameTiming_Update] << "," << frame[FrameTiming_Draw] << "," << frame[FrameTiming_Total] << "\n";
+        }
+
+        return file.good();
+    }
+
+    bool FrameTimings::ExportSummary(const std::string& aPath) const
+    {
+        std::ofstream file(aPath.c_str());
+        if (file.is_open() == false)
+        {
+            return false;
+        }
+
+        file << "timing,frames,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+        const char* names[FrameTiming_Count] = { "update", "draw", "total" };
+        for (unsigned int i = 0; i < FrameTiming_Count; i++)
+        {
+            FrameTiming timing = static_cast<FrameTiming>(i);
+            file << names[i] << "," << m_Count << "," << GetPercentile(timing, 50.0) << "," << GetPercentile(timing, 95.0) << ","
+                 << GetPercentile(timing, 99.0) << "," << GetMax(timing) << "\n";
+        }
+
+        return file.good();
+    }
+
+    unsigned int FrameTimings::GetBucket(float aTime) const
+    {
+        if (aTime <= 0.0f)
+        {
+            return 0;
+        }
+
+        unsigned int bucket = static_cast<unsigned int>(static_cast<double>(aTime) / FRAME_TIMINGS_BUCKET_SIZE);
+        return bucket < FRAME_TIMINGS_BUCKET_COUNT ? bucket : FRAME_TIMINGS_BUCKET_COUNT - 1;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef __GameDev2D__FrameTimings__
+#define __GameDev2D__FrameTimings__
+
+#include <string>
+
+
+namespace GameDev2D
+{
+    //Constants
+    const unsigned int FRAME_TIMINGS_CAPACITY = 4096;           //Number of frames kept, about a minute at 60 fps
+    const double FRAME_TIMINGS_BUCKET_SIZE = 0.05;              //Histogram resolution, in milliseconds
+    const unsigned int FRAME_TIMINGS_BUCKET_COUNT = 2000;       //Covers up to 100 milliseconds, slower frames share the last bucket
+
+    //The per-frame timings that are recorded
+    enum FrameTiming
+    {
+        FrameTiming_Update = 0,
+        FrameTiming_Draw,
+        FrameTiming_Total,
+        FrameTiming_Count
+    };
+
+    //Keeps the update, draw and total time of the last FRAME_TIMINGS_CAPACITY frames in a ring buffer, along
+    //with a histogram of those same frames to answer percentile queries. Nothing is allocated after construction,
+    //the histogram is kept in sync with the ring buffer by removing frames as they are overwritten
+    class FrameTimings
+    {
+    public:
+        FrameTimings();
+
+        //Records a frame's timings, in milliseconds
+        void Add(double update, double draw, double total);
+
+        //Forgets all the recorded frames
+        void Clear();
+
+        //Returns the number of frames currently recorded
+        unsigned int GetCount() const;
+
+        //Returns the time (in milliseconds) the percentile (0 to 100) of the recorded frames are at or under,
+        //accurate to FRAME_TIMINGS_BUCKET_SIZE
+        double GetPercentile(FrameTiming timing, double percentile) const;
+
+        //Returns the slowest recorded time, in milliseconds
+        double GetMax(FrameTiming timing) const;
+
+        //Writes the recorded frames, oldest first, to a csv file. Returns false if the file couldn't be written
+        bool Export(const std::string& path) const;
+
+        //Writes the percentiles and max of each timing to a csv file, a row per timing. Returns false if the file
+        //couldn't be written
+        bool ExportSummary(const std::string& path) const;
+
+    private:
+        //Returns the histogram bucket a time falls in
+        unsigned int GetBucket(float time) const;
+
+        //Member variables
+        float m_Frames[FRAME_TIMINGS_CAPACITY][FrameTiming_Count];
+        unsigned int m_Histogram[FrameTiming_Count][FRAME_TIMINGS_BUCKET_COUNT];
+
+        //For each timing, the frame numbers of the frames no later frame is slower than, oldest first, in a ring
+        //buffer. The oldest is the slowest recorded frame, so the max is kept as frames are added and overwritten
+        unsigned long long m_MaxFrames[FrameTiming_Count][FRAME_TIMINGS_CAPACITY];
+        unsigned int m_MaxStart[FrameTiming_Count];
+        unsigned int m_MaxCount[FrameTiming_Count];
+        unsigned long long m_FrameNumber;   //Number of frames recorded since the last Clear()
+        unsigned int m_Head;                //Index the next frame is written at
+        unsigned int m_Count;
+    };
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include "Profile.h"
+
+#if ENABLE_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace GameDev2D
+{
+    namespace
+    {
+        struct ProfileRecord
+        {
+            const char* name;
+            unsigned long long start;
+            unsigned long long end;
+        };
+
+        //Only the thread that owns the buffer writes to it, the count is published after
+        //the record is written so an exporting thread never reads a half written record
+        struct ThreadBuffer
+        {
+            ThreadBuffer(unsigned int aThreadId) :
+                records(new ProfileRecord[PROFILE_ZONES_PER_THREAD]),
+                count(0),
+                dropped(0),
+                threadId(aThreadId)
+            {
+            }
+
+            std::unique_ptr<ProfileRecord[]> records;
+            std::atomic<unsigned int> count;
+            std::atomic<unsigned long long> dropped;
+            unsigned int threadId;
+        };
+
+        //The buffers are only locked when a thread records its first zone, and when exporting. They
+        //outlive their threads so the zones of finished threads are still exported
+        std::mutex s_BuffersMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+        thread_local ThreadBuffer* t_Buffer = nullptr;
+
+        ThreadBuffer* GetThreadBuffer()
+        {
+            if (t_Buffer == nullptr)
+            {
+                std::lock_guard<std::mutex> lock(s_BuffersMutex);
+                s_Buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer(static_cast<unsigned int>(s_Buffers.size()) + 1)));
+                t_Buffer = s_Buffers.back().get();
+            }
+            return t_Buffer;
+        }
+
+        void WriteEscaped(std::ofstream& aFile, const char* aString)
+        {
+            for (const char* c = aString; *c != '\0'; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    aFile << '\\';
+                }
+                aFile << *c;
+            }
+        }
+    }
+
+    void Profile::Record(const char* aName, unsigned long long aStart, unsigned long long aEnd)
+    {
+        ThreadBuffer* buffer = GetThreadBuffer();
+
+        unsigned int index = buffer->count.load(std::memory_order_relaxed);
+        if (index == PROFILE_ZONES_PER_THREAD)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ProfileRecord& record = buffer->records[index];
+        record.name = aName;
+        record.start = aStart;
+        record.end = aEnd;
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    unsigned long long Profile::GetTime()
+    {
+        static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    bool Profile::Export(const std::string& aPath)
+    {
+        std::ofstream file(aPath.c_str());
+        if (file.is_open() == false)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(s_BuffersMutex);
+
+        //Complete ('X') events, the timestamps and durations are in microseconds. Nesting
+        //is worked out by the viewer from the zones' times on each thread
+        file << std::fixed << std::setprecision(3);
+        file << "{\"traceEvents\":[";
+        bool isFirst = true;
+        for (const std::unique_ptr<ThreadBuffer>& buffer : s_Buffers)
+        {
+            file << (isFirst == true ? "\n" : ",\n");
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"args\":{\"name\":\"Thread " << buffer->threadId << "\"}}";
+            isFirst = false;
+
+            unsigned int count = buffer->count.load(std::memory_order_acquire);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                const ProfileRecord& record = buffer->records[i];
+                file << ",\n{\"name\":\"";
+                WriteEscaped(file, record.name);
+                file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                     << ",\"ts\":" << static_cast<double>(record.start) / 1000.0
+                     << ",\"dur\":" << static_cast<double>(record.end - record.start) / 1000.0 << "}";
+            }
+        }
+        file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+        return file.good();
+    }
+
+    unsigned long long Profile::GetDroppedZoneCount()
+    {
+        std::lock_guard<std::mutex> lock(s_BuffersMutex);
+
+        unsigned long long dropped = 0;
+        for (const std::unique_ptr<ThreadBuffer>& buffer : s_Buffers)
+        {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+}
+
+#endif
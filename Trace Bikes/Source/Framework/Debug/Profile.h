@@ -0,0 +1,93 @@
+#ifndef __GameDev2D__Profile__
+#define __GameDev2D__Profile__
+
+//Set to 1 (here or in the project's preprocessor definitions) to record profile zones,
+//when set to 0 the PROFILE macros compile to nothing
+#ifndef ENABLE_PROFILE
+#define ENABLE_PROFILE 0
+#endif
+
+//The file the recorded zones are written to when the Application shuts down
+#ifndef PROFILE_TRACE_FILE
+#define PROFILE_TRACE_FILE "ProfileTrace.json"
+#endif
+
+//The number of zones each thread can record, zones past that are dropped
+#ifndef PROFILE_ZONES_PER_THREAD
+#define PROFILE_ZONES_PER_THREAD 262144
+#endif
+
+
+#if ENABLE_PROFILE
+
+#include <string>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+//Profiles the rest of the enclosing scope, the name has to be a string literal (or otherwise outlive the export)
+#define PROFILE_ZONE(name) GameDev2D::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+//Profiles the rest of the enclosing function, using the function's name
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+
+//Writes the zones recorded so far to a file, see Profile::Export()
+#define PROFILE_EXPORT(path) GameDev2D::Profile::Export(path)
+
+
+namespace GameDev2D
+{
+    //The Profile class records timed, nested zones on any thread. Each thread writes its zones to its own
+    //fixed-size buffer without locking, so recording a zone costs two clock reads and a few stores. The zones
+    //can then be exported in the Chrome trace event format, which chrome://tracing and ui.perfetto.dev can open
+    class Profile
+    {
+    public:
+        //Records a zone, the start and end times are in nanoseconds (see GetTime())
+        static void Record(const char* name, unsigned long long start, unsigned long long end);
+
+        //Returns a timestamp in nanoseconds
+        static unsigned long long GetTime();
+
+        //Writes the recorded zones of every thread as Chrome trace event JSON. Should be called while
+        //no zones are being recorded (or at least not ended) on other threads. Returns false if the
+        //file couldn't be written
+        static bool Export(const std::string& path);
+
+        //Returns the number of zones dropped because a thread's buffer was full
+        static unsigned long long GetDroppedZoneCount();
+    };
+
+    //A ProfileZone records the time between its construction and its destruction, use the PROFILE_ZONE macro
+    class ProfileZone
+    {
+    public:
+        ProfileZone(const char* name) :
+            m_Name(name),
+            m_Start(Profile::GetTime())
+        {
+        }
+
+        ~ProfileZone()
+        {
+            Profile::Record(m_Name, m_Start, Profile::GetTime());
+        }
+
+    private:
+        ProfileZone(const ProfileZone&);
+        ProfileZone& operator=(const ProfileZone&);
+
+        const char* m_Name;
+        unsigned long long m_Start;
+    };
+}
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_EXPORT(path)
+
+#endif
+
+#endif
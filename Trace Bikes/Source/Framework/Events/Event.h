@@ -4,6 +4,13 @@
 #include <string>
 
 
+//Set to 1 to log every dispatched event (verbosity permitting), when set to 0 the events' LogEvent()
+//method isn't called, so nothing is formatted on the dispatch path
+#ifndef LOG_DISPATCHED_EVENTS
+#define LOG_DISPATCHED_EVENTS 0
+#endif
+
+
 namespace GameDev2D
 {
     //Forward declaration
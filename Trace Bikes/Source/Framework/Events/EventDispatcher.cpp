@@ -1,11 +1,14 @@
 #include "EventDispatcher.h"
 #include "Event.h"
+#include <algorithm>
 #include <assert.h>
 
 
 namespace GameDev2D
 {
-	EventDispatcher::EventDispatcher() : EventHandler()
+	EventDispatcher::EventDispatcher() : EventHandler(),
+        m_DispatchDepth(0),
+        m_HasTombstones(false)
     {
     
 	}
@@ -17,56 +20,98 @@ namespace GameDev2D
     
     void EventDispatcher::RemoveAllHandlers()
     {
-		m_HandlerEntries.clear();
+        //A null handler removes every handler for the event code
+        for (unsigned int i = 0; i < m_HandlerLists.size(); i++)
+        {
+            RemoveEventListener(nullptr, i);
+        }
 	}
     
     void EventDispatcher::RemoveAllHandlersForListener(EventHandler* aHandler)
     {
-		std::vector<pair<EventHandler*, unsigned int>>::iterator iter = m_HandlerEntries.begin();
-		while (iter != m_HandlerEntries.end())
+        //Safety check the handler pointer, a null handler would remove every handler
+        if (aHandler != nullptr)
         {
-			if((*iter).first == aHandler)
-            {
-				iter = m_HandlerEntries.erase(iter);
-			}
-            else
+            for (unsigned int i = 0; i < m_HandlerLists.size(); i++)
             {
-				++iter;						
-			}
-		}
-		
+                RemoveEventListener(aHandler, i);
+            }
+        }
 	}
     
     void EventDispatcher::AddEventListener(EventHandler* aHandler, unsigned int aEventCode)
     {
         //If you hit this assert, the event handler pointer you passed in was null
         assert(aHandler != nullptr);
+
+        //Grow the table to hold the event code
+        if (aEventCode >= m_HandlerLists.size())
+        {
+            m_HandlerLists.resize(aEventCode + 1);
+        }
+
+        std::vector<EventHandler*>& handlers = m_HandlerLists.at(aEventCode).handlers;
         
         //Cycle through and check to make sure we haven't added the same handler for the event code already
         #if DEBUG
-        for(unsigned int i = 0; i < m_HandlerEntries.size(); i++)
-        {
-            bool exists = m_HandlerEntries.at(i).first == aHandler && m_HandlerEntries.at(i).second == aEventCode;
-            assert(exists == false);
-        }
+        bool exists = std::find(handlers.begin(), handlers.end(), aHandler) != handlers.end();
+        assert(exists == false);
         #endif
         
-        //Safety check the handler pointer, and add it to the handler entries
+        //Safety check the handler pointer, and add it to the handler list
         if(aHandler != nullptr)
         {
-            m_HandlerEntries.push_back(make_pair(aHandler, aEventCode));
+            handlers.push_back(aHandler);
         }
 	}
 
 	void EventDispatcher::RemoveEventListener(EventHandler* aHandler, unsigned int aEventCode)
     {
-		for(unsigned int i = 0; i < m_HandlerEntries.size(); i++)
+        if (aEventCode >= m_HandlerLists.size())
+        {
+            return;
+        }
+
+        HandlerList& list = m_HandlerLists.at(aEventCode);
+
+        //A null handler removes every handler for the event code
+        if (aHandler == nullptr)
+        {
+            if (m_DispatchDepth > 0)
+            {
+                for (unsigned int i = 0; i < list.handlers.size(); i++)
+                {
+                    if (list.handlers.at(i) != nullptr)
+                    {
+                        list.handlers.at(i) = nullptr;
+                        list.tombstones++;
+                    }
+                }
+                m_HasTombstones = m_HasTombstones || list.tombstones > 0;
+            }
+            else
+            {
+                list.handlers.clear();
+                list.tombstones = 0;
+            }
+            return;
+        }
+
+        std::vector<EventHandler*>::iterator iter = std::find(list.handlers.begin(), list.handlers.end(), aHandler);
+        if (iter != list.handlers.end())
         {
-			if(m_HandlerEntries.at(i).second == aEventCode && m_HandlerEntries.at(i).first == aHandler)
+            //Erasing would shift the handlers a dispatch is iterating over, leave a tombstone instead
+            if (m_DispatchDepth > 0)
+            {
+                *iter = nullptr;
+                list.tombstones++;
+                m_HasTombstones = true;
+            }
+            else
             {
-				m_HandlerEntries.erase(m_HandlerEntries.begin()+i);
-			}
-		}
+                list.handlers.erase(iter);
+            }
+        }
 	}
 	
     void EventDispatcher::DispatchEvent(Event& aEvent)
@@ -75,16 +120,53 @@ namespace GameDev2D
         aEvent.SetDispatcher(this);
 
         //Log the event that is about to be dispatched
+#if LOG_DISPATCHED_EVENTS
         aEvent.LogEvent();
+#endif
+
+        unsigned int eventCode = aEvent.GetEventCode();
+        if (eventCode >= m_HandlerLists.size())
+        {
+            return;
+        }
+
+        m_DispatchDepth++;
 
-        //Cycle through the event entries and handle the event's that match the event code
-        for (unsigned int i = 0; i < m_HandlerEntries.size(); i++)
+        //Cycle through the handlers listening for the event code, handlers added by a handler
+        //are after the count and won't receive this event. The list can be reallocated by
+        //a handler, so it has to be indexed through the table every time
+        unsigned int count = static_cast<unsigned int>(m_HandlerLists.at(eventCode).handlers.size());
+        for (unsigned int i = 0; i < count; i++)
         {
-            if (m_HandlerEntries.at(i).second == aEvent.GetEventCode())
+            EventHandler* handler = m_HandlerLists.at(eventCode).handlers.at(i);
+            if (handler != nullptr)
             {
                 //Lastly call the event handler to handle the event
-                m_HandlerEntries.at(i).first->HandleEvent(&aEvent);
+                handler->HandleEvent(&aEvent);
             }
         }
+
+        m_DispatchDepth--;
+
+        //Erase the handlers that were removed during the dispatch
+        if (m_DispatchDepth == 0 && m_HasTombstones == true)
+        {
+            CompactHandlers();
+        }
+    }
+
+    void EventDispatcher::CompactHandlers()
+    {
+        for (unsigned int i = 0; i < m_HandlerLists.size(); i++)
+        {
+            HandlerList& list = m_HandlerLists.at(i);
+            if (list.tombstones > 0)
+            {
+                list.handlers.erase(std::remove(list.handlers.begin(), list.handlers.end(), nullptr), list.handlers.end());
+                list.tombstones = 0;
+            }
+        }
+
+        m_HasTombstones = false;
     }
-}
\ No newline at end of file
+}
@@ -21,13 +21,16 @@ namespace GameDev2D
 		
         //Dispatches an Event, by default the event will be deleted after it is dispatch, however if you
         //pass in false as the 2nd argument then the event won't be deleted. This method can be overridden.
+        //Only the handlers listening for the event's code are visited. Handlers added while the event is 
+        //being dispatched won't receive it, handlers removed while it is being dispatched won't receive it either.
         virtual void DispatchEvent(Event& event);
         
         //Add an event handler for a specific event code, an event will be dispatched to the handler
         //when the event is triggered.
         void AddEventListener(EventHandler* handler, unsigned int eventCode);
         
-        //Removes a specific event code for a handler from the dispatcher.
+        //Removes a specific event code for a handler from the dispatcher, a null handler removes every handler 
+        //for the event code. It is safe to call while dispatching.
         void RemoveEventListener(EventHandler* handler, unsigned int eventCode);
 			
         //Removes handler and all event codes associated with it  from the dispatcher.
@@ -37,8 +40,23 @@ namespace GameDev2D
         void RemoveAllHandlers();
         
     protected:
-        //Member variable
-		std::vector<std::pair<EventHandler*, unsigned int>> m_HandlerEntries;
+        //Removes the tombstones left by handlers removed while an event was being dispatched
+        void CompactHandlers();
+
+        //The handlers listening for a single event code, in the order they were added. Handlers 
+        //removed during a dispatch are set to null and only erased once the dispatch is done
+        struct HandlerList
+        {
+            HandlerList() : tombstones(0) {}
+
+            std::vector<EventHandler*> handlers;
+            unsigned int tombstones;
+        };
+
+        //Member variables
+        std::vector<HandlerList> m_HandlerLists;    //Indexed by event code, event codes are expected to be small constants
+        unsigned int m_DispatchDepth;               //Greater than zero while dispatching, events can dispatch other events
+        bool m_HasTombstones;
 	};
 }
 
@@ -0,0 +1,153 @@
+#include "EventQueue.h"
+#include "EventDispatcher.h"
+#include "KeyDownEvent.h"
+#include "KeyRepeatEvent.h"
+#include "KeyUpEvent.h"
+#include "MouseButtonDownEvent.h"
+#include "MouseButtonUpEvent.h"
+#include "MouseMovementEvent.h"
+#include "MouseScrollWheelEvent.h"
+#include "UpdateEvent.h"
+#include "../Debug/Log.h"
+#include "../Debug/Profile.h"
+#include "../Windows/GameLoop.h"
+
+
+namespace GameDev2D
+{
+    EventQueue::EventQueue() :
+        m_Head(0),
+        m_Count(0),
+        m_DroppedCount(0),
+        m_LastDispatchCount(0),
+        m_LastDispatchTime(0.0)
+    {
+    }
+
+    bool EventQueue::Push(const EventRecord& aRecord)
+    {
+        //Only the latest position matters to the listeners, merge the movement into the last queued one
+        if (aRecord.eventCode == MOUSE_MOVEMENT_EVENT && m_Count > 0)
+        {
+            EventRecord& last = m_Records[(m_Head + m_Count - 1) % EVENT_QUEUE_CAPACITY];
+            if (last.eventCode == MOUSE_MOVEMENT_EVENT && last.dispatcher == aRecord.dispatcher)
+            {
+                last.data.mouseMovement.x = aRecord.data.mouseMovement.x;
+                last.data.mouseMovement.y = aRecord.data.mouseMovement.y;
+                last.data.mouseMovement.deltaX += aRecord.data.mouseMovement.deltaX;
+                last.data.mouseMovement.deltaY += aRecord.data.mouseMovement.deltaY;
+                return true;
+            }
+        }
+
+        if (m_Count == EVENT_QUEUE_CAPACITY)
+        {
+            m_DroppedCount++;
+            Log::Error(this, "EventQueue", false, Log::Verbosity_Debug, "The event queue is full, dropped a %s event", Event::EventCodeToString(aRecord.eventCode).c_str());
+            return false;
+        }
+
+        m_Records[(m_Head + m_Count) % EVENT_QUEUE_CAPACITY] = aRecord;
+        m_Count++;
+        return true;
+    }
+
+    void EventQueue::Dispatch()
+    {
+        PROFILE_ZONE("EventQueue::Dispatch");
+
+        double start = GameLoop::GetTime();
+        unsigned int count = 0;
+
+        //The record is copied out before it is dispatched, since the listeners can queue more events
+        while (m_Count > 0)
+        {
+            EventRecord record = m_Records[m_Head];
+            m_Head = (m_Head + 1) % EVENT_QUEUE_CAPACITY;
+            m_Count--;
+
+            Dispatch(record);
+            count++;
+        }
+
+        m_LastDispatchCount = count;
+        m_LastDispatchTime = (GameLoop::GetTime() - start) * 1000.0;
+    }
+
+    unsigned int EventQueue::GetCount() const
+    {
+        return m_Count;
+    }
+
+    unsigned int EventQueue::GetDroppedCount() const
+    {
+        return m_DroppedCount;
+    }
+
+    unsigned int EventQueue::GetLastDispatchCount() const
+    {
+        return m_LastDispatchCount;
+    }
+
+    double EventQueue::GetLastDispatchTime() const
+    {
+        return m_LastDispatchTime;
+    }
+
+    void EventQueue::Dispatch(const EventRecord& aRecord)
+    {
+        //Safety check the dispatcher pointer
+        if (aRecord.dispatcher == nullptr)
+        {
+            return;
+        }
+
+        switch (aRecord.eventCode)
+        {
+        case UPDATE_EVENT:
+            aRecord.dispatcher->DispatchEvent(UpdateEvent(aRecord.data.delta));
+            break;
+
+        case KEY_DOWN_EVENT:
+            aRecord.dispatcher->DispatchEvent(KeyDownEvent(static_cast<Keyboard::Key>(aRecord.data.key.key)));
+            break;
+
+        case KEY_UP_EVENT:
+            aRecord.dispatcher->DispatchEvent(KeyUpEvent(static_cast<Keyboard::Key>(aRecord.data.key.key), aRecord.data.key.duration));
+            break;
+
+        case KEY_REPEAT_EVENT:
+            aRecord.dispatcher->DispatchEvent(KeyRepeatEvent(static_cast<Keyboard::Key>(aRecord.data.key.key), aRecord.data.key.duration));
+            break;
+
+        case MOUSE_MOVEMENT_EVENT:
+        {
+            const EventRecord::MouseMovementData& movement = aRecord.data.mouseMovement;
+            aRecord.dispatcher->DispatchEvent(MouseMovementEvent(Vector2(movement.x, movement.y), Vector2(movement.previousX, movement.previousY), Vector2(movement.deltaX, movement.deltaY)));
+            break;
+        }
+
+        case MOUSE_BUTTON_DOWN_EVENT:
+        {
+            const EventRecord::MouseButtonData& button = aRecord.data.mouseButton;
+            aRecord.dispatcher->DispatchEvent(MouseButtonDownEvent(static_cast<Mouse::Button>(button.button), Vector2(button.x, button.y)));
+            break;
+        }
+
+        case MOUSE_BUTTON_UP_EVENT:
+        {
+            const EventRecord::MouseButtonData& button = aRecord.data.mouseButton;
+            aRecord.dispatcher->DispatchEvent(MouseButtonUpEvent(static_cast<Mouse::Button>(button.button), button.duration, Vector2(button.x, button.y)));
+            break;
+        }
+
+        case MOUSE_WHEEL_EVENT:
+            aRecord.dispatcher->DispatchEvent(MouseScrollWheelEvent(aRecord.data.wheelDelta));
+            break;
+
+        default:
+            aRecord.dispatcher->DispatchEvent(Event(aRecord.eventCode));
+            break;
+        }
+    }
+}
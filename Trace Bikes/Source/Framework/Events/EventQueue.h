@@ -0,0 +1,94 @@
+#ifndef __GameDev2D__EventQueue__
+#define __GameDev2D__EventQueue__
+
+#include "Event.h"
+
+
+namespace GameDev2D
+{
+    //Forward declaration
+    class EventDispatcher;
+
+    //Constants
+    const unsigned int EVENT_QUEUE_CAPACITY = 256;
+
+    //A plain data record of an event waiting in the EventQueue, only the data member matching the event code is set
+    struct EventRecord
+    {
+        struct KeyData
+        {
+            int key;
+            double duration;
+        };
+
+        struct MouseButtonData
+        {
+            int button;
+            double duration;
+            float x;
+            float y;
+        };
+
+        struct MouseMovementData
+        {
+            float x;
+            float y;
+            float previousX;
+            float previousY;
+            float deltaX;
+            float deltaY;
+        };
+
+        EventDispatcher* dispatcher;    //The dispatcher the event is dispatched from
+        unsigned int eventCode;
+        union
+        {
+            double delta;                           //UPDATE_EVENT
+            KeyData key;                            //KEY_DOWN_EVENT, KEY_UP_EVENT and KEY_REPEAT_EVENT
+            MouseButtonData mouseButton;            //MOUSE_BUTTON_DOWN_EVENT and MOUSE_BUTTON_UP_EVENT
+            MouseMovementData mouseMovement;        //MOUSE_MOVEMENT_EVENT
+            float wheelDelta;                       //MOUSE_WHEEL_EVENT
+        } data;
+    };
+
+    //The EventQueue holds events in a fixed-size ring buffer until they are dispatched together with Dispatch(),
+    //the Application dispatches its queue at the start of every update. Queueing an event only copies a plain
+    //record, the Event object handed to the listeners is built on the stack when it is dispatched
+    class EventQueue
+    {
+    public:
+        EventQueue();
+
+        //Queues an event, consecutive mouse movements from the same dispatcher are merged into one. Returns
+        //false if the queue is full, the event is then dropped
+        bool Push(const EventRecord& record);
+
+        //Dispatches the queued events in the order they were queued, events queued by the listeners are
+        //dispatched as well
+        void Dispatch();
+
+        //Returns the number of events waiting to be dispatched
+        unsigned int GetCount() const;
+
+        //Returns the number of events dropped because the queue was full
+        unsigned int GetDroppedCount() const;
+
+        //Returns how many events the last Dispatch() call dispatched and how long it took, in milliseconds
+        unsigned int GetLastDispatchCount() const;
+        double GetLastDispatchTime() const;
+
+    private:
+        //Builds the event matching the record's event code and dispatches it
+        void Dispatch(const EventRecord& record);
+
+        //Member variables
+        EventRecord m_Records[EVENT_QUEUE_CAPACITY];
+        unsigned int m_Head;    //Index of the oldest record
+        unsigned int m_Count;
+        unsigned int m_DroppedCount;
+        unsigned int m_LastDispatchCount;
+        double m_LastDispatchTime;
+    };
+}
+
+#endif
@@ -9,6 +9,11 @@ namespace GameDev2D
     {
     }
 
+    void UpdateEvent::SetDelta(double aDelta)
+    {
+        m_Delta = aDelta;
+    }
+
     double UpdateEvent::GetDelta()
     {
         return m_Delta;
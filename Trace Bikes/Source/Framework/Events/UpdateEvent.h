@@ -13,7 +13,8 @@ namespace GameDev2D
     public:
         UpdateEvent(double delta);
 
-        //Returns the delta time
+        //Sets and returns the delta time, lets the same UpdateEvent be dispatched every frame
+        void SetDelta(double delta);
         double GetDelta();
 
     protected:
@@ -33,6 +33,21 @@ namespace GameDev2D
         return Services::GetApplication()->GetWindow()->GetHeight();
     }
 
+    float GetInterpolationAlpha()
+    {
+        return static_cast<float>(Services::GetApplication()->GetGameLoop()->GetInterpolationAlpha());
+    }
+
+    double GetUpdateTime()
+    {
+        return Services::GetApplication()->GetGameLoop()->GetUpdateTime();
+    }
+
+    double GetKeyPressTime()
+    {
+        return Services::GetInputManager()->GetKeyPressTime();
+    }
+
     void LoadTexture(const std::string& aFilename)
     {
         Services::GetResourceManager()->LoadTexture(aFilename);
@@ -115,6 +130,11 @@ namespace GameDev2D
 		Services::GetInputManager()->RegisterKeyPressedCallback(aKeyPressedCallback);
 	}
 
+	void RegisterKeyDownCallback(std::function<void(Keyboard::Key)> aKeyDownCallback)
+	{
+		Services::GetInputManager()->RegisterKeyDownCallback(aKeyDownCallback);
+	}
+
 	void RegisterLeftMouseClickCallback(std::function<void(float, float)> aLeftMouseClickCallback)
 	{
 		Services::GetInputManager()->RegisterLeftMouseClickCallback(aLeftMouseClickCallback);
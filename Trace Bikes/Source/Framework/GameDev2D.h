@@ -11,6 +11,7 @@
 #include "Events/Event.h"
 #include "Events/EventDispatcher.h"
 #include "Events/EventHandler.h"
+#include "Events/EventQueue.h"
 #include "Events/FullscreenEvent.h"
 #include "Events/GamePadButtonDownEvent.h"
 #include "Events/GamePadButtonUpEvent.h"
@@ -66,6 +67,11 @@
 //Application constants
 #define TARGET_FPS 60
 #define LIMIT_FPS true
+#define FIXED_UPDATE_RATE 240
+#define MAX_UPDATES_PER_FRAME 8
+#define FRAME_PACING FramePacing_Hybrid
+#define FRAME_PACING_SPIN_TIME 0.5
+#define INPUT_THREAD true
 #define WINDOW_TITLE "GameDev2D"
 #define WINDOW_WIDTH 1024
 #define WINDOW_HEIGHT 768
@@ -73,11 +79,18 @@
 #define BACKGROUND_CLEAR_COLOR Color::BlackColor()
 #define DEBUG_DRAW_FPS 1
 #define DEBUG_DRAW_DELTA_TIME 0
+#define DEBUG_DRAW_FRAME_JITTER 0
+#define DEBUG_DRAW_FRAME_PERCENTILES 0
+#define DEBUG_DRAW_EVENT_DISPATCH_TIME 0
 #define DEBUG_DRAW_ELAPSED_TIME 0
 #define DEBUG_DRAW_ALLOCATED_TEXTURE_MEMORY 0
+#define DEBUG_DRAW_GL_OBJECT_COUNT 0
 #define DEBUG_DRAW_SPRITE_RECT 0
 #define THROW_EXCEPTION_ON_ERROR 1
 #define LOG_TO_FILE 0
+#define EXPORT_FRAME_TIMINGS 0
+#define FRAME_TIMINGS_CSV "FrameTimings.csv"
+#define FRAME_TIMINGS_SUMMARY_CSV "FrameTimingsSummary.csv"
 
 
 namespace GameDev2D
@@ -92,7 +105,9 @@ namespace GameDev2D
     //   resources all properly deleted/unloaded.
     //   
     // 3. The third function, is an update function, that has a return type of void and take one parameter of type double,
-    //   the update function is called once a frame, you should perform ALL game logic in the update function
+    //   the update function is called FIXED_UPDATE_RATE times a second with a constant delta (zero or more times per
+    //   frame), or once a frame with the frame's delta if FIXED_UPDATE_RATE is 0. You should perform ALL game logic in 
+    //   the update function
     //
     // 4. The fourth function, is an draw function, that has a return type of void and takes zero parameters, the draw 
     //   function is called once a frame, you should perform ALL rendering and ONLY rendering in the draw function.
@@ -108,6 +123,20 @@ namespace GameDev2D
     unsigned int GetScreenHeight();
 
 
+    // Returns how far between the last and the next fixed update the current frame is being drawn (0 to 1),
+    // use it in the draw function to interpolate between the previous and current positions of moving objects
+    float GetInterpolationAlpha();
+
+    // Returns the time, in seconds, the current update simulates up to. With a fixed update rate several updates can
+    // run back to back in a frame, each one of them is for a different point in time
+    double GetUpdateTime();
+
+    // Returns the time, in seconds, the key being handled by the key down or key pressed callback went down, even
+    // when the key pressed callback is only called once it is released. Compare it to GetUpdateTime() to know how
+    // far into the update, or before it, the key was pressed
+    double GetKeyPressTime();
+
+
     // Loads a Texture from a file. All Texture files MUST be of type png. If a Texture file doesn't exist a default 'checkboard'
     // Texture will be loaded in its place.
     void LoadTexture(const std::string& filename);
@@ -170,6 +199,9 @@ namespace GameDev2D
 	// Registers a callback function to be called whenever the key is pressed (down then up)
 	void RegisterKeyPressedCallback(std::function<void(Keyboard::Key)> keyPressedCallback);
 
+	// Registers a callback function to be called as soon as a key goes down, without waiting for it to be released
+	void RegisterKeyDownCallback(std::function<void(Keyboard::Key)> keyDownCallback);
+
 
 	// Registers a callback function to be called whenever the left mouse button is clicked
 	void RegisterLeftMouseClickCallback(std::function<void(float, float)> leftMouseClickCallback);
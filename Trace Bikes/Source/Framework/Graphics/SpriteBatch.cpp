@@ -2,6 +2,7 @@
 #include "Shader.h"
 #include "Sprite.h"
 #include "Texture.h"
+#include "../Debug/Profile.h"
 #include "../Math/Math.h"
 #include "../Services/Services.h"
 #include <assert.h>
@@ -187,6 +188,8 @@ namespace GameDev2D
 
     void SpriteBatch::Flush()
     {
+        PROFILE_ZONE("SpriteBatch::Flush");
+
         //We can't draw anything if there isn't any vertices OR a texture set
         if (m_VertexData->GetVertexBuffer()->GetCount() == 0 || m_CurrentTexture == nullptr)
         {
@@ -0,0 +1,73 @@
+#include "InputQueue.h"
+
+
+namespace GameDev2D
+{
+    static_assert((INPUT_QUEUE_CAPACITY & (INPUT_QUEUE_CAPACITY - 1)) == 0, "INPUT_QUEUE_CAPACITY has to be a power of two");
+
+    InputQueue::InputQueue() :
+        m_PushPosition(0),
+        m_PopPosition(0)
+    {
+        //A slot is free to be written at position n when its sequence is n
+        for (unsigned int i = 0; i < INPUT_QUEUE_CAPACITY; i++)
+        {
+            m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool InputQueue::Push(const InputEvent& aInputEvent)
+    {
+        unsigned int position = m_PushPosition.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+
+        while (true)
+        {
+            slot = &m_Slots[position & (INPUT_QUEUE_CAPACITY - 1)];
+            unsigned int sequence = slot->sequence.load(std::memory_order_acquire);
+            int difference = static_cast<int>(sequence - position);
+
+            //The slot is free, try to claim the position before another producer does
+            if (difference == 0)
+            {
+                if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) == true)
+                {
+                    break;
+                }
+            }
+            //The slot still holds an event the consumer hasn't read, the queue is full
+            else if (difference < 0)
+            {
+                return false;
+            }
+            //Another producer claimed the position, try the next one
+            else
+            {
+                position = m_PushPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        //Write the event, then publish it to the consumer
+        slot->inputEvent = aInputEvent;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool InputQueue::Pop(InputEvent& aInputEvent)
+    {
+        Slot* slot = &m_Slots[m_PopPosition & (INPUT_QUEUE_CAPACITY - 1)];
+        unsigned int sequence = slot->sequence.load(std::memory_order_acquire);
+
+        //The slot hasn't been published yet, the queue is empty
+        if (static_cast<int>(sequence - (m_PopPosition + 1)) < 0)
+        {
+            return false;
+        }
+
+        //Read the event, then free the slot for the producers' next lap around the queue
+        aInputEvent = slot->inputEvent;
+        slot->sequence.store(m_PopPosition + INPUT_QUEUE_CAPACITY, std::memory_order_release);
+        m_PopPosition++;
+        return true;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __GameDev2D__InputQueue__
+#define __GameDev2D__InputQueue__
+
+#include <atomic>
+
+
+namespace GameDev2D
+{
+    //Constants
+    const unsigned int INPUT_QUEUE_CAPACITY = 1024;    //Has to be a power of two
+    const unsigned int INPUT_QUEUE_CACHE_LINE = 64;
+
+    //A key event waiting in the InputQueue
+    struct InputEvent
+    {
+        enum Type
+        {
+            KeyDown = 0,
+            KeyUp
+        };
+
+        double timestamp;   //When the key changed, in GameLoop::GetTime() seconds
+        unsigned int key;
+        Type type;
+    };
+
+    //A bounded, lock-free, multiple producer single consumer queue of InputEvents. Any number of threads can
+    //Push() events at the same time (the window procedure, an input thread, a scripted test producer) while a
+    //single thread, the one updating the game, Pop()s them. Every slot has a sequence number that tells producers
+    //when it is free to write and the consumer when it has been written, so neither side ever waits on a lock.
+    class InputQueue
+    {
+    public:
+        InputQueue();
+
+        //Adds an event to the queue, can be called from any thread. Returns false if the queue is full
+        bool Push(const InputEvent& inputEvent);
+
+        //Removes the oldest event from the queue, must only be called from the consuming thread.
+        //Returns false if the queue is empty
+        bool Pop(InputEvent& inputEvent);
+
+    private:
+        struct Slot
+        {
+            std::atomic<unsigned int> sequence;
+            InputEvent inputEvent;
+        };
+
+        //Member variables, the producers' and the consumer's positions are padded onto separate cache lines
+        Slot m_Slots[INPUT_QUEUE_CAPACITY];
+        std::atomic<unsigned int> m_PushPosition;
+        char m_Padding[INPUT_QUEUE_CACHE_LINE];
+        unsigned int m_PopPosition;
+    };
+}
+
+#endif
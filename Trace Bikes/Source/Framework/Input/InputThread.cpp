@@ -0,0 +1,152 @@
+#include "InputThread.h"
+#include "InputQueue.h"
+#include "../Windows/GameLoop.h"
+
+
+namespace GameDev2D
+{
+    InputThread::InputThread(InputQueue* aInputQueue, HWND aGameWindow) :
+        m_InputQueue(aInputQueue),
+        m_GameWindow(aGameWindow),
+        m_WindowHandle(nullptr),
+        m_IsRunning(false),
+        m_IsReady(false)
+    {
+        //Start the thread and wait until it knows if it can receive raw input
+        m_Thread = std::thread(&InputThread::Run, this);
+        while (m_IsReady.load() == false)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    InputThread::~InputThread()
+    {
+        if (m_Thread.joinable() == true)
+        {
+            //End the thread's message loop, if it is still running
+            PostThreadMessage(GetThreadId(m_Thread.native_handle()), WM_QUIT, 0, 0);
+            m_Thread.join();
+        }
+    }
+
+    bool InputThread::IsRunning() const
+    {
+        return m_IsRunning.load();
+    }
+
+    void InputThread::Run()
+    {
+        //Key presses should be timestamped as soon as they arrive, even if the game is busy
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+        //Register the window class for the message-only window
+        HINSTANCE currentInstance = GetModuleHandle(NULL);
+        WNDCLASSEX windowClassExtended = {};
+        windowClassExtended.cbSize = sizeof(WNDCLASSEX);
+        windowClassExtended.lpfnWndProc = &InputThread::EventHandler;
+        windowClassExtended.hInstance = currentInstance;
+        windowClassExtended.lpszClassName = L"GameDev2DInput";
+        RegisterClassEx(&windowClassExtended);
+
+        //Create the message-only window, it's never shown
+        m_WindowHandle = CreateWindowEx(0, L"GameDev2DInput", L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, currentInstance, NULL);
+        if (m_WindowHandle != nullptr)
+        {
+            SetWindowLongPtr(m_WindowHandle, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+            //Register for keyboard input, RIDEV_INPUTSINK delivers it to the window even though it never has focus
+            RAWINPUTDEVICE device;
+            device.usUsagePage = 0x01;  //Generic desktop controls
+            device.usUsage = 0x06;      //Keyboard
+            device.dwFlags = RIDEV_INPUTSINK;
+            device.hwndTarget = m_WindowHandle;
+            m_IsRunning = RegisterRawInputDevices(&device, 1, sizeof(RAWINPUTDEVICE)) == TRUE;
+        }
+
+        //Let the constructor know if we're running
+        m_IsReady = true;
+
+        //Run the message loop, until the destructor posts a quit message
+        if (m_IsRunning.load() == true)
+        {
+            MSG message;
+            while (GetMessage(&message, NULL, 0, 0) > 0)
+            {
+                TranslateMessage(&message);
+                DispatchMessage(&message);
+            }
+
+            //Unregister the keyboard
+            RAWINPUTDEVICE device;
+            device.usUsagePage = 0x01;
+            device.usUsage = 0x06;
+            device.dwFlags = RIDEV_REMOVE;
+            device.hwndTarget = NULL;
+            RegisterRawInputDevices(&device, 1, sizeof(RAWINPUTDEVICE));
+        }
+
+        if (m_WindowHandle != nullptr)
+        {
+            DestroyWindow(m_WindowHandle);
+            m_WindowHandle = nullptr;
+        }
+
+        m_IsRunning = false;
+    }
+
+    void InputThread::HandleRawInput(HRAWINPUT aRawInput)
+    {
+        //Get the timestamp first thing
+        double timestamp = GameLoop::GetTime();
+
+        RAWINPUT rawInput;
+        UINT size = sizeof(RAWINPUT);
+        if (GetRawInputData(aRawInput, RID_INPUT, &rawInput, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1))
+        {
+            return;
+        }
+
+        //Only keyboard input, while the game window is in the foreground. 0xFF is sent as part of escaped key sequences
+        const RAWKEYBOARD& keyboard = rawInput.data.keyboard;
+        if (rawInput.header.dwType != RIM_TYPEKEYBOARD || GetForegroundWindow() != m_GameWindow || keyboard.VKey == 0xFF)
+        {
+            return;
+        }
+
+        //Map the key the same way GameWindow::MapKey() does
+        unsigned int key = keyboard.VKey;
+        switch (key)
+        {
+        case VK_CONTROL:
+            key = (keyboard.Flags & RI_KEY_E0) != 0 ? VK_RCONTROL : VK_LCONTROL;
+            break;
+
+        case VK_SHIFT:
+            key = MapVirtualKey(keyboard.MakeCode, MAPVK_VSC_TO_VK_EX);
+            break;
+        }
+
+        //Queue the key event, if the queue is full the game has stopped draining it and there's no one to tell
+        InputEvent inputEvent;
+        inputEvent.timestamp = timestamp;
+        inputEvent.key = key;
+        inputEvent.type = (keyboard.Flags & RI_KEY_BREAK) != 0 ? InputEvent::KeyUp : InputEvent::KeyDown;
+        m_InputQueue->Push(inputEvent);
+    }
+
+    LRESULT CALLBACK InputThread::EventHandler(HWND aHandle, UINT aMessage, WPARAM aWParam, LPARAM aLParam)
+    {
+        if (aMessage == WM_INPUT)
+        {
+            InputThread* inputThread = reinterpret_cast<InputThread*>(GetWindowLongPtr(aHandle, GWLP_USERDATA));
+            if (inputThread != nullptr)
+            {
+                inputThread->HandleRawInput(reinterpret_cast<HRAWINPUT>(aLParam));
+            }
+        }
+
+        //WM_INPUT has to reach DefWindowProc as well, so the system can clean up after it
+        return DefWindowProc(aHandle, aMessage, aWParam, aLParam);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef __GameDev2D__InputThread__
+#define __GameDev2D__InputThread__
+
+#include <atomic>
+#include <thread>
+#include <Windows.h>
+
+
+namespace GameDev2D
+{
+    //Forward declaration
+    class InputQueue;
+
+    //The InputThread reads the keyboard through Raw Input on its own thread, so key presses are timestamped
+    //and queued the moment they happen, instead of when the game window's message pump gets to them between
+    //frames. Only the keys pressed while the game window is in the foreground are queued.
+    class InputThread
+    {
+    public:
+        InputThread(InputQueue* inputQueue, HWND gameWindow);
+        ~InputThread();
+
+        //Returns wether the thread is running and receiving raw keyboard input
+        bool IsRunning() const;
+
+    private:
+        //The thread's entry point, runs the message loop of a message-only window registered for raw input
+        void Run();
+
+        //Handles a WM_INPUT message
+        void HandleRawInput(HRAWINPUT rawInput);
+
+        //Windows event handler static method
+        static LRESULT CALLBACK EventHandler(HWND handle, UINT message, WPARAM wParam, LPARAM lParam);
+
+        //Member variables
+        InputQueue* m_InputQueue;
+        HWND m_GameWindow;
+        HWND m_WindowHandle;
+        std::thread m_Thread;
+        std::atomic<bool> m_IsRunning;
+        std::atomic<bool> m_IsReady;
+    };
+}
+
+#endif
@@ -1,7 +1,6 @@
 #include "Keyboard.h"
-#include "../Events/KeyUpEvent.h"
-#include "../Events/KeyDownEvent.h"
-#include "../Events/KeyRepeatEvent.h"
+#include "../Events/EventQueue.h"
+#include "../Services/Services.h"
 
 namespace GameDev2D
 {
@@ -35,23 +34,23 @@ namespace GameDev2D
             //We now have a Repeat KeyState
             m_KeyStates[aKey].keyState = KeyRepeat;
 
-            //Dispatch the event for anyone else listening
-            DispatchEvent(KeyRepeatEvent(aKey, m_KeyStates[aKey].duration = 0.0));
+            //Queue the event for anyone else listening
+            QueueKeyEvent(KEY_REPEAT_EVENT, aKey, m_KeyStates[aKey].duration = 0.0);
         }
         else
         {
             //Other wise, set the key state to Down
             m_KeyStates[aKey].keyState = KeyDown;
 
-            //And dispatch and KeyDown event
-            DispatchEvent(KeyDownEvent(aKey));
+            //And queue a KeyDown event
+            QueueKeyEvent(KEY_DOWN_EVENT, aKey, 0.0);
         }
     }
 
     void Keyboard::HandleKeyUp(Key aKey)
     {
-        //Dispatch a KeyUp event
-        DispatchEvent(KeyUpEvent(aKey, m_KeyStates[aKey].duration));
+        //Queue a KeyUp event
+        QueueKeyEvent(KEY_UP_EVENT, aKey, m_KeyStates[aKey].duration);
 
         //And set that the key is no longer pressed
         m_KeyStates[aKey].keyState = KeyUp;
@@ -60,6 +59,21 @@ namespace GameDev2D
         m_KeyStates[aKey].duration = 0.0;
     }
 
+    void Keyboard::QueueKeyEvent(unsigned int aEventCode, Key aKey, double aDuration)
+    {
+        EventRecord record;
+        record.dispatcher = this;
+        record.eventCode = aEventCode;
+        record.data.key.key = aKey;
+        record.data.key.duration = aDuration;
+
+        //There's no one to dispatch to without an Application
+        if (Services::GetApplication() != nullptr)
+        {
+            Services::GetApplication()->QueueEvent(record);
+        }
+    }
+
     Keyboard::State Keyboard::GetState(Key aKey)
     {
         return m_KeyStates[aKey];
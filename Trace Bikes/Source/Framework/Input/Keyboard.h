@@ -174,6 +174,9 @@ namespace GameDev2D
         //Handle key up events, and dispatches the appropriate event (up)
         void HandleKeyUp(Key key);
 
+        //Queues a key event, they're dispatched at the start of the next update
+        void QueueKeyEvent(unsigned int eventCode, Key key, double duration);
+
         //Member variable
         std::map<Key, State> m_KeyStates;
     };
@@ -1,8 +1,6 @@
 #include "Mouse.h"
-#include "../Events/MouseButtonDownEvent.h"
-#include "../Events/MouseButtonUpEvent.h"
-#include "../Events/MouseMovementEvent.h"
-#include "../Events/MouseScrollWheelEvent.h"
+#include "../Events/EventQueue.h"
+#include "../Services/Services.h"
 
 
 namespace GameDev2D
@@ -54,8 +52,17 @@ namespace GameDev2D
         //Set the new position
         m_Position = aPosition;
 
-        //Dispatch the mouse event
-        DispatchEvent(MouseMovementEvent(m_Position, m_PreviousPosition, aDelta));
+        //Queue the mouse event
+        EventRecord record;
+        record.dispatcher = this;
+        record.eventCode = MOUSE_MOVEMENT_EVENT;
+        record.data.mouseMovement.x = m_Position.x;
+        record.data.mouseMovement.y = m_Position.y;
+        record.data.mouseMovement.previousX = m_PreviousPosition.x;
+        record.data.mouseMovement.previousY = m_PreviousPosition.y;
+        record.data.mouseMovement.deltaX = aDelta.x;
+        record.data.mouseMovement.deltaY = aDelta.y;
+        Services::GetApplication()->QueueEvent(record);
     }
     
     void Mouse::HandleButtonDown(Button aButton)
@@ -63,8 +70,8 @@ namespace GameDev2D
         //Set the button state's isPressed flag
         m_ButtonStates[aButton].isPressed = true;
 
-        //Dispatch the Mouse event
-        DispatchEvent(MouseButtonDownEvent(aButton, GetPosition()));
+        //Queue the Mouse event
+        QueueButtonEvent(MOUSE_BUTTON_DOWN_EVENT, aButton, 0.0);
     }
     
     void Mouse::HandleButtonUp(Button aButton)
@@ -72,8 +79,8 @@ namespace GameDev2D
         //Set the button state's isPressed flag
         m_ButtonStates[aButton].isPressed = false;
 
-        //Dispatch the Mouse event
-        DispatchEvent(MouseButtonUpEvent(aButton, m_ButtonStates[aButton].duration, GetPosition()));
+        //Queue the Mouse event
+        QueueButtonEvent(MOUSE_BUTTON_UP_EVENT, aButton, m_ButtonStates[aButton].duration);
 
         //Reset the duration value
         m_ButtonStates[aButton].duration = 0.0;
@@ -81,7 +88,23 @@ namespace GameDev2D
 
     void Mouse::HandleScroll(float aDelta)
     {
-        DispatchEvent(MouseScrollWheelEvent(aDelta));
+        EventRecord record;
+        record.dispatcher = this;
+        record.eventCode = MOUSE_WHEEL_EVENT;
+        record.data.wheelDelta = aDelta;
+        Services::GetApplication()->QueueEvent(record);
+    }
+
+    void Mouse::QueueButtonEvent(unsigned int aEventCode, Button aButton, double aDuration)
+    {
+        EventRecord record;
+        record.dispatcher = this;
+        record.eventCode = aEventCode;
+        record.data.mouseButton.button = aButton;
+        record.data.mouseButton.duration = aDuration;
+        record.data.mouseButton.x = m_Position.x;
+        record.data.mouseButton.y = m_Position.y;
+        Services::GetApplication()->QueueEvent(record);
     }
     
     std::string Mouse::ButtonToString(Mouse::Button aButton)
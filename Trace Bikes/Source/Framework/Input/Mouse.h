@@ -54,6 +54,9 @@ namespace GameDev2D
         //Dispatches a Mouse scrolled event
         void HandleScroll(float delta);
 
+        //Queues a mouse button event, they're dispatched at the start of the next update
+        void QueueButtonEvent(unsigned int eventCode, Button button, double duration);
+
         //Manages the internal State for each Mouse Button
         struct State
         {
@@ -18,6 +18,24 @@ namespace GameDev2D
         WatchDouble(std::bind(&GameLoop::GetDelta, Services::GetApplication()->GetGameLoop()));
 #endif
 
+#if DEBUG_DRAW_FRAME_JITTER
+        WatchDouble(std::bind(&GameLoop::GetFrameJitter, Services::GetApplication()->GetGameLoop()));
+        WatchDouble(std::bind(&GameLoop::GetMaxFrameJitter, Services::GetApplication()->GetGameLoop()));
+#endif
+
+#if DEBUG_DRAW_FRAME_PERCENTILES
+        //The total frame time's p50, p95, p99 and max
+        WatchDouble(std::bind(&GameLoop::GetFrameTimePercentile, Services::GetApplication()->GetGameLoop(), FrameTiming_Total, 50.0));
+        WatchDouble(std::bind(&GameLoop::GetFrameTimePercentile, Services::GetApplication()->GetGameLoop(), FrameTiming_Total, 95.0));
+        WatchDouble(std::bind(&GameLoop::GetFrameTimePercentile, Services::GetApplication()->GetGameLoop(), FrameTiming_Total, 99.0));
+        WatchDouble(std::bind(&GameLoop::GetMaxFrameTime, Services::GetApplication()->GetGameLoop(), FrameTiming_Total));
+#endif
+
+#if DEBUG_DRAW_EVENT_DISPATCH_TIME
+        WatchUnsignedInt(std::bind(&EventQueue::GetLastDispatchCount, Services::GetApplication()->GetEventQueue()));
+        WatchDouble(std::bind(&EventQueue::GetLastDispatchTime, Services::GetApplication()->GetEventQueue()));
+#endif
+
 #if DEBUG_DRAW_ELAPSED_TIME
         WatchDouble(std::bind(&GameLoop::GetElapsedTime, Services::GetApplication()->GetGameLoop()));
 #endif
@@ -25,6 +43,14 @@ namespace GameDev2D
 #if DEBUG_DRAW_ALLOCATED_TEXTURE_MEMORY
         WatchUnsignedLongLong(std::bind(&Graphics::GetAllocatedTextureMemory, Services::GetGraphics()), true);
 #endif
+
+#if DEBUG_DRAW_GL_OBJECT_COUNT
+        //The live texture, vertex array, buffer and framebuffer counts
+        WatchUnsignedInt(std::bind(&Graphics::GetTextureCount, Services::GetGraphics()));
+        WatchUnsignedInt(std::bind(&Graphics::GetVertexArrayCount, Services::GetGraphics()));
+        WatchUnsignedInt(std::bind(&Graphics::GetDataBufferCount, Services::GetGraphics()));
+        WatchUnsignedInt(std::bind(&Graphics::GetFrameBufferCount, Services::GetGraphics()));
+#endif
 #if DEBUG ||_DEBUG
         //Add an event listener callback for the Update event
         Services::GetApplication()->AddEventListener(this, DRAW_EVENT);
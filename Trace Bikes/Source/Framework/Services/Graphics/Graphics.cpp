@@ -585,6 +585,7 @@ namespace GameDev2D
         //Generate a texture
         unsigned int id = 0;
         glGenTextures(1, &id);
+        m_Stats.textures++;
 
         //Log the Graphics event
         Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Generate texture: %u", id);
@@ -615,6 +616,7 @@ namespace GameDev2D
         //Delete the texture
         unsigned int id = aTexture->GetId();
         glDeleteTextures(1, &id);
+        m_Stats.textures--;
 
         //Log the Graphics event
         Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Delete texture: %u", aTexture->GetId());
@@ -695,6 +697,7 @@ namespace GameDev2D
     {
         //Generate the framebuffer
         glGenFramebuffers(1, aFrameBuffer);
+        m_Stats.frameBuffers++;
 
         //Log the graphics event
         Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Generate framebuffer: %u", *aFrameBuffer);
@@ -702,14 +705,18 @@ namespace GameDev2D
 
     void Graphics::DeleteFrameBuffer(unsigned int* aFrameBuffer)
     {
-        //Delete the framebuffer
-        glDeleteFramebuffers(1, aFrameBuffer);
+        if (*aFrameBuffer != 0)
+        {
+            //Delete the framebuffer
+            glDeleteFramebuffers(1, aFrameBuffer);
+            m_Stats.frameBuffers--;
 
-        //Log the graphics event
-        Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Delete framebuffer: %u", *aFrameBuffer);
+            //Log the graphics event
+            Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Delete framebuffer: %u", *aFrameBuffer);
 
-        //Set the framebuffer to zero
-        *aFrameBuffer = 0;
+            //Set the framebuffer to zero
+            *aFrameBuffer = 0;
+        }
     }
 
     void Graphics::SetFrameBufferStorage(unsigned int aFrameBuffer, unsigned int aTextureId)
@@ -782,6 +789,7 @@ namespace GameDev2D
     {
         //Generate a new vertex array
         glGenVertexArrays(1, aVertexArray);
+        m_Stats.vertexArrays++;
 
         //Log the Graphics event
         Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Generate vertex array: %u", *aVertexArray);
@@ -793,6 +801,7 @@ namespace GameDev2D
         {
             //Delete the vertex array
             glDeleteVertexArrays(1, aVertexArray);
+            m_Stats.vertexArrays--;
             
             //Log the Graphics event
             Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Delete vertex array: %u", *aVertexArray);
@@ -828,6 +837,7 @@ namespace GameDev2D
     {
         //Generate the buffer
         glGenBuffers(1, aDataBuffer);
+        m_Stats.dataBuffers++;
 
         //Log the Graphics event
         Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Generate buffer: %u", *aDataBuffer);
@@ -839,6 +849,7 @@ namespace GameDev2D
         {
             //Delete the vertex buffer
             glDeleteBuffers(1, aDataBuffer);
+            m_Stats.dataBuffers--;
 
             //Log the Graphics event
             Log::Message(this, "Graphics", Log::Verbosity_Graphics, "Delete buffer: %u", *aDataBuffer);
@@ -1148,4 +1159,24 @@ namespace GameDev2D
     {
         return m_Stats.textureMemory;
     }
+
+    unsigned int Graphics::GetTextureCount()
+    {
+        return m_Stats.textures;
+    }
+
+    unsigned int Graphics::GetVertexArrayCount()
+    {
+        return m_Stats.vertexArrays;
+    }
+
+    unsigned int Graphics::GetDataBufferCount()
+    {
+        return m_Stats.dataBuffers;
+    }
+
+    unsigned int Graphics::GetFrameBufferCount()
+    {
+        return m_Stats.frameBuffers;
+    }
 }
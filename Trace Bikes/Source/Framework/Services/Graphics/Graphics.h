@@ -241,16 +241,31 @@ namespace GameDev2D
         struct Stats
         {
             Stats() :
-                textureMemory(0)
+                textureMemory(0),
+                textures(0),
+                vertexArrays(0),
+                dataBuffers(0),
+                frameBuffers(0)
             {
             }
 
             unsigned long long textureMemory;
+            unsigned int textures;
+            unsigned int vertexArrays;
+            unsigned int dataBuffers;
+            unsigned int frameBuffers;
         };
 
         //Returns the Graphics stats
         unsigned long long GetAllocatedTextureMemory();
 
+        //Returns the number of live OpenGL objects of each kind, every Sprite, Polygon and Label owns a vertex array and a buffer,
+        //and every RenderTarget a framebuffer
+        unsigned int GetTextureCount();
+        unsigned int GetVertexArrayCount();
+        unsigned int GetDataBufferCount();
+        unsigned int GetFrameBufferCount();
+
     private:
         //Member variables
         VertexData* m_TexturedVertexData;
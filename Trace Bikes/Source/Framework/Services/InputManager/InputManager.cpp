@@ -3,11 +3,16 @@
 #include "../../Events/UpdateEvent.h"
 #include "../../Windows/Application.h"
 #include "../../Debug/Log.h"
+#include "../../Input/InputThread.h"
+#include <GameDev2D.h>
 
 
 namespace GameDev2D
 {
     InputManager::InputManager() : EventHandler(),
+        m_InputQueue(nullptr),
+        m_InputThread(nullptr),
+        m_KeyPressTime(0.0),
         m_Keyboard(nullptr),
         m_Mouse(nullptr)
     {
@@ -23,12 +28,48 @@ namespace GameDev2D
             m_GamePads[port] = new GamePad(static_cast<GamePad::Port>(port));
         }
 
+        //Create the InputQueue, the key events are handled from it at the start of every update
+        m_InputQueue = new InputQueue();
+
+        //Without an Application, as in the input latency benchmark, there's no window to read from and no update to listen for
+        Application* application = Services::GetApplication();
+
+        //Start the input thread, if raw input isn't available the keys come from the window's messages instead
+#if INPUT_THREAD
+        if (application != nullptr && application->GetWindow() != nullptr)
+        {
+            m_InputThread = new InputThread(m_InputQueue, application->GetWindow()->GetWindowHandle());
+            if (m_InputThread->IsRunning() == false)
+            {
+                Log::Message(this, "InputManager", Log::Verbosity_Input, "Raw keyboard input isn't available, the input thread won't be used");
+                delete m_InputThread;
+                m_InputThread = nullptr;
+            }
+        }
+#endif
+
         //Add an event listener callback for the Update event
-        Services::GetApplication()->AddEventListener(this, UPDATE_EVENT);
+        if (application != nullptr)
+        {
+            application->AddEventListener(this, UPDATE_EVENT);
+        }
     }
     
     InputManager::~InputManager()
     {
+        //Stop the input thread before the queue it pushes to is deleted
+        if (m_InputThread != nullptr)
+        {
+            delete m_InputThread;
+            m_InputThread = nullptr;
+        }
+
+        if (m_InputQueue != nullptr)
+        {
+            delete m_InputQueue;
+            m_InputQueue = nullptr;
+        }
+
         if (m_Keyboard != nullptr)
         {
             delete m_Keyboard;
@@ -51,7 +92,10 @@ namespace GameDev2D
         }
 
         //Remove the event listener callback for the Update event
-        Services::GetApplication()->RemoveEventListener(this, UPDATE_EVENT);
+        if (Services::GetApplication() != nullptr)
+        {
+            Services::GetApplication()->RemoveEventListener(this, UPDATE_EVENT);
+        }
     }
 
     void InputManager::HandleEvent(Event* aEvent)
@@ -114,6 +158,11 @@ namespace GameDev2D
 		m_KeyPressedCallback = aKeyPressedCallback;
 	}
 
+	void InputManager::RegisterKeyDownCallback(std::function<void(Keyboard::Key)> aKeyDownCallback)
+	{
+		m_KeyDownCallback = aKeyDownCallback;
+	}
+
     Keyboard* InputManager::GetKeyboard()
     {
         return m_Keyboard;
@@ -130,24 +179,99 @@ namespace GameDev2D
     }
     
     void InputManager::HandleKeyDown(unsigned int aKey)
+    {
+        if (m_InputThread == nullptr)
+        {
+            QueueKeyEvent(aKey, InputEvent::KeyDown, GameLoop::GetTime());
+        }
+    }
+
+    void InputManager::HandleKeyUp(unsigned int aKey)
+    {
+        if (m_InputThread == nullptr)
+        {
+            QueueKeyEvent(aKey, InputEvent::KeyUp, GameLoop::GetTime());
+        }
+    }
+
+    bool InputManager::QueueKeyEvent(unsigned int aKey, InputEvent::Type aType, double aTimestamp)
+    {
+        InputEvent inputEvent;
+        inputEvent.timestamp = aTimestamp;
+        inputEvent.key = aKey;
+        inputEvent.type = aType;
+        return m_InputQueue->Push(inputEvent);
+    }
+
+    void InputManager::ProcessInputQueue()
+    {
+        InputEvent inputEvent;
+        while (m_InputQueue->Pop(inputEvent) == true)
+        {
+            if (inputEvent.type == InputEvent::KeyDown)
+            {
+                ApplyKeyDown(inputEvent.key, inputEvent.timestamp);
+            }
+            else
+            {
+                ApplyKeyUp(inputEvent.key, inputEvent.timestamp);
+            }
+        }
+    }
+
+    bool InputManager::IsInputThreadRunning() const
+    {
+        return m_InputThread != nullptr;
+    }
+
+    double InputManager::GetKeyPressTime() const
+    {
+        return m_KeyPressTime;
+    }
+
+    void InputManager::ApplyKeyDown(unsigned int aKey, double aTimestamp)
     {
         //Ensure the application hasn't been suspended
-        if (Services::GetApplication()->IsSuspended() == true)
+        if (Services::GetApplication() != nullptr && Services::GetApplication()->IsSuspended() == true)
         {
             return;
         }
 
-        //Have the Keyboard handle the key up
+        //Only the first key down is the press, the ones that follow while the key is held are repeats
+        bool isPress = m_KeyPressTimes.find(aKey) == m_KeyPressTimes.end();
+        if (isPress == true)
+        {
+            m_KeyPressTimes[aKey] = aTimestamp;
+        }
+
+        //Have the Keyboard handle the key down
         if (m_Keyboard != nullptr)
         {
             m_Keyboard->HandleKeyDown(static_cast<Keyboard::Key>(aKey));
         }
+
+		//Handle the callback
+		if (isPress == true && m_KeyDownCallback != nullptr)
+		{
+			m_KeyPressTime = aTimestamp;
+			m_KeyDownCallback(static_cast<Keyboard::Key>(aKey));
+		}
     }
 
-    void InputManager::HandleKeyUp(unsigned int aKey)
+    void InputManager::ApplyKeyUp(unsigned int aKey, double aTimestamp)
     {
+        //The key is released even while suspended, otherwise its next key down would be taken for a repeat.
+        //If its key down was missed, the release is the best guess there is for when it was pressed
+        double pressTime = aTimestamp;
+        std::map<unsigned int, double>::iterator pressed = m_KeyPressTimes.find(aKey);
+        if (pressed != m_KeyPressTimes.end())
+        {
+            pressTime = pressed->second;
+            m_KeyPressTimes.erase(pressed);
+        }
+
         //Ensure the application hasn't been suspended
-        if (Services::GetApplication()->IsSuspended() == true)
+        if (Services::GetApplication() != nullptr && Services::GetApplication()->IsSuspended() == true)
         {
             return;
         }
@@ -161,6 +285,7 @@ namespace GameDev2D
 		//Handle the callback
 		if (m_KeyPressedCallback != nullptr)
 		{
+			m_KeyPressTime = pressTime;
 			m_KeyPressedCallback(static_cast<Keyboard::Key>(aKey));
 		}
     }
@@ -5,6 +5,7 @@
 #include "../../Input/Keyboard.h"
 #include "../../Input/Mouse.h"
 #include "../../Input/GamePad.h"
+#include "../../Input/InputQueue.h"
 #include "../../Math/Vector2.h"
 #include <map>
 
@@ -13,6 +14,7 @@ namespace GameDev2D
 {
     //Forward declarations
     class MouseMovementEvent;
+    class InputThread;
 
     // The InputManager game service handles all input for all platforms, including mouse, keyboard and GamePad
     class InputManager : public EventHandler
@@ -34,6 +36,9 @@ namespace GameDev2D
 		// Registers a callback function to be called whenever the key is pressed (down then up)
 		void RegisterKeyPressedCallback(std::function<void(Keyboard::Key)> keyPressedCallback);
 
+		// Registers a callback function to be called as soon as a key goes down, key repeats don't call it
+		void RegisterKeyDownCallback(std::function<void(Keyboard::Key)> keyDownCallback);
+
 
         //Returns the Keyboard object, which manages the button state for all the keys
         Keyboard* GetKeyboard();
@@ -44,10 +49,25 @@ namespace GameDev2D
         //Returns the GamePad for a port, the GamePad the thumb stick, trigger and button states
         GamePad* GetGamePad(GamePad::Port port);
 
-        //Methods to handle Keyboard input
+        //Methods to handle Keyboard input from the window, the keys are queued and handled by ProcessInputQueue().
+        //They're ignored while the input thread is running, since it already queues every key
         void HandleKeyDown(unsigned int key);
         void HandleKeyUp(unsigned int key);
 
+        //Queues a key event, it is safe to call from any thread. The timestamp is in GameLoop::GetTime() seconds.
+        //Returns false if the queue is full
+        bool QueueKeyEvent(unsigned int key, InputEvent::Type type, double timestamp);
+
+        //Handles the queued key events, called by the Application at the start of every update
+        void ProcessInputQueue();
+
+        //Returns wether the keyboard is read by the input thread, rather than the window's message pump
+        bool IsInputThreadRunning() const;
+
+        //Returns the timestamp, in GameLoop::GetTime() seconds, the key being handled by the key down or key pressed
+        //callback went down. Use it to know when the key was actually pressed, rather than when it is handled
+        double GetKeyPressTime() const;
+
         //Methods to handle Mouse input
         void HandleLeftMouseDown(float x, float y);
         void HandleLeftMouseUp(float x, float y);
@@ -59,13 +79,22 @@ namespace GameDev2D
         void HandleScrollWheel(float delta);
     
     private:
+        //Applies a key event to the Keyboard and calls the key down or key pressed callback
+        void ApplyKeyDown(unsigned int key, double timestamp);
+        void ApplyKeyUp(unsigned int key, double timestamp);
+
         //Keyboard data
+        InputQueue* m_InputQueue;
+        InputThread* m_InputThread;
+        double m_KeyPressTime;
+        std::map<unsigned int, double> m_KeyPressTimes;
         Keyboard* m_Keyboard;
         Mouse* m_Mouse;
         GamePad* m_GamePads[GamePad::PortCount];
 		std::function<void(float, float)> m_LeftMouseClickCallback;
 		std::function<void(float, float)> m_RightMouseClickCallback;
 		std::function<void(Keyboard::Key)> m_KeyPressedCallback;
+		std::function<void(Keyboard::Key)> m_KeyDownCallback;
     };
 }
 
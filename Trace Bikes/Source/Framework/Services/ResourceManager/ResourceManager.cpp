@@ -1,6 +1,7 @@
 #include "ResourceManager.h"
 #include "../../Audio/Audio.h"
 #include "../../Debug/Log.h"
+#include "../../Debug/Profile.h"
 #include "../../Graphics/Font.h"
 #include "../../Graphics/Shader.h"
 #include "../../Graphics/SpriteAtlas.h"
@@ -180,6 +181,8 @@ namespace GameDev2D
 
     void ResourceManager::LoadAudio(const std::string& aFilename, const std::string& aExtension)
     {
+        PROFILE_ZONE("ResourceManager::LoadAudio");
+
         if (IsAudioLoaded(aFilename, aExtension) == false)
         {
             //Safety check the filename
@@ -261,6 +264,8 @@ namespace GameDev2D
     
     void ResourceManager::LoadFont(const std::string& aFilename, const std::string& aExtension, unsigned int aSize, const string& aCharacterSet)
     {
+        PROFILE_ZONE("ResourceManager::LoadFont");
+
         //Check if the font loaded
         if (IsFontLoaded(aFilename, aExtension, aSize) == false)
         {
@@ -329,6 +334,8 @@ namespace GameDev2D
 
     void ResourceManager::LoadShader(ShaderInfo* aShaderInfo, const string& aKey)
     {
+        PROFILE_ZONE("ResourceManager::LoadShader");
+
         //Is the Shader loaded?
         if (IsShaderLoaded(aKey) == false)
         {
@@ -487,6 +494,8 @@ namespace GameDev2D
 
     void ResourceManager::LoadTexture(const string& aFilename)
     {
+        PROFILE_ZONE("ResourceManager::LoadTexture");
+
         //Is the Texture loaded?
         if (IsTextureLoaded(aFilename) == false)
         {
@@ -585,6 +594,8 @@ namespace GameDev2D
 
     void ResourceManager::LoadAtlas(const string& aFilename)
     {
+        PROFILE_ZONE("ResourceManager::LoadAtlas");
+
         if (IsAtlasLoaded(aFilename) == false)
         {
             //Get the json path
@@ -14,6 +14,8 @@ namespace GameDev2D
 {
     void TrueType::Rasterize(const std::string& aFilename, const std::string& aExtension, unsigned int aSize, const std::string& aCharacterSet, Font** aFont)
     {
+        PROFILE_ZONE("TrueType::Rasterize");
+
         //The FreeType library used to load .ttf and .otf fonts
         FT_Library freeType;
 
@@ -1,6 +1,7 @@
 #include "Application.h"
 #include "../Services/Services.h"
 #include "../Debug/Log.h"
+#include "../Debug/Profile.h"
 #include "../Events/UpdateEvent.h"
 
 
@@ -9,6 +10,9 @@ namespace GameDev2D
     Application::Application(const char* aWindowTitle, int aFrameRate, unsigned int aWidth, unsigned int aHeight, bool aFullscreen) : 
         m_GameWindow(nullptr),
         m_GameLoop(nullptr),
+        m_EventQueue(nullptr),
+        m_UpdateEvent(0.0),
+        m_DrawEvent(DRAW_EVENT),
         m_IsSuspended(false),
         m_IsRunning(true)
     {
@@ -19,6 +23,9 @@ namespace GameDev2D
         m_GameLoop = new GameLoop(this);
         m_GameLoop->SetTargetFrameRate(aFrameRate);
 
+        //Create the EventQueue
+        m_EventQueue = new EventQueue();
+
         //Add an event listener for the GameLoop so it is notified of a RESUME_EVENT
         AddEventListener(m_GameLoop, RESUME_EVENT);
 
@@ -46,11 +53,20 @@ namespace GameDev2D
             m_GameLoop = nullptr;
         }
 
+        if (m_EventQueue != nullptr)
+        {
+            delete m_EventQueue;
+            m_EventQueue = nullptr;
+        }
+
         //Call the shutdown callback
         m_ShutdownCallback();
 
         //Clean up the game services
         Services::Cleanup();
+
+        //Write out the recorded profile zones
+        PROFILE_EXPORT(PROFILE_TRACE_FILE);
     }
     
     void Application::Init(std::function<void()> aInitCallback, std::function<void()> aShutdownCallback, std::function<void(double)> aUpdateCallback, std::function<void()> aDrawCallback)
@@ -95,6 +111,16 @@ namespace GameDev2D
         return m_GameLoop;
     }
 
+    EventQueue* Application::GetEventQueue() const
+    {
+        return m_EventQueue;
+    }
+
+    bool Application::QueueEvent(const EventRecord& aRecord)
+    {
+        return m_EventQueue->Push(aRecord);
+    }
+
     bool Application::Loop()
     {
         if (m_IsSuspended == false)
@@ -110,11 +136,16 @@ namespace GameDev2D
         //If the game isn't running anymore, return false
         if (m_IsRunning == true)
         {
+            //Handle the queued keys and dispatch the queued input events before anything is updated
+            Services::GetInputManager()->ProcessInputQueue();
+            m_EventQueue->Dispatch();
+
             //Call the update callback
             m_UpdateCallback(aDelta);
 
             //Dispatch an Update event
-            DispatchEvent(UpdateEvent(aDelta));
+            m_UpdateEvent.SetDelta(aDelta);
+            DispatchEvent(m_UpdateEvent);
         }
     }
 
@@ -130,7 +161,7 @@ namespace GameDev2D
         m_DrawCallback();
         
         //Dispatch a Draw event
-        DispatchEvent(Event(DRAW_EVENT));
+        DispatchEvent(m_DrawEvent);
 
         //If the application isn't suspended, flush the opengl buffer
         if(m_IsSuspended == false)
@@ -4,6 +4,8 @@
 #include "GameLoop.h"
 #include "GameWindow.h"
 #include "../Events/EventDispatcher.h"
+#include "../Events/EventQueue.h"
+#include "../Events/UpdateEvent.h"
 #include <functional>
 #include <string>
 
@@ -34,6 +36,12 @@ namespace GameDev2D
         //
         GameLoop* GetGameLoop() const;
 
+        //Returns the EventQueue, its events are dispatched at the start of every update
+        EventQueue* GetEventQueue() const;
+
+        //Queues an event to be dispatched at the start of the next update, returns false if the queue is full
+        bool QueueEvent(const EventRecord& record);
+
         //The Loop() methodis responsible for calling the Update() and Draw() methods
         //if the application isn't in a suspended state
         bool Loop();
@@ -94,6 +102,9 @@ namespace GameDev2D
         std::function<void()> m_DrawCallback;
         GameWindow* m_GameWindow;
         GameLoop* m_GameLoop;
+        EventQueue* m_EventQueue;
+        UpdateEvent m_UpdateEvent;  //The update and draw events are dispatched every frame, they're reused
+        Event m_DrawEvent;
         bool m_IsSuspended;
         bool m_IsRunning;
     };
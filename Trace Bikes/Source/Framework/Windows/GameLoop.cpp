@@ -1,9 +1,15 @@
 #include "GameLoop.h"
 #include "../Debug/Log.h"
+#include "../Debug/Profile.h"
 #include <GameDev2D.h>
 #include <Windows.h>
 #include <assert.h>
 
+//Only defined by the Windows 10 (1803) SDK and newer, older systems fail the call and fall back to a regular timer
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 
 namespace GameDev2D
 {
@@ -16,19 +22,86 @@ namespace GameDev2D
         m_PreviousFpsUpdate(0.0),
         m_FpsUpdateFrequency(1.0),
         m_TargetFrameTime(0.0),
+        m_FixedTimeStep(0.0),
+        m_Accumulator(0.0),
+        m_InterpolationAlpha(1.0),
+        m_UpdateTime(0.0),
+#ifdef MAX_UPDATES_PER_FRAME
+        m_MaxUpdatesPerFrame(MAX_UPDATES_PER_FRAME),
+#else
+        m_MaxUpdatesPerFrame(8),
+#endif
         m_Fps(0),
         m_Frames(0),
 #ifdef LIMIT_FPS
-        m_LimitFramerate(LIMIT_FPS)
+        m_LimitFramerate(LIMIT_FPS),
+#else
+        m_LimitFramerate(true),
+#endif
+#ifdef FRAME_PACING
+        m_FramePacing(FRAME_PACING),
 #else
-        m_LimitFramerate(true)
+        m_FramePacing(FramePacing_Hybrid),
 #endif
+        m_WaitableTimer(nullptr),
+        m_IsHighResolutionTimer(true),
+#ifdef FRAME_PACING_SPIN_TIME
+        m_SpinTime(FRAME_PACING_SPIN_TIME),
+#else
+        m_SpinTime(0.5),
+#endif
+        m_FrameJitter(0.0),
+        m_MaxFrameJitter(0.0),
+        m_JitterTotal(0.0),
+        m_JitterMax(0.0),
+        m_FrameTimings(nullptr)
     {
         //The callback pointer can't be null
         assert(m_Callback != nullptr);
 
         //Initialize the variables that need a starting time
         m_PreviousFpsUpdate = m_CurrentTime = GetTime();
+
+#ifdef FIXED_UPDATE_RATE
+        SetFixedUpdateRate(FIXED_UPDATE_RATE);
+#endif
+
+        //Create the frame timings, they're too large for the stack
+        m_FrameTimings = new FrameTimings();
+
+        //Create the timer the hybrid frame pacing sleeps on, the high resolution timer wakes up within 
+        //a fraction of a millisecond, a regular one needs the system timer resolution raised to 1 millisecond
+        m_WaitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (m_WaitableTimer == nullptr)
+        {
+            m_IsHighResolutionTimer = false;
+            m_WaitableTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            timeBeginPeriod(1);
+        }
+    }
+
+    GameLoop::~GameLoop()
+    {
+        if (m_FrameTimings != nullptr)
+        {
+#if EXPORT_FRAME_TIMINGS
+            m_FrameTimings->Export(FRAME_TIMINGS_CSV);
+            m_FrameTimings->ExportSummary(FRAME_TIMINGS_SUMMARY_CSV);
+#endif
+            delete m_FrameTimings;
+            m_FrameTimings = nullptr;
+        }
+
+        if (m_WaitableTimer != nullptr)
+        {
+            CloseHandle(m_WaitableTimer);
+            m_WaitableTimer = nullptr;
+        }
+
+        if (m_IsHighResolutionTimer == false)
+        {
+            timeEndPeriod(1);
+        }
     }
 
     void GameLoop::HandleEvent(Event* aEvent)
@@ -49,6 +122,8 @@ namespace GameDev2D
         //Can we actually step?
         if (CanStep() == true)
         {
+            PROFILE_ZONE("GameLoop::Step");
+
             //Set the 'previous' time
             m_PreviousTime = m_CurrentTime;
 
@@ -68,22 +143,68 @@ namespace GameDev2D
             //Should we update and draw our frame?
             if (doCallback == true)
             {
-                //Call the update callback
-                m_Callback->Update(m_DeltaTime);
+                //Call the update callback, either once with the frame's delta or as many
+                //fixed steps as fit in the accumulated time
+                double updateStart = GetTime();
+                if (m_FixedTimeStep > 0.0)
+                {
+                    m_Accumulator += m_DeltaTime;
+
+                    unsigned int updates = 0;
+                    while (m_Accumulator >= m_FixedTimeStep && updates < m_MaxUpdatesPerFrame)
+                    {
+                        //The time left in the accumulator after this update hasn't been simulated yet
+                        m_UpdateTime = m_CurrentTime - (m_Accumulator - m_FixedTimeStep);
+                        m_Callback->Update(m_FixedTimeStep);
+                        m_Accumulator -= m_FixedTimeStep;
+                        updates++;
+                    }
+
+                    //Drop whatever we couldn't catch up on, keeping the partial step
+                    if (m_Accumulator >= m_FixedTimeStep)
+                    {
+                        m_Accumulator = fmod(m_Accumulator, m_FixedTimeStep);
+                    }
+
+                    m_InterpolationAlpha = m_Accumulator / m_FixedTimeStep;
+                }
+                else
+                {
+                    m_UpdateTime = m_CurrentTime;
+                    m_Callback->Update(m_DeltaTime);
+                    m_InterpolationAlpha = 1.0;
+                }
 
                 //Call the draw callback
+                double drawStart = GetTime();
                 m_Callback->Draw();
+                double drawEnd = GetTime();
+
+                //Record the frame's timings, in milliseconds
+                m_FrameTimings->Add((drawStart - updateStart) * 1000.0, (drawEnd - drawStart) * 1000.0, m_DeltaTime * 1000.0);
 
                 //Increment the frame count
                 m_Frames++;
 
-                //Should we update the FPS value?
+                //Accumulate how far the frame time was from the target, in milliseconds
+                if (m_LimitFramerate == true)
+                {
+                    double jitter = fabs(m_DeltaTime * 1000.0 - m_TargetFrameTime);
+                    m_JitterTotal += jitter;
+                    m_JitterMax = jitter > m_JitterMax ? jitter : m_JitterMax;
+                }
+
+                //Should we update the FPS and jitter values?
                 double timeSinceLast = m_CurrentTime - m_PreviousFpsUpdate;
                 if (timeSinceLast > m_FpsUpdateFrequency)
                 {
                     m_Fps = static_cast<unsigned int>(std::roundf((float)m_Frames / (float)timeSinceLast));
+                    m_FrameJitter = m_JitterTotal / (double)m_Frames;
+                    m_MaxFrameJitter = m_JitterMax;
                     m_PreviousFpsUpdate = m_CurrentTime;
                     m_Frames = 0;
+                    m_JitterTotal = 0.0;
+                    m_JitterMax = 0.0;
                 }
             }
         }
@@ -124,6 +245,84 @@ namespace GameDev2D
         return m_LimitFramerate;
     }
 
+    void GameLoop::SetFramePacing(FramePacing aFramePacing)
+    {
+        m_FramePacing = aFramePacing;
+    }
+
+    FramePacing GameLoop::GetFramePacing() const
+    {
+        return m_FramePacing;
+    }
+
+    void GameLoop::SetSpinTime(double aMilliseconds)
+    {
+        m_SpinTime = aMilliseconds > 0.0 ? aMilliseconds : 0.0;
+    }
+
+    double GameLoop::GetSpinTime() const
+    {
+        return m_SpinTime;
+    }
+
+    double GameLoop::GetFrameJitter() const
+    {
+        return m_FrameJitter;
+    }
+
+    double GameLoop::GetMaxFrameJitter() const
+    {
+        return m_MaxFrameJitter;
+    }
+
+    const FrameTimings& GameLoop::GetFrameTimings() const
+    {
+        return *m_FrameTimings;
+    }
+
+    double GameLoop::GetFrameTimePercentile(FrameTiming aTiming, double aPercentile) const
+    {
+        return m_FrameTimings->GetPercentile(aTiming, aPercentile);
+    }
+
+    double GameLoop::GetMaxFrameTime(FrameTiming aTiming) const
+    {
+        return m_FrameTimings->GetMax(aTiming);
+    }
+
+    void GameLoop::SetFixedUpdateRate(unsigned int aUpdatesPerSecond)
+    {
+        m_FixedTimeStep = aUpdatesPerSecond > 0 ? 1.0 / static_cast<double>(aUpdatesPerSecond) : 0.0;
+        m_Accumulator = 0.0;
+        m_InterpolationAlpha = 1.0;
+    }
+
+    unsigned int GameLoop::GetFixedUpdateRate() const
+    {
+        return m_FixedTimeStep > 0.0 ? static_cast<unsigned int>(std::round(1.0 / m_FixedTimeStep)) : 0;
+    }
+
+    void GameLoop::SetMaxUpdatesPerFrame(unsigned int aMaxUpdates)
+    {
+        //At least one update has to run per frame
+        m_MaxUpdatesPerFrame = aMaxUpdates > 0 ? aMaxUpdates : 1;
+    }
+
+    unsigned int GameLoop::GetMaxUpdatesPerFrame() const
+    {
+        return m_MaxUpdatesPerFrame;
+    }
+
+    double GameLoop::GetInterpolationAlpha() const
+    {
+        return m_InterpolationAlpha;
+    }
+
+    double GameLoop::GetUpdateTime() const
+    {
+        return m_UpdateTime;
+    }
+
     double GameLoop::GetTime()
     {
         static const double timerPeriod = GetTimerFrequency();
@@ -151,9 +350,38 @@ namespace GameDev2D
             double frameTime = (GetTime() - m_CurrentTime) * 1000.0; //In milleseconds
             if (frameTime < m_TargetFrameTime)
             {
+                //Sleep through most of the remaining time, the last fraction of a millisecond is spun away
+                //by the application's loop calling Step() again, since a sleep can't wake up that precisely
+                double remaining = m_TargetFrameTime - frameTime;
+                if (m_FramePacing == FramePacing_Hybrid && remaining > m_SpinTime)
+                {
+                    SleepFor(remaining - m_SpinTime);
+                }
                 return false;
             }
         }
         return true;
     }
+
+    void GameLoop::SleepFor(double aMilliseconds)
+    {
+        //Without a timer, a regular sleep is the best we can do
+        if (m_WaitableTimer == nullptr)
+        {
+            ::Sleep(static_cast<DWORD>(aMilliseconds));
+            return;
+        }
+
+        //The due time is relative when negative, in 100 nanosecond intervals
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(aMilliseconds * 10000.0);
+        if (SetWaitableTimer(m_WaitableTimer, &dueTime, 0, nullptr, nullptr, FALSE) == FALSE)
+        {
+            return;
+        }
+
+        //Wait for the timer, but wake up as soon as there is input to process so the sleep never adds input latency,
+        //CanStep() will go back to sleep for whatever time is left after the message is handled
+        MsgWaitForMultipleObjectsEx(1, &m_WaitableTimer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    }
 }
\ No newline at end of file
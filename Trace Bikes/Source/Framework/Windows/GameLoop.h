@@ -1,8 +1,10 @@
 #ifndef __GameDev2D__GameLoop__
 #define __GameDev2D__GameLoop__
 
+#include "../Debug/FrameTimings.h"
 #include "../Events/EventHandler.h"
 #include <functional>
+#include <Windows.h>
 
 
 namespace GameDev2D
@@ -17,10 +19,19 @@ namespace GameDev2D
     };
 
 
+    //How the GameLoop waits out the rest of a frame when the framerate is limited
+    enum FramePacing
+    {
+        FramePacing_Spin = 0,   //Busy-waits, most precise but keeps a core at 100%
+        FramePacing_Hybrid      //Sleeps on a high resolution timer, then spins for the last fraction of a millisecond
+    };
+
+
     class GameLoop : public EventHandler
     {
     public:
         GameLoop(GameLoopCallback* callback);
+        ~GameLoop();
 
         //Used to handle a resume event, to ensure we don't get a big delta time spike
         void HandleEvent(Event* event);
@@ -46,6 +57,43 @@ namespace GameDev2D
         void EnableFrameRateLimit(bool isLimitted);
         bool IsFrameRateLimit();
 
+        //Sets and returns how the rest of a frame is waited out
+        void SetFramePacing(FramePacing framePacing);
+        FramePacing GetFramePacing() const;
+
+        //Sets and returns how many milliseconds before the frame is due the hybrid pacing stops sleeping and starts spinning
+        void SetSpinTime(double milliseconds);
+        double GetSpinTime() const;
+
+        //Returns the average and worst difference, in milliseconds, between the frame time and the 
+        //target frame time over the last second
+        double GetFrameJitter() const;
+        double GetMaxFrameJitter() const;
+
+        //Returns the recorded update, draw and total time of the most recent frames
+        const FrameTimings& GetFrameTimings() const;
+
+        //Returns the time (in milliseconds) the percentile (0 to 100) of the recent frames took at most
+        double GetFrameTimePercentile(FrameTiming timing, double percentile) const;
+        double GetMaxFrameTime(FrameTiming timing) const;
+
+        //Sets and returns the fixed update rate, zero updates once per frame with the frame's delta
+        void SetFixedUpdateRate(unsigned int updatesPerSecond);
+        unsigned int GetFixedUpdateRate() const;
+
+        //Sets and returns the maximum number of fixed updates run in a single frame, any time
+        //beyond that is dropped so that a slow frame can't snowball into slower and slower frames
+        void SetMaxUpdatesPerFrame(unsigned int maxUpdates);
+        unsigned int GetMaxUpdatesPerFrame() const;
+
+        //Returns how far between the last and the next fixed update the current frame is drawn,
+        //from 0 to 1, used to interpolate positions. It is always 1 without a fixed update rate
+        double GetInterpolationAlpha() const;
+
+        //Returns the time, in GetTime() seconds, the update being run simulates up to. Fixed updates
+        //run back to back at the start of a frame, each one simulates up to a different point in time
+        double GetUpdateTime() const;
+
         //Get the current 'time' it's an aribitrary time
         static double GetTime();
 
@@ -56,6 +104,9 @@ namespace GameDev2D
         //Conveniance method to determine if we can step
         bool CanStep();
 
+        //Sleeps for up to the duration (in milliseconds), returns early when window messages arrive
+        void SleepFor(double milliseconds);
+
         //Timing variables
         GameLoopCallback* m_Callback;
         double m_DeltaTime; // The current timestep
@@ -65,9 +116,27 @@ namespace GameDev2D
         double m_PreviousFpsUpdate;
         double m_FpsUpdateFrequency;  // The frequency by which to update the FPS
         double m_TargetFrameTime;
+        double m_FixedTimeStep; // Zero without a fixed update rate
+        double m_Accumulator;   // Time not yet consumed by fixed updates
+        double m_InterpolationAlpha;
+        double m_UpdateTime;
+        unsigned int m_MaxUpdatesPerFrame;
         unsigned int m_Fps;
         unsigned int m_Frames;  // Frames since last FPS update
         bool m_LimitFramerate;
+
+        //Frame pacing variables
+        FramePacing m_FramePacing;
+        HANDLE m_WaitableTimer;
+        bool m_IsHighResolutionTimer; // Otherwise the system timer resolution is raised while the GameLoop exists
+        double m_SpinTime;
+        double m_FrameJitter;
+        double m_MaxFrameJitter;
+        double m_JitterTotal;   // Jitter accumulated since last FPS update
+        double m_JitterMax;
+
+        //Per-frame timings
+        FrameTimings* m_FrameTimings;
     };
 }
 
@@ -106,6 +106,11 @@ namespace GameDev2D
         wglDeleteContext(m_OpenGLContext);
     }
 
+    HWND GameWindow::GetWindowHandle() const
+    {
+        return m_WindowHandle;
+    }
+
     unsigned int GameWindow::GetWidth()
     {
         return m_Width;
@@ -37,6 +37,9 @@ namespace GameDev2D
         unsigned int GetWidth();
         unsigned int GetHeight();
 
+        //Returns the Window's handle
+        HWND GetWindowHandle() const;
+
         //Set's the title of the window
         void SetTitle(const std::string& title);
 
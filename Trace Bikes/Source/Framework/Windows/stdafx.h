@@ -1,6 +1,8 @@
 #ifndef GameDev2D_stdafx_h
 #define GameDev2D_stdafx_h
 
+#define NOMINMAX            //Windows.h's min and max macros would replace std::min and std::max
+#include <WinSock2.h>       //Before Windows.h, which would include the older winsock.h otherwise
 #include <Windows.h>
 #include <gl/GL.h>
 #include <gl/GLU.h>
@@ -14,6 +16,7 @@
 
 #pragma comment(lib, "Xinput9_1_0")
 #pragma comment(lib, "Winmm")
+#pragma comment(lib, "Ws2_32")
 
 #include <algorithm>
 #include <fstream>
@@ -47,6 +50,7 @@
 #include "../Events/Event.h"
 #include "../Events/EventDispatcher.h"
 #include "../Events/EventHandler.h"
+#include "../Events/EventQueue.h"
 #include "../Events/FullscreenEvent.h"
 #include "../Events/GamePadButtonDownEvent.h"
 #include "../Events/GamePadButtonUpEvent.h"
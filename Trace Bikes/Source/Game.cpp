@@ -1,16 +1,15 @@
 #include "Game.h"
-#include "Segment.h"
 
 #include <GameDev2D.h>
+#include <algorithm>
+#include <float.h>
+#include <math.h>
 #include <string.h>
 
 namespace GameDev2D
 {
 	Game::Game() :
-		m_timer(3.0f),
 		m_ShouldClearRender(false),
-		m_RedAlive(false),
-		m_BlueAlive(false),
 		m_RoundState(RoundState::Starting)
 	{
 		// Load resources.
@@ -20,74 +19,83 @@ namespace GameDev2D
 		LoadTexture(BLUE_BIKE);
 		LoadFont("Harting_plain", "ttf", 72);
 
-		// Create the bikes.
-		m_RedBike = new Segment(RED_BIKE_START_POS, RED_SEGMENT);
-		m_RedBike->SetAngle(RED_BIKE_START_ROT);
-		m_RedVisual = new Sprite(RED_BIKE);
-		m_RedVisual->SetAnchor(Vector2(0.5f, 0.5f));
-		m_RedVelocity = Vector2::Zero;
+		// Create the simulation, the arena is ARENA_SCREENS screens wide and high.
+		m_Sim = new TraceSim((float)(GetScreenWidth() * ARENA_SCREENS), (float)(GetScreenHeight() * ARENA_SCREENS));
 
-		m_BlueBike = new Segment(BLUE_BIKE_START_POS, BLUE_SEGMENT);
-		m_BlueBike->SetAngle(BLUE_BIKE_START_ROT);
-		m_BlueVisual = new Sprite(BLUE_BIKE);
-		m_BlueVisual->SetAnchor(Vector2(0.5f, 0.5f));
-		m_BlueVelocity = Vector2::Zero;
+		// Record the match, so it can be played again headless. The fixed update rate has to be the sim's tick rate.
+		m_Recorder = new ReplayRecorder(MATCH_REPLAY_PATH, *m_Sim);
+
+		// The AI searches on its own thread, no bike is handed to it until 1 or 2 is pressed.
+		m_AI = new AIController(*m_Sim);
+
+		m_DrawnRuns.resize(m_Sim->GetPlayerCount(), 0);
+		m_DrawnDistance.resize(m_Sim->GetPlayerCount(), 0.0f);
+
+		// Create the bikes, one sprite per bike stamps its trail runs.
+		for (unsigned int player = 0; player < m_Sim->GetPlayerCount(); player++)
+		{
+			Sprite* segment = new Sprite(player % 2 == 0 ? RED_SEGMENT : BLUE_SEGMENT);
+			segment->SetAnchor(Vector2(0.5f, 0.5f));
+			m_Segments.push_back(segment);
+
+			Sprite* visual = new Sprite(player % 2 == 0 ? RED_BIKE : BLUE_BIKE);
+			visual->SetAnchor(Vector2(0.5f, 0.5f));
+			m_Visuals.push_back(visual);
+		}
 
 		// Notification label setup.
 		m_Notification = new Label(GetFont("Harting_plain", "ttf", 72));
 		m_Notification->SetAnchor(Vector2(0.5f, 0.5f));
 		m_Notification->SetPosition(Vector2(GetScreenWidth() / 2, GetScreenHeight() / 2));
 
-		// Create the texture canvas.
-		PixelFormat PixelFormat(PixelFormat::RGBA, PixelFormat::UnsignedByte);
-		ImageData ImageData(PixelFormat, GetScreenWidth(), GetScreenHeight());
-		m_Canvas = new Texture(ImageData);
-		m_RenderTarget = new RenderTarget(m_Canvas);
-
-		AddInitialSegments();
-		m_timer.Start();
+		// The canvas tiles are created as the trails reach them.
+		m_TileColumns = (int)ceilf(m_Sim->GetArenaWidth() / CANVAS_TILE_SIZE);
+		m_TileRows = (int)ceilf(m_Sim->GetArenaHeight() / CANVAS_TILE_SIZE);
+		m_Tiles.resize(m_TileColumns * m_TileRows, nullptr);
 	}
 
 	Game::~Game()
 	{
-		DeleteBikeSegments(m_RedBike);
-		DeleteBikeSegments(m_BlueBike);
-
-		if (m_BlueBike != nullptr)
+		if (m_AI != nullptr)
 		{
-			delete m_BlueBike;
-			m_BlueBike = nullptr;
+			delete m_AI;
+			m_AI = nullptr;
 		}
 
-		if (m_RedVisual != nullptr)
+		if (m_Recorder != nullptr)
 		{
-			delete m_RedVisual;
-			m_RedVisual = nullptr;
+			delete m_Recorder;
+			m_Recorder = nullptr;
 		}
 
-		if (m_BlueVisual != nullptr)
+		if (m_Sim != nullptr)
 		{
-			delete m_BlueVisual;
-			m_BlueVisual = nullptr;
+			delete m_Sim;
+			m_Sim = nullptr;
 		}
 
+		for (Sprite* segment : m_Segments)
+			delete segment;
+		m_Segments.clear();
+
+		for (Sprite* visual : m_Visuals)
+			delete visual;
+		m_Visuals.clear();
+
 		if (m_Notification != nullptr)
 		{
 			delete m_Notification;
 			m_Notification = nullptr;
 		}
 
-		if (m_Canvas != nullptr)
-		{
-			delete m_Canvas;
-			m_Canvas = nullptr;
-		}
-
-		if (m_RenderTarget != nullptr)
+		ClearTiles();
+		for (CanvasTile* tile : m_FreeTiles)
 		{
-			delete m_RenderTarget;
-			m_RenderTarget = nullptr;
+			delete tile->rendertarget;
+			delete tile->canvas;
+			delete tile;
 		}
+		m_FreeTiles.clear();
 
 		// Unload textures.
 		UnloadTexture(RED_SEGMENT);
@@ -99,289 +107,382 @@ namespace GameDev2D
 
 	void Game::Update(double delta)
 	{
-		if (m_timer.IsRunning())
-		{
-			m_timer.Update(delta);
-			m_Notification->SetText(to_string((int)(4 - m_timer.GetPercentage() * 3)));
-
-			if (m_RoundState == RoundState::Starting && m_timer.GetPercentage() >= 1)
-				StartRound();
-		}
-
-		m_RedVisual->SetPosition(m_RedBike->GetPosition());
-		m_BlueVisual->SetPosition(m_BlueBike->GetPosition());
-		m_RedVisual->SetAngle(m_RedBike->GetAngle());
-		m_BlueVisual->SetAngle(m_BlueBike->GetAngle());
-
-		if (m_RoundState != RoundState::Running) return;
-
-		// Move the bikes.
-		Vector2 redposition = m_RedBike->GetPosition() + Vector2(m_RedVelocity.x * delta, m_RedVelocity.y * delta);
-		Vector2 blueposition = m_BlueBike->GetPosition() + Vector2(m_BlueVelocity.x * delta, m_BlueVelocity.y * delta);
+		PROFILE_ZONE("Game::Update");
 
-		m_RedBike->SetPosition(redposition);
-		m_BlueBike->SetPosition(blueposition);
+		// Hand the step the turns pressed before the time it simulates up to, timed from the step's start.
+		// Fixed updates run back to back, keys pressed after this one's time wait for the next.
+		double stepend = GetUpdateTime();
+		unsigned int kept = 0;
+		m_StepTurns.clear();
 
-		// Get the next segment, after the head segment
-		Segment* next = m_RedBike->GetNext();
+		for (const PendingTurn& pending : m_PendingTurns)
+		{
+			if (pending.presstime < stepend)
+			{
+				TurnInput input = pending.input;
+				input.time = (float)(pending.presstime - (stepend - delta));
+				m_StepTurns.push_back(input);
+			}
+			else
+				m_PendingTurns[kept++] = pending;
+		}
+		m_PendingTurns.resize(kept);
 
-		//If the difference is big enough add another segment
-		if (IsBikeAddingSegment(m_RedBike))
-			AddSegment(m_RedBike, RED_SEGMENT);
+		// The AI's turns are recorded with the keys', a replay doesn't need the AI to play back.
+		m_AI->TakeTurns(*m_Sim, m_StepTurns);
 
-		if (IsBikeAddingSegment(m_BlueBike))
-			AddSegment(m_BlueBike, BLUE_SEGMENT);
+		m_Sim->Step(delta, m_StepTurns);
+		m_Recorder->RecordStep(m_StepTurns);
+		m_AI->Post(*m_Sim);
 
-		CheckBikesIntersections();
+		if (m_Sim->GetRoundState() == RoundState::Starting)
+			m_Notification->SetText(to_string((int)(4 - m_Sim->GetCountdownPercentage() * 3)));
 
-		if (!m_RedAlive || !m_BlueAlive)
+		if (m_RoundState != RoundState::GameOver && m_Sim->GetRoundState() == RoundState::GameOver)
 			EndRound();
+
+		m_RoundState = m_Sim->GetRoundState();
 	}
 
 	void Game::Draw()
 	{
-		m_RenderTarget->Begin(m_ShouldClearRender);
-		m_RedBike->GetNext()->Draw();
-		m_BlueBike->GetNext()->Draw();
-		m_RenderTarget->End();
+		// A turn rewound into the past shortens a run that was already drawn, and fading trails drop runs that were
+		// drawn, draw the trails again.
+		const BikeStates& bikes = m_Sim->GetBikes();
 
-		if (m_ShouldClearRender)
-			m_ShouldClearRender = false;
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+		{
+			const TrailBuffer& trail = bikes.trail[player];
+			unsigned long long oldest = trail.GetAddedCount() - trail.GetCount();
+			if (m_DrawnRuns[player] < oldest)
+				m_ShouldClearRender = true;
+			else if (m_DrawnRuns[player] < trail.GetAddedCount() && ToPixels(trail[(size_t)(m_DrawnRuns[player] - oldest)].GetLength()) < m_DrawnDistance[player] - TRAIL_STAMP_DISTANCE)
+				m_ShouldClearRender = true;
+		}
 
-		Services::GetGraphics()->DrawTexture(m_Canvas, Vector2(0.0f, 0.0f), 0.0f, 1.0f);
+		if (m_ShouldClearRender)
+		{
+			for (unsigned int player = 0; player < bikes.GetCount(); player++)
+				m_DrawnRuns[player] = bikes.trail[player].GetAddedCount() - bikes.trail[player].GetCount();
+			std::fill(m_DrawnDistance.begin(), m_DrawnDistance.end(), 0.0f);
+			ClearTiles();
+		}
 
-		m_RedBike->Draw();
-		m_BlueBike->Draw();
-		m_RedVisual->Draw();
-		m_BlueVisual->Draw();
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+			DrawNewTrail(player);
+		DrawStamps();
 
-		if (m_RoundState == RoundState::GameOver || m_RoundState == RoundState::Starting)
-			m_Notification->Draw();
-	}
+		if (m_ShouldClearRender)
+			m_ShouldClearRender = false;
 
-	void Game::Reset()
-	{
-		m_RoundState = RoundState::Starting;
+		// The sim runs at a fixed rate, draw the bikes between their last two positions.
+		float alpha = GetInterpolationAlpha();
+		FollowBikes(alpha);
 
-		m_ShouldClearRender = true;
-		m_RedAlive = false;
-		m_BlueAlive = false;
+		// Only the tiles in the camera's view are drawn, however large the arena.
+		Camera* camera = Services::GetGraphics()->GetCamera();
+		float halfwidth = GetScreenWidth() * camera->GetScale().x * 0.5f;
+		float halfheight = GetScreenHeight() * camera->GetScale().y * 0.5f;
+		int firstcolumn = std::max((int)((camera->GetPosition().x - halfwidth) / CANVAS_TILE_SIZE), 0);
+		int lastcolumn = std::min((int)((camera->GetPosition().x + halfwidth) / CANVAS_TILE_SIZE), m_TileColumns - 1);
+		int firstrow = std::max((int)((camera->GetPosition().y - halfheight) / CANVAS_TILE_SIZE), 0);
+		int lastrow = std::min((int)((camera->GetPosition().y + halfheight) / CANVAS_TILE_SIZE), m_TileRows - 1);
 
-		m_RedBike->SetPosition(RED_BIKE_START_POS);
-		m_RedBike->SetAngle(RED_BIKE_START_ROT);
-		m_RedVelocity = Vector2::Zero;
+		for (int row = firstrow; row <= lastrow; row++)
+		{
+			for (int column = firstcolumn; column <= lastcolumn; column++)
+			{
+				CanvasTile* tile = m_Tiles[row * m_TileColumns + column];
+				if (tile != nullptr)
+					Services::GetGraphics()->DrawTexture(tile->canvas, Vector2(column * CANVAS_TILE_SIZE, row * CANVAS_TILE_SIZE), 0.0f, 1.0f);
+			}
+		}
 
-		m_BlueBike->SetPosition(BLUE_BIKE_START_POS);
-		m_BlueBike->SetAngle(BLUE_BIKE_START_ROT);
-		m_BlueVelocity = Vector2::Zero;
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+		{
+			Vector2 position = GetBikePosition(player, alpha);
+			m_Segments[player]->SetPosition(position);
+			m_Segments[player]->Draw();
+		}
 
-		m_Notification->SetColor(Color::WhiteColor());
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+		{
+			m_Visuals[player]->SetPosition(GetBikePosition(player, alpha));
+			m_Visuals[player]->SetAngle(bikes.angle[player]);
+			m_Visuals[player]->Draw();
+		}
 
-		DeleteBikeSegments(m_RedBike);
-		DeleteBikeSegments(m_BlueBike);
-		AddInitialSegments();
+		// The notification stays in the middle of the screen.
+		camera->SetScale(Vector2(1.0f, 1.0f));
+		camera->SetPosition(Vector2(GetScreenWidth() * 0.5f, GetScreenHeight() * 0.5f));
 
-		m_timer.Reset();
-		m_timer.Start();
+		if (m_RoundState == RoundState::GameOver || m_RoundState == RoundState::Starting)
+			m_Notification->Draw();
 	}
 
-	void Game::StartRound()
+	void Game::Reset()
 	{
-		m_RoundState = RoundState::Running;
+		m_Sim->Reset();
+		m_Recorder->RecordReset();
+		m_PendingTurns.clear();
 
-		m_RedAlive = true;
-		m_BlueAlive = true;
+		m_RoundState = m_Sim->GetRoundState();
 
-		m_timer.Stop();
+		m_ShouldClearRender = true;
+
+		std::fill(m_DrawnRuns.begin(), m_DrawnRuns.end(), 0);
+		std::fill(m_DrawnDistance.begin(), m_DrawnDistance.end(), 0.0f);
 
-		Turn(Vector2(1.0f, 0.0f), m_RedBike, m_RedVelocity, RED_SEGMENT, 0);
-		Turn(Vector2(-1.0f, 0.0f), m_BlueBike, m_BlueVelocity, BLUE_SEGMENT, 0);
+		m_Notification->SetColor(Color::WhiteColor());
 	}
 
 	void Game::EndRound()
 	{
-		m_RoundState = RoundState::GameOver;
+		// The round ends with one bike left, or none if the last ones tied.
+		const BikeStates& bikes = m_Sim->GetBikes();
+		unsigned int winner = bikes.GetCount();
+
+		for (unsigned int player = 0; player < bikes.GetCount(); player++)
+		{
+			if (bikes.alive[player])
+				winner = player;
+		}
 
-		if (!m_RedAlive && !m_BlueAlive)
+		if (winner == bikes.GetCount())
 		{
 			m_Notification->SetColor(Color::WhiteColor());
 			m_Notification->SetText("Tie!");
 		}
-		else if (!m_RedAlive)
+		else if (winner == BLUE_PLAYER)
 		{
 			m_Notification->SetColor(Color::CyanColor());
 			m_Notification->SetText("Blue Bike Wins!");
 		}
-		else if (!m_BlueAlive)
+		else if (winner == RED_PLAYER)
 		{
 			m_Notification->SetColor(Color::RedColor());
 			m_Notification->SetText("Red Bike Wins");
 		}
+		else
+		{
+			m_Notification->SetColor(winner % 2 == 0 ? Color::RedColor() : Color::CyanColor());
+			m_Notification->SetText("Bike " + to_string(winner + 1) + " Wins!");
+		}
 	}
 
-	void Game::Turn(const Vector2& direction, Segment* bike, Vector2& bikevelocity, const string& segmentcolor, float angle)
+	void Game::DrawNewTrail(unsigned int player)
 	{
-		if (bikevelocity.DotProduct(direction) == 0.0f)
-		{
-			// Set the velocity
-			bikevelocity = direction * BIKE_SPEED;
-			bike->SetAngle(angle);
+		// The canvas keeps what was drawn on previous frames, only stamp the trail added since.
+		const TrailBuffer& trail = m_Sim->GetBikes().trail[player];
+		unsigned long long oldest = trail.GetAddedCount() - trail.GetCount();
 
-			AddSegment(bike, segmentcolor);
+		while (m_DrawnRuns[player] < trail.GetAddedCount())
+		{
+			const TrailRun& run = trail[(size_t)(m_DrawnRuns[player] - oldest)];
+			float length = ToPixels(run.GetLength());
+			float startx = ToPixels(run.startx);
+			float starty = ToPixels(run.starty);
+			float directionx = length > 0.0f ? (ToPixels(run.endx) - startx) / length : 0.0f;
+			float directiony = length > 0.0f ? (ToPixels(run.endy) - starty) / length : 0.0f;
+
+			for (; m_DrawnDistance[player] <= length; m_DrawnDistance[player] += TRAIL_STAMP_DISTANCE)
+				AddStamp(player, Vector2(startx + directionx * m_DrawnDistance[player], starty + directiony * m_DrawnDistance[player]));
+
+			// The newest run keeps growing, carry on from here next frame.
+			if (m_DrawnRuns[player] + 1 == trail.GetAddedCount())
+				break;
+
+			m_DrawnRuns[player]++;
+			m_DrawnDistance[player] = 0.0f;
 		}
 	}
 
-	void Game::AddInitialSegments()
+	Vector2 Game::GetBikePosition(unsigned int player, float alpha)
 	{
-		AddSegment(m_RedBike, RED_SEGMENT);
-		AddSegment(m_BlueBike, BLUE_SEGMENT);
+		const BikeStates& bikes = m_Sim->GetBikes();
+		return Vector2(bikes.previousx[player] + (bikes.x[player] - bikes.previousx[player]) * alpha,
+			bikes.previousy[player] + (bikes.y[player] - bikes.previousy[player]) * alpha);
 	}
 
-	void Game::AddSegment(Segment* bike, const string& segmentcolor)
+	void Game::FollowBikes(float alpha)
 	{
-		bike->LinkNext(new Segment(bike->GetPosition(), segmentcolor));
+		// Crashed bikes are kept in view too, the camera doesn't jump when a bike crashes.
+		float minx = FLT_MAX;
+		float miny = FLT_MAX;
+		float maxx = -FLT_MAX;
+		float maxy = -FLT_MAX;
+
+		for (unsigned int player = 0; player < m_Sim->GetPlayerCount(); player++)
+		{
+			Vector2 position = GetBikePosition(player, alpha);
+			minx = std::min(minx, position.x);
+			miny = std::min(miny, position.y);
+			maxx = std::max(maxx, position.x);
+			maxy = std::max(maxy, position.y);
+		}
+
+		float screenwidth = (float)GetScreenWidth();
+		float screenheight = (float)GetScreenHeight();
+		float zoom = std::max((maxx - minx + CAMERA_MARGIN * 2.0f) / screenwidth, (maxy - miny + CAMERA_MARGIN * 2.0f) / screenheight);
+		zoom = std::min(std::max(zoom, 1.0f), CAMERA_MAX_ZOOM_OUT);
+
+		// Keep the view inside the arena, centered on it if the view is larger.
+		float halfwidth = screenwidth * zoom * 0.5f;
+		float halfheight = screenheight * zoom * 0.5f;
+		float arenawidth = m_Sim->GetArenaWidth();
+		float arenaheight = m_Sim->GetArenaHeight();
+		float x = halfwidth * 2.0f >= arenawidth ? arenawidth * 0.5f : std::min(std::max((minx + maxx) * 0.5f, halfwidth), arenawidth - halfwidth);
+		float y = halfheight * 2.0f >= arenaheight ? arenaheight * 0.5f : std::min(std::max((miny + maxy) * 0.5f, halfheight), arenaheight - halfheight);
+
+		Camera* camera = Services::GetGraphics()->GetCamera();
+		camera->SetScale(Vector2(zoom, zoom));
+		camera->SetPosition(Vector2(x, y));
 	}
 
-	void Game::DeleteBikeSegments(Segment* bike)
+	void Game::HandleLeftMouseClick(float mouseX, float mouseY) { }
+
+	void Game::HandleRightMouseClick(float mouseX, float mouseY) { }
+
+	void Game::HandleKeyDown(Keyboard::Key key)
 	{
-		Segment* segment = bike->GetNext();
+		// Turns are taken as soon as the key goes down, waiting for its release would delay them by as long as it's held.
+		if (m_RoundState == RoundState::Running)
+		{
+			if (key == Keyboard::A)
+				QueueTurn(RED_PLAYER, Direction::Left);
+			else if (key == Keyboard::D)
+				QueueTurn(RED_PLAYER, Direction::Right);
+			else if (key == Keyboard::W)
+				QueueTurn(RED_PLAYER, Direction::Up);
+			else if (key == Keyboard::S)
+				QueueTurn(RED_PLAYER, Direction::Down);
+
+			if (key == Keyboard::Left)
+				QueueTurn(BLUE_PLAYER, Direction::Left);
+			else if (key == Keyboard::Right)
+				QueueTurn(BLUE_PLAYER, Direction::Right);
+			else if (key == Keyboard::Up)
+				QueueTurn(BLUE_PLAYER, Direction::Up);
+			else if (key == Keyboard::Down)
+				QueueTurn(BLUE_PLAYER, Direction::Down);
+		}
+	}
 
-		while (segment != nullptr)
+	void Game::HandleKeyPress(Keyboard::Key key)
+	{
+		if (m_RoundState == RoundState::GameOver && key == Keyboard::R)
+			Reset();
+		else if (m_RoundState == RoundState::GameOver && key == Keyboard::F)
 		{
-			Segment* next = segment->GetNext();
-			delete segment;
-			segment = next;
+			// Fading trails start with the next round, the replay records the limit with the reset.
+			m_Sim->SetTrailLimit(m_Sim->GetTrailLimit() > 0 ? 0 : FADING_TRAIL_RUNS);
+			m_Notification->SetText(m_Sim->GetTrailLimit() > 0 ? "Fading Trails On" : "Fading Trails Off");
 		}
 
-		bike->SetNext(nullptr);
+		if (key == Keyboard::One)
+			m_AI->SetPlayer(RED_PLAYER, !m_AI->IsPlayer(RED_PLAYER));
+		else if (key == Keyboard::Two)
+			m_AI->SetPlayer(BLUE_PLAYER, !m_AI->IsPlayer(BLUE_PLAYER));
 	}
 
-	void Game::CheckBikesIntersections()
+	void Game::AddStamp(unsigned int player, Vector2 position)
 	{
-		// Check if both bikes intersect.
-		if (m_RedBike->DoesIntersect(m_BlueBike))
+		// A stamp near the edge of a tile is cut in two, or four at a corner, each tile draws its part.
+		float halfwidth = m_Segments[player]->GetWidth() * 0.5f;
+		float halfheight = m_Segments[player]->GetHeight() * 0.5f;
+		int firstcolumn = std::max((int)floorf((position.x - halfwidth) / CANVAS_TILE_SIZE), 0);
+		int lastcolumn = std::min((int)floorf((position.x + halfwidth) / CANVAS_TILE_SIZE), m_TileColumns - 1);
+		int firstrow = std::max((int)floorf((position.y - halfheight) / CANVAS_TILE_SIZE), 0);
+		int lastrow = std::min((int)floorf((position.y + halfheight) / CANVAS_TILE_SIZE), m_TileRows - 1);
+
+		TrailStamp stamp;
+		stamp.player = player;
+		stamp.position = position;
+
+		for (int row = firstrow; row <= lastrow; row++)
 		{
-			m_RedAlive = false;
-			m_BlueAlive = false;
-			return;
+			for (int column = firstcolumn; column <= lastcolumn; column++)
+			{
+				stamp.tile = row * m_TileColumns + column;
+				m_Stamps.push_back(stamp);
+			}
 		}
+	}
 
-		// Check if both bikes are within screen boundaries.
-		Vector2 redpos = m_RedBike->GetPosition();
-		Vector2 bluepos = m_BlueBike->GetPosition();
-
-		if (redpos.x < 0 || redpos.x > GetScreenWidth() || redpos.y < 0 || redpos.y > GetScreenHeight())
-			m_RedAlive = false;
-		if (bluepos.x < 0 || bluepos.x > GetScreenWidth() || bluepos.y < 0 || bluepos.y > GetScreenHeight())
-			m_BlueAlive = false;
+	void Game::DrawStamps()
+	{
+		// Each tile is a render target of its own, draw all of a tile's stamps while it's bound.
+		std::stable_sort(m_Stamps.begin(), m_Stamps.end(), [](const TrailStamp& a, const TrailStamp& b) { return a.tile < b.tile; });
 
-		if (m_RedAlive)
+		for (size_t first = 0; first < m_Stamps.size();)
 		{
-			// Check if the red bike intersects with any blue segments.
-			Segment* segment = m_BlueBike->GetNext();
+			unsigned int index = m_Stamps[first].tile;
+			CanvasTile* tile = m_Tiles[index];
 
-			while (segment != nullptr)
+			if (tile == nullptr)
 			{
-				if (m_RedBike->DoesIntersect(segment))
+				if (m_FreeTiles.empty())
 				{
-					m_RedAlive = false;
-					break;
-				}
-				segment = segment->GetNext();
-			}
-
-			if (m_RedAlive)
-			{
-				// Check if the red bike intersects with its own segments.
-				int ignorecount = 0;
-				segment = m_RedBike->GetNext();
+					PixelFormat pixelformat(PixelFormat::RGBA, PixelFormat::UnsignedByte);
+					ImageData imagedata(pixelformat, (unsigned int)CANVAS_TILE_SIZE, (unsigned int)CANVAS_TILE_SIZE);
 
-				while (segment != nullptr)
+					tile = new CanvasTile();
+					tile->canvas = new Texture(imagedata);
+					tile->rendertarget = new RenderTarget(tile->canvas);
+				}
+				else
 				{
-					ignorecount++;
-
-					if (ignorecount >= NEW_SEGMENT_IGNORE_COUNT && m_RedBike->DoesIntersect(segment))
-					{
-						m_RedAlive = false;
-						break;
-					}
-					segment = segment->GetNext();
+					tile = m_FreeTiles.back();
+					m_FreeTiles.pop_back();
 				}
+
+				tile->iscleared = false;
+				m_Tiles[index] = tile;
+				m_UsedTiles.push_back(index);
 			}
-		}
 
-		if (m_BlueAlive)
-		{
-			// Check if the blue bike intersects with any red segments.
-			Segment* segment = m_RedBike->GetNext();
+			// The render target's view starts at the tile's corner.
+			Vector2 origin((index % m_TileColumns) * CANVAS_TILE_SIZE, (index / m_TileColumns) * CANVAS_TILE_SIZE);
+			tile->rendertarget->Begin(!tile->iscleared);
+			tile->iscleared = true;
 
-			while (segment != nullptr)
+			size_t last = first;
+			for (; last < m_Stamps.size() && m_Stamps[last].tile == index; last++)
 			{
-				if (m_BlueBike->DoesIntersect(segment))
-				{
-					m_BlueAlive = false;
-					break;
-				}
-				segment = segment->GetNext();
+				Sprite* segment = m_Segments[m_Stamps[last].player];
+				segment->SetPosition(Vector2(m_Stamps[last].position.x - origin.x, m_Stamps[last].position.y - origin.y));
+				segment->Draw();
 			}
 
-			if (m_BlueAlive)
-			{
-				// Check if the blue bike intersects with its own segments.
-				int ignorecount = 0;
-				segment = m_BlueBike->GetNext();
-
-				while (segment != nullptr)
-				{
-					ignorecount++;
-
-					if (ignorecount >= NEW_SEGMENT_IGNORE_COUNT && m_BlueBike->DoesIntersect(segment))
-					{
-						m_BlueAlive = false;
-						break;
-					}
-					segment = segment->GetNext();
-				}
-			}
+			tile->rendertarget->End();
+			first = last;
 		}
+
+		m_Stamps.clear();
 	}
 
-	bool Game::IsBikeAddingSegment(Segment* bike)
+	void Game::ClearTiles()
 	{
-		Vector2 bikepos = bike->GetPosition();
-		Vector2 nextpos = bike->GetNext()->GetPosition();
-		Vector2 difference = Vector2(fabsf(bikepos.x - nextpos.x), fabsf(bikepos.y - nextpos.y));
+		for (unsigned int index : m_UsedTiles)
+		{
+			m_FreeTiles.push_back(m_Tiles[index]);
+			m_Tiles[index] = nullptr;
+		}
 
-		return difference.x >= MIN_SEGMENT_DISTANCE || difference.y >= MIN_SEGMENT_DISTANCE;
+		m_UsedTiles.clear();
 	}
 
-	void Game::HandleLeftMouseClick(float mouseX, float mouseY) { }
-
-	void Game::HandleRightMouseClick(float mouseX, float mouseY) { }
-
-	void Game::HandleKeyPress(Keyboard::Key key)
+	void Game::QueueTurn(unsigned int player, Direction direction)
 	{
-		if (m_RoundState == RoundState::Running)
-		{
-			if (key == Keyboard::A)
-				Turn(Vector2(-1.0f, 0.0f), m_RedBike, m_RedVelocity, RED_SEGMENT, 0);
-			else if (key == Keyboard::D)
-				Turn(Vector2(1.0f, 0.0f), m_RedBike, m_RedVelocity, RED_SEGMENT, 180);
-			else if (key == Keyboard::W)
-				Turn(Vector2(0.0f, 1.0f), m_RedBike, m_RedVelocity, RED_SEGMENT, -90);
-			else if (key == Keyboard::S)
-				Turn(Vector2(0.0f, -1.0f), m_RedBike, m_RedVelocity, RED_SEGMENT, 90);
-
-			if (key == Keyboard::Left)
-				Turn(Vector2(-1.0f, 0.0f), m_BlueBike, m_BlueVelocity, BLUE_SEGMENT, 0);
-			else if (key == Keyboard::Right)
-				Turn(Vector2(1.0f, 0.0f), m_BlueBike, m_BlueVelocity, BLUE_SEGMENT, 180);
-			else if (key == Keyboard::Up)
-				Turn(Vector2(0.0f, 1.0f), m_BlueBike, m_BlueVelocity, BLUE_SEGMENT, -90);
-			else if (key == Keyboard::Down)
-				Turn(Vector2(0.0f, -1.0f), m_BlueBike, m_BlueVelocity, BLUE_SEGMENT, 90);
-		}
-		else if (m_RoundState == RoundState::GameOver && key == Keyboard::R)
-			Reset();
+		// The AI's bikes ignore the keys.
+		if (m_AI->IsPlayer(player)) return;
+
+		// The turn is placed where the bike was when the key was pressed, not where it is now.
+		PendingTurn pending;
+		pending.input.player = player;
+		pending.input.direction = direction;
+		pending.input.time = 0.0f;
+		pending.presstime = GetKeyPressTime();
+		m_PendingTurns.push_back(pending);
 	}
 }
\ No newline at end of file
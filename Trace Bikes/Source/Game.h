@@ -1,36 +1,52 @@
 #pragma once
 
 #include <GameDev2D.h>
-#include "Timer.h"
+#include "TraceSim/TraceSim.h"
+#include "TraceSim/AIController.h"
+#include "TraceSim/Replay.h"
 #include <string.h>
 
 namespace GameDev2D
 {
-	const int RED_BIKE_START_ROT = 180;
-	const int BLUE_BIKE_START_ROT = 0;
-
-	const float BIKE_SPEED = 250.0f;
-	const float MIN_SEGMENT_DISTANCE = 8.0f; // Minimum distance between segments place by bikes.
-	const float NEW_SEGMENT_IGNORE_COUNT = 10;
-
 	const string RED_SEGMENT = "RedSegment";
 	const string BLUE_SEGMENT = "BlueSegment";
 	const string RED_BIKE = "RedBike";
 	const string BLUE_BIKE = "BlueBike";
 
-	const Vector2 RED_BIKE_START_POS = Vector2(23.0f, 9.0f);
-	const Vector2 BLUE_BIKE_START_POS = Vector2(WINDOW_WIDTH - 23.0f, WINDOW_HEIGHT - 9.0f);
+	const float TRAIL_STAMP_DISTANCE = 8.0f; // The trail runs are drawn by stamping the segment sprite along them.
+	const float CANVAS_TILE_SIZE = 512.0f; // The trails are drawn to tiles of the arena, each allocated once a trail reaches it.
+
+	const unsigned int ARENA_SCREENS = 3; // The arena is this many screens wide and high, the camera follows the bikes around it.
+	const float CAMERA_MARGIN = 96.0f; // Kept between the bikes and the edges of the screen, zooming out if need be.
+	const float CAMERA_MAX_ZOOM_OUT = (float)ARENA_SCREENS; // Far enough to see the whole arena.
+	const unsigned int FADING_TRAIL_RUNS = 8; // Runs a trail keeps in the fading trails mode, toggled with F between rounds.
 
-	enum class RoundState
+	// A tile of the trail canvas.
+	struct CanvasTile
 	{
-		Unknown,
-		Starting,
-		Running,
-		GameOver,
+		Texture* canvas;
+		RenderTarget* rendertarget;
+		bool iscleared; // A tile is cleared the first time it's drawn to after it was taken, it may hold an old trail.
 	};
 
-	class Segment;
+	// A segment sprite stamped on a tile this frame, at a position in the arena.
+	struct TrailStamp
+	{
+		unsigned int tile;
+		unsigned int player;
+		Vector2 position;
+	};
 
+	// A turn waiting for the step that simulates the time its key was pressed.
+	struct PendingTurn
+	{
+		TurnInput input;
+		double presstime;
+	};
+
+	// Renders a TraceSim match and feeds it the player's key presses, or the AI's turns for the bikes handed to it
+	// with 1 and 2. The arena is larger than the screen, the trails are drawn to tiles that are only allocated where
+	// the trails are, and only the tiles on screen are drawn. The camera keeps every bike in view.
 	class Game
 	{
 	public:
@@ -41,46 +57,59 @@ namespace GameDev2D
 		void Draw();
 		void Reset();
 
-		void StartRound();
 		void EndRound();
 
-		void Turn(const Vector2& direction, Segment* bike, Vector2& bikevelocity, const string& segmentcolor, float angle);
-
-		void AddInitialSegments();
-		void AddSegment(Segment* bike, const string& segmentcolor);
-		void DeleteBikeSegments(Segment* bike);
+		void DrawNewTrail(unsigned int player);
+		Vector2 GetBikePosition(unsigned int player, float alpha);
 
-		void CheckBikesIntersections();
-
-		bool IsBikeAddingSegment(Segment* bike);
+		// Centers the camera on the bikes, zooming out as far as it needs to keep them all on screen, without
+		// showing anything past the arena's edges.
+		void FollowBikes(float alpha);
 
 		void HandleLeftMouseClick(float mouseX, float mouseY);
 		void HandleRightMouseClick(float mouseX, float mouseY);
+		void HandleKeyDown(Keyboard::Key key);
 		void HandleKeyPress(Keyboard::Key key);
 	private:
-		bool m_RedAlive;
-		bool m_BlueAlive;
-		bool m_ShouldClearRender;
+		void QueueTurn(unsigned int player, Direction direction);
 
-		RoundState m_RoundState;
+		// Queues the segment sprite stamped at a position on every tile it overlaps.
+		void AddStamp(unsigned int player, Vector2 position);
 
-		Timer m_timer;
+		// Draws the frame's stamps to their tiles, a tile at a time, allocating the tiles they reach first.
+		void DrawStamps();
 
-		Segment* m_RedBike;
-		Segment* m_BlueBike;
+		// Hands every tile back to the free tiles, to draw the trails again from the start.
+		void ClearTiles();
 
-		Vector2 m_RedVelocity;
-		Vector2 m_BlueVelocity;
+		bool m_ShouldClearRender;
 
-		Sprite* m_RedVisual;
-		Sprite* m_BlueVisual;
+		TraceSim* m_Sim;
+		ReplayRecorder* m_Recorder;
+		AIController* m_AI;
+		std::vector<PendingTurn> m_PendingTurns;
+		std::vector<TurnInput> m_StepTurns;
 
-		Label* m_Notification;
+		RoundState m_RoundState;
+
+		// How much of the trails is already drawn to the canvas, the added count of the run being drawn and the
+		// distance along it of the next stamp.
+		std::vector<unsigned long long> m_DrawnRuns;
+		std::vector<float> m_DrawnDistance;
 
-		Texture* m_Canvas;
-		Texture* m_CanvasPath;
+		// Per player, even players are red and odd players blue.
+		std::vector<Sprite*> m_Segments;
+		std::vector<Sprite*> m_Visuals;
+
+		Label* m_Notification;
 
-		RenderTarget* m_RenderTarget;
-		RenderTarget* m_RenderPath;
+		// Per tile of the arena, nullptr until a trail is drawn over it. The tiles a clear takes back are kept to be
+		// reused, the canvas holds as many tiles as the trails have covered at most.
+		std::vector<CanvasTile*> m_Tiles;
+		std::vector<CanvasTile*> m_FreeTiles;
+		std::vector<unsigned int> m_UsedTiles;
+		std::vector<TrailStamp> m_Stamps;
+		int m_TileColumns;
+		int m_TileRows;
 	};
 }
@@ -0,0 +1,164 @@
+#include "AIController.h"
+
+namespace GameDev2D
+{
+	AIController::AIController(const TraceSim& sim, double tickbudget) :
+		m_Posted(sim),
+		m_HasPosted(false),
+		m_IsStopping(false),
+		m_IsAI(sim.GetPlayerCount(), 0),
+		m_Searched(sim),
+		m_SearchedIsAI(sim.GetPlayerCount(), 0),
+		m_AI(sim),
+		m_DecidedColumns(sim.GetPlayerCount(), -1),
+		m_DecidedRows(sim.GetPlayerCount(), -1),
+		m_DecidedDirectionX(sim.GetPlayerCount(), 0),
+		m_DecidedDirectionY(sim.GetPlayerCount(), 0),
+		m_TickBudget(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickbudget))),
+		m_SearchCount(0),
+		m_DepthSum(0),
+		m_WorstOverrun(0)
+	{
+		m_Thread = std::thread(&AIController::Run, this);
+	}
+
+	AIController::~AIController()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_StatePosted.notify_one();
+		m_Thread.join();
+	}
+
+	void AIController::SetPlayer(unsigned int player, bool isai)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsAI[player] = isai ? 1 : 0;
+	}
+
+	bool AIController::IsPlayer(unsigned int player) const
+	{
+		return m_IsAI[player] != 0;
+	}
+
+	void AIController::Post(const TraceSim& sim)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Posted.Take(sim);
+			m_HasPosted = true;
+		}
+		m_StatePosted.notify_one();
+	}
+
+	void AIController::TakeTurns(const TraceSim& sim, std::vector<TurnInput>& turns)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (const Decision& decision : m_Decisions)
+		{
+			unsigned int player = decision.input.player;
+			if (!m_IsAI[player] || !bikes.alive[player] || sim.GetRoundState() != RoundState::Running) continue;
+			if (bikes.directionx[player] != decision.directionx || bikes.directiony[player] != decision.directiony) continue;
+
+			turns.push_back(decision.input);
+		}
+		m_Decisions.clear();
+	}
+
+	unsigned long long AIController::GetSearchCount() const
+	{
+		return m_SearchCount.load();
+	}
+
+	double AIController::GetAverageDepth() const
+	{
+		unsigned long long searches = m_SearchCount.load();
+		return searches > 0 ? (double)m_DepthSum.load() / searches : 0.0;
+	}
+
+	double AIController::GetWorstOverrun() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::duration(m_WorstOverrun.load())).count();
+	}
+
+	void AIController::Run()
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_StatePosted.wait(lock, [this] { return m_IsStopping || m_HasPosted; });
+				if (m_IsStopping) return;
+
+				// Swapped rather than copied, the game takes its next state into the one searched last.
+				std::swap(m_Posted, m_Searched);
+				m_SearchedIsAI = m_IsAI;
+				m_HasPosted = false;
+			}
+
+			Decide();
+		}
+	}
+
+	void AIController::Decide()
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		const AISnapshot& snapshot = m_Searched;
+
+		// Each bike decides once per cell, a new round starts every bike over.
+		m_Deciding.clear();
+		for (unsigned int player = 0; player < snapshot.alive.size(); player++)
+		{
+			if (snapshot.roundstate != RoundState::Running)
+			{
+				m_DecidedColumns[player] = -1;
+				continue;
+			}
+
+			if (!m_SearchedIsAI[player] || !snapshot.alive[player]) continue;
+			if (snapshot.columns[player] == m_DecidedColumns[player] && snapshot.rows[player] == m_DecidedRows[player] &&
+				snapshot.directionx[player] == m_DecidedDirectionX[player] && snapshot.directiony[player] == m_DecidedDirectionY[player]) continue;
+
+			m_Deciding.push_back(player);
+		}
+		if (m_Deciding.empty()) return;
+
+		// The bikes share the tick's budget, each gets an even share of what the ones before it left.
+		Clock::time_point tickdeadline = Clock::now() + m_TickBudget;
+
+		for (unsigned int index = 0; index < m_Deciding.size(); index++)
+		{
+			unsigned int player = m_Deciding[index];
+			Clock::time_point now = Clock::now();
+			Clock::time_point deadline = now + (tickdeadline - now) / (long long)(m_Deciding.size() - index);
+
+			Decision decision;
+			decision.input.player = player;
+			decision.input.time = 0.0f;
+			decision.directionx = snapshot.directionx[player];
+			decision.directiony = snapshot.directiony[player];
+
+			if (m_AI.ChooseTurn(snapshot, player, deadline, decision.input.direction))
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Decisions.push_back(decision);
+			}
+
+			m_DecidedColumns[player] = snapshot.columns[player];
+			m_DecidedRows[player] = snapshot.rows[player];
+			m_DecidedDirectionX[player] = snapshot.directionx[player];
+			m_DecidedDirectionY[player] = snapshot.directiony[player];
+			m_SearchCount++;
+			m_DepthSum += m_AI.GetLastDepth();
+		}
+
+		long long overrun = (long long)(Clock::now() - tickdeadline).count();
+		if (overrun > m_WorstOverrun.load())
+			m_WorstOverrun = overrun;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "BikeAI.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GameDev2D
+{
+	// Drives the AI bikes of a match from a worker thread, so their searches never hold up a frame. The game posts
+	// the sim's state after every step without waiting on the worker, which searches the newest state it was
+	// given for every AI bike that entered a new cell since its last decision, within one tick's budget split
+	// between them. The turns it decides are handed back to be fed to a later step, the same way as key presses.
+	class AIController
+	{
+	public:
+		AIController(const TraceSim& sim, double tickbudget = AI_TICK_BUDGET);
+		~AIController();
+
+		// Hands a player's bike to the AI, or back to the keyboard.
+		void SetPlayer(unsigned int player, bool isai);
+		bool IsPlayer(unsigned int player) const;
+
+		// Call after every step, the worker searches the newest state posted and skips the ones it missed.
+		void Post(const TraceSim& sim);
+
+		// Adds the turns decided since the last call. Turns for a bike that has turned or crashed since the state
+		// they were searched from are dropped.
+		void TakeTurns(const TraceSim& sim, std::vector<TurnInput>& turns);
+
+		// Searches run so far and the average depth they finished.
+		unsigned long long GetSearchCount() const;
+		double GetAverageDepth() const;
+
+		// The longest a tick's searches ran past the tick's budget, in seconds.
+		double GetWorstOverrun() const;
+
+	private:
+		// A turn, with the heading the bike had in the state it was searched from.
+		struct Decision
+		{
+			TurnInput input;
+			int directionx;
+			int directiony;
+		};
+
+		void Run();
+		void Decide();
+
+		std::thread m_Thread;
+		std::mutex m_Mutex; // Guards everything the game and the worker share, down to m_Decisions.
+		std::condition_variable m_StatePosted;
+		AISnapshot m_Posted;
+		bool m_HasPosted;
+		bool m_IsStopping;
+		std::vector<unsigned char> m_IsAI;
+		std::vector<Decision> m_Decisions;
+
+		// The worker's own, swapped with m_Posted when it wakes.
+		AISnapshot m_Searched;
+		std::vector<unsigned char> m_SearchedIsAI;
+		BikeAI m_AI;
+		std::vector<int> m_DecidedColumns; // The cell and heading of each bike at its last decision.
+		std::vector<int> m_DecidedRows;
+		std::vector<int> m_DecidedDirectionX;
+		std::vector<int> m_DecidedDirectionY;
+		std::vector<unsigned int> m_Deciding;
+		std::chrono::steady_clock::duration m_TickBudget;
+
+		std::atomic<unsigned long long> m_SearchCount;
+		std::atomic<unsigned long long> m_DepthSum;
+		std::atomic<long long> m_WorstOverrun; // In steady clock ticks.
+	};
+}
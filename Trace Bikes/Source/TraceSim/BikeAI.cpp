@@ -0,0 +1,262 @@
+#include "BikeAI.h"
+#include <stdlib.h>
+
+namespace GameDev2D
+{
+	const int AI_WIN_SCORE = 1000000; // Crashes are scored past any territory, sooner ones count more.
+	const int AI_DRAW_SCORE = 0;
+	const int AI_MOVE_COUNT = 3; // Straight on, turn left, turn right.
+
+	static bool IsDecided(int score)
+	{
+		return abs(score) > AI_WIN_SCORE / 2;
+	}
+
+	AISnapshot::AISnapshot(const TraceSim& sim) :
+		arena(sim.GetArena()),
+		roundstate(RoundState::Unknown)
+	{
+		Take(sim);
+	}
+
+	void AISnapshot::Take(const TraceSim& sim)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		unsigned int count = bikes.GetCount();
+
+		arena.CopyCells(sim.GetArena());
+		columns.resize(count);
+		rows.resize(count);
+		for (unsigned int player = 0; player < count; player++)
+		{
+			columns[player] = (int)(bikes.x[player] / ARENA_CELL_SIZE);
+			rows[player] = (int)(bikes.y[player] / ARENA_CELL_SIZE);
+		}
+		directionx = bikes.directionx;
+		directiony = bikes.directiony;
+		alive = bikes.alive;
+		roundstate = sim.GetRoundState();
+	}
+
+	BikeAI::BikeAI(const TraceSim& sim) :
+		m_Arena(sim.GetArena()),
+		m_HasOpponent(false),
+		m_IsOutOfTime(false),
+		m_RootMove(0),
+		m_LastDepth(0),
+		m_Evaluations(0)
+	{
+	}
+
+	bool BikeAI::ChooseTurn(const AISnapshot& snapshot, unsigned int player, std::chrono::steady_clock::time_point deadline, Direction& direction)
+	{
+		m_LastDepth = 0;
+		m_Evaluations = 0;
+		if (snapshot.roundstate != RoundState::Running || !snapshot.alive[player]) return false;
+
+		m_Arena.CopyCells(snapshot.arena);
+		m_Bikes[0].column = snapshot.columns[player];
+		m_Bikes[0].row = snapshot.rows[player];
+		m_Bikes[0].directionx = snapshot.directionx[player];
+		m_Bikes[0].directiony = snapshot.directiony[player];
+
+		// The opponent is the nearest bike, the others only claim territory.
+		unsigned int opponent = player;
+		int nearest = INT_MAX;
+		for (unsigned int other = 0; other < snapshot.alive.size(); other++)
+		{
+			if (other == player || !snapshot.alive[other]) continue;
+
+			int distance = abs(snapshot.columns[other] - m_Bikes[0].column) + abs(snapshot.rows[other] - m_Bikes[0].row);
+			if (distance < nearest)
+			{
+				nearest = distance;
+				opponent = other;
+			}
+		}
+
+		m_HasOpponent = opponent != player;
+		m_SourceColumns.assign(1, m_Bikes[0].column);
+		m_SourceRows.assign(1, m_Bikes[0].row);
+		if (m_HasOpponent)
+		{
+			m_Bikes[1].column = snapshot.columns[opponent];
+			m_Bikes[1].row = snapshot.rows[opponent];
+			m_Bikes[1].directionx = snapshot.directionx[opponent];
+			m_Bikes[1].directiony = snapshot.directiony[opponent];
+			m_SourceColumns.push_back(m_Bikes[1].column);
+			m_SourceRows.push_back(m_Bikes[1].row);
+		}
+
+		for (unsigned int other = 0; other < snapshot.alive.size(); other++)
+		{
+			if (other == player || other == opponent || !snapshot.alive[other]) continue;
+
+			m_SourceColumns.push_back(snapshot.columns[other]);
+			m_SourceRows.push_back(snapshot.rows[other]);
+		}
+		m_Territories.resize(m_SourceColumns.size());
+
+		// Until a search finishes, keep going straight unless that crashes.
+		int best = 0;
+		for (int move = 0; move < AI_MOVE_COUNT; move++)
+		{
+			SearchBike next = Move(m_Bikes[0], move);
+			if (m_Arena.IsOpen(next.column, next.row))
+			{
+				best = move;
+				break;
+			}
+		}
+
+		m_IsOutOfTime = false;
+		m_RootMove = best;
+
+		for (unsigned int depth = 1; depth <= AI_MAX_DEPTH; depth++)
+		{
+			// The first search always finishes, with the territories counted near the bikes it's a few positions
+			// that take microseconds each, so even a bike left no time by the others looks a move ahead.
+			m_Deadline = depth == 1 ? std::chrono::steady_clock::time_point::max() : deadline;
+
+			int score = Search(depth, 0, -AI_WIN_SCORE * 2, AI_WIN_SCORE * 2);
+			if (m_IsOutOfTime) break;
+
+			best = m_RootMove;
+			m_LastDepth = depth;
+
+			// Deeper searches can't change a crash that can't be avoided or can't be escaped.
+			if (IsDecided(score)) break;
+		}
+
+		if (best == 0) return false;
+
+		SearchBike next = Move(m_Bikes[0], best);
+		if (next.directionx != 0)
+			direction = next.directionx < 0 ? Direction::Left : Direction::Right;
+		else
+			direction = next.directiony > 0 ? Direction::Up : Direction::Down;
+		return true;
+	}
+
+	unsigned int BikeAI::GetLastDepth() const
+	{
+		return m_LastDepth;
+	}
+
+	unsigned int BikeAI::GetLastEvaluations() const
+	{
+		return m_Evaluations;
+	}
+
+	int BikeAI::Search(unsigned int depth, unsigned int ply, int alpha, int beta)
+	{
+		if (std::chrono::steady_clock::now() >= m_Deadline)
+		{
+			m_IsOutOfTime = true;
+			return 0;
+		}
+
+		if (depth == 0)
+			return Evaluate();
+
+		// The bikes move in turn, the searching bike first, but a round of moves is played out as if they moved
+		// together: the opponent moving into the cell the bike just took is a crash for both.
+		bool ismaximizing = ply % 2 == 0;
+		SearchBike& bike = m_Bikes[ismaximizing ? 0 : 1];
+
+		// The best move of the last search first at the root, straight on first everywhere else.
+		int moves[AI_MOVE_COUNT] = { 0, 1, 2 };
+		if (ply == 0 && m_RootMove != 0)
+		{
+			moves[0] = m_RootMove;
+			moves[m_RootMove] = 0;
+		}
+
+		int bestscore = ismaximizing ? -AI_WIN_SCORE * 2 : AI_WIN_SCORE * 2;
+		int bestmove = moves[0];
+
+		for (int move : moves)
+		{
+			SearchBike next = Move(bike, move);
+			int score;
+
+			if (!ismaximizing && next.column == m_Bikes[0].column && next.row == m_Bikes[0].row)
+			{
+				score = AI_DRAW_SCORE;
+			}
+			else if (!m_Arena.IsOpen(next.column, next.row))
+			{
+				score = ismaximizing ? -AI_WIN_SCORE + (int)ply : AI_WIN_SCORE - (int)ply;
+			}
+			else
+			{
+				SearchBike previous = bike;
+				bike = next;
+				m_Arena.SetOpen(next.column, next.row, false);
+
+				// Without an opponent every ply is the bike's own move.
+				if (!m_HasOpponent)
+					score = Search(depth - 1, ply + 2, alpha, beta);
+				else
+					score = Search(ismaximizing ? depth : depth - 1, ply + 1, alpha, beta);
+
+				m_Arena.SetOpen(next.column, next.row, true);
+				bike = previous;
+			}
+
+			if (m_IsOutOfTime) return 0;
+
+			if (ismaximizing ? score > bestscore : score < bestscore)
+			{
+				bestscore = score;
+				bestmove = move;
+			}
+
+			if (ismaximizing)
+				alpha = score > alpha ? score : alpha;
+			else
+				beta = score < beta ? score : beta;
+			if (alpha >= beta) break;
+		}
+
+		if (ply == 0)
+			m_RootMove = bestmove;
+		return bestscore;
+	}
+
+	int BikeAI::Evaluate()
+	{
+		m_Evaluations++;
+
+		m_SourceColumns[0] = m_Bikes[0].column;
+		m_SourceRows[0] = m_Bikes[0].row;
+		if (m_HasOpponent)
+		{
+			m_SourceColumns[1] = m_Bikes[1].column;
+			m_SourceRows[1] = m_Bikes[1].row;
+		}
+
+		m_Arena.GetTerritory(m_SourceColumns.data(), m_SourceRows.data(), (unsigned int)m_SourceColumns.size(), m_Territories.data(), AI_TERRITORY_STEPS);
+		return (int)m_Territories[0] - (m_HasOpponent ? (int)m_Territories[1] : 0);
+	}
+
+	BikeAI::SearchBike BikeAI::Move(const SearchBike& bike, int move)
+	{
+		// Left and right are a quarter turn either way, with rows counting up the arena.
+		SearchBike next = bike;
+		if (move == 1)
+		{
+			next.directionx = -bike.directiony;
+			next.directiony = bike.directionx;
+		}
+		else if (move == 2)
+		{
+			next.directionx = bike.directiony;
+			next.directiony = -bike.directionx;
+		}
+
+		next.column += next.directionx;
+		next.row += next.directiony;
+		return next;
+	}
+}
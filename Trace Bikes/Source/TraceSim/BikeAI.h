@@ -0,0 +1,87 @@
+#pragma once
+
+#include "TraceSim.h"
+#include <chrono>
+#include <vector>
+
+namespace GameDev2D
+{
+	const double AI_TICK_BUDGET = 0.0005; // Seconds of search per tick, shared by every AI bike deciding in it.
+	const unsigned int AI_MAX_DEPTH = 24; // Moves per bike, the search stops deepening here even with time left.
+	const unsigned int AI_TERRITORY_STEPS = 8; // Cells around the bikes a position's territory is counted within.
+
+	// What an AI searches: which cells of the arena are open, and every bike's cell and heading. Taken from the sim
+	// after a step, it's all the search needs, so it can run on another thread while the sim steps on.
+	struct AISnapshot
+	{
+		AISnapshot(const TraceSim& sim);
+
+		// Copies the sim's state into the snapshot, without allocating once it's the sim's size.
+		void Take(const TraceSim& sim);
+
+		BitboardArena arena;
+		std::vector<int> columns;
+		std::vector<int> rows;
+		std::vector<int> directionx;
+		std::vector<int> directiony;
+		std::vector<unsigned char> alive;
+		RoundState roundstate;
+	};
+
+	// Picks turns for a bike by searching its moves a cell at a time. The bike plays against the nearest bike
+	// still alive, the others are left where they are, and the positions at the end of the search are scored by
+	// how much more of the arena near the bikes the bike reaches before its opponent than the other way around.
+	// The search deepens a move at a time until the deadline, the move of the deepest search that finished is
+	// played. The deadline is checked at every position. Scoring one only reads and clears the cells within
+	// AI_TERRITORY_STEPS of the bikes, so it costs the same on any size of arena, only the copy of the arena at the
+	// start of each search grows with it.
+	class BikeAI
+	{
+	public:
+		BikeAI(const TraceSim& sim);
+
+		// Searches the snapshot for the player's next move. Returns false if the bike should keep going straight.
+		bool ChooseTurn(const AISnapshot& snapshot, unsigned int player, std::chrono::steady_clock::time_point deadline, Direction& direction);
+
+		// The depth of the deepest search the last ChooseTurn finished, at least 1 unless the bike wasn't searched.
+		unsigned int GetLastDepth() const;
+
+		// Positions scored by the last ChooseTurn.
+		unsigned int GetLastEvaluations() const;
+
+	private:
+		// A bike in the search, moving a cell at a time.
+		struct SearchBike
+		{
+			int column;
+			int row;
+			int directionx;
+			int directiony;
+		};
+
+		// Returns the score of the position for the searching bike, with the bike to move at even plies and its
+		// opponent at odd ones, or sets m_IsOutOfTime and returns 0 once the deadline has passed.
+		int Search(unsigned int depth, unsigned int ply, int alpha, int beta);
+
+		// The cells reached first by the searching bike, minus the cells reached first by its opponent.
+		int Evaluate();
+
+		// The bike a cell on, straight on for move 0, after turning left for 1 and right for 2.
+		static SearchBike Move(const SearchBike& bike, int move);
+
+		BitboardArena m_Arena;
+		SearchBike m_Bikes[2]; // The searching bike and its opponent.
+		bool m_HasOpponent;
+
+		// Sources for the territory split, both bikes first, then the others, which don't move during a search.
+		std::vector<int> m_SourceColumns;
+		std::vector<int> m_SourceRows;
+		std::vector<unsigned int> m_Territories;
+
+		std::chrono::steady_clock::time_point m_Deadline;
+		bool m_IsOutOfTime;
+		int m_RootMove; // The best move at the root of the search running now.
+		unsigned int m_LastDepth;
+		unsigned int m_Evaluations;
+	};
+}
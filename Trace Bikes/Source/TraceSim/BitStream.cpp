@@ -0,0 +1,41 @@
+#include "BitStream.h"
+
+namespace GameDev2D
+{
+	BitWriter::BitWriter(std::vector<unsigned char>& buffer) :
+		m_Buffer(buffer),
+		m_StartSize(buffer.size()),
+		m_Bits(0),
+		m_BitCount(0)
+	{
+	}
+
+	void BitWriter::Flush()
+	{
+		if (m_BitCount > 0)
+			m_Buffer.push_back((unsigned char)m_Bits);
+
+		m_Bits = 0;
+		m_BitCount = 0;
+	}
+
+	size_t BitWriter::GetBitCount() const
+	{
+		return (m_Buffer.size() - m_StartSize) * 8 + m_BitCount;
+	}
+
+	BitReader::BitReader(const unsigned char* data, size_t size) :
+		m_Data(data),
+		m_Size(size),
+		m_Position(0),
+		m_Bits(0),
+		m_BitCount(0),
+		m_IsOverrun(false)
+	{
+	}
+
+	bool BitReader::IsOverrun() const
+	{
+		return m_IsOverrun;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	// Packs values into a byte buffer a few bits at a time, the first value in the lowest bits of the first byte.
+	// Varints are written in groups of a few bits, each followed by a bit saying wether another group follows, so
+	// small values take a group and large ones only as many as they need. Signed values are zigzagged first, small
+	// negative values stay small.
+	class BitWriter
+	{
+	public:
+		// Appends to the buffer, which must outlive the writer.
+		BitWriter(std::vector<unsigned char>& buffer);
+
+		// Defined here, a snapshot writes a few of these per bike.
+		void WriteBits(unsigned int value, unsigned int count)
+		{
+			m_Bits |= (unsigned long long)(value & (unsigned int)((1ull << count) - 1)) << m_BitCount;
+			m_BitCount += count;
+
+			while (m_BitCount >= 8)
+			{
+				m_Buffer.push_back((unsigned char)m_Bits);
+				m_Bits >>= 8;
+				m_BitCount -= 8;
+			}
+		}
+
+		void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+
+		void WriteVarint(unsigned long long value, unsigned int groupbits)
+		{
+			unsigned long long more = value >> groupbits;
+			WriteBits((unsigned int)value, groupbits);
+			WriteBool(more != 0);
+
+			while (more != 0)
+			{
+				value = more;
+				more = value >> groupbits;
+				WriteBits((unsigned int)value, groupbits);
+				WriteBool(more != 0);
+			}
+		}
+
+		void WriteSigned(long long value, unsigned int groupbits) { WriteVarint(((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63), groupbits); }
+
+		// Writes out the last partial byte, padded with zeros. Writing more after a flush starts a new byte.
+		void Flush();
+
+		// Bits written so far, flushed or not.
+		size_t GetBitCount() const;
+
+	private:
+		BitWriter(const BitWriter&);
+		BitWriter& operator=(const BitWriter&);
+
+		std::vector<unsigned char>& m_Buffer;
+		size_t m_StartSize;
+		unsigned long long m_Bits; // Written but not yet out in a byte, in the low m_BitCount bits.
+		unsigned int m_BitCount;
+	};
+
+	// Reads what a BitWriter wrote. Reading past the end reads zeros and marks the reader as overrun, the values it
+	// read can't be trusted then.
+	class BitReader
+	{
+	public:
+		BitReader(const unsigned char* data, size_t size);
+
+		// Defined here, like the writer's.
+		unsigned int ReadBits(unsigned int count)
+		{
+			while (m_BitCount < count)
+			{
+				if (m_Position < m_Size)
+					m_Bits |= (unsigned long long)m_Data[m_Position++] << m_BitCount;
+				else
+					m_IsOverrun = true;
+				m_BitCount += 8;
+			}
+
+			unsigned int value = (unsigned int)(m_Bits & ((1ull << count) - 1));
+			m_Bits >>= count;
+			m_BitCount -= count;
+			return value;
+		}
+
+		bool ReadBool() { return ReadBits(1) != 0; }
+
+		unsigned long long ReadVarint(unsigned int groupbits)
+		{
+			unsigned long long value = ReadBits(groupbits);
+			unsigned int shift = groupbits;
+
+			// A varint longer than 64 bits was never written, the data is broken.
+			while (ReadBool())
+			{
+				if (shift >= 64)
+				{
+					m_IsOverrun = true;
+					break;
+				}
+
+				value |= (unsigned long long)ReadBits(groupbits) << shift;
+				shift += groupbits;
+			}
+			return value;
+		}
+
+		long long ReadSigned(unsigned int groupbits)
+		{
+			unsigned long long value = ReadVarint(groupbits);
+			return (long long)(value >> 1) ^ -(long long)(value & 1);
+		}
+
+		bool IsOverrun() const;
+
+	private:
+		const unsigned char* m_Data;
+		size_t m_Size;
+		size_t m_Position;
+		unsigned long long m_Bits; // Read from the data but not yet returned, in the low m_BitCount bits.
+		unsigned int m_BitCount;
+		bool m_IsOverrun;
+	};
+}
@@ -0,0 +1,813 @@
+#include "BitboardArena.h"
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BITBOARD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BITBOARD_TARGET(instructions)
+#else
+#define BITBOARD_TARGET(instructions) __attribute__((target(instructions)))
+#endif
+#endif
+
+namespace GameDev2D
+{
+	typedef unsigned long long Word;
+
+	static unsigned int CountBits(Word word)
+	{
+		word = word - ((word >> 1) & 0x5555555555555555ull);
+		word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return (unsigned int)((word * 0x0101010101010101ull) >> 56);
+	}
+
+	static unsigned int CountBits(const Word* board, const Word* mask, size_t begin, size_t end)
+	{
+		unsigned int count = 0;
+		for (size_t index = begin; index < end; index++)
+			count += CountBits(board[index] & mask[index]);
+		return count;
+	}
+
+	// The word has to have a bit set. The territory query finds the box of its frontier with these every step, the
+	// processor's bit scans are used where the compiler has them.
+	static int GetLowestBit(Word word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long bit;
+		_BitScanForward64(&bit, word);
+		return (int)bit;
+#elif defined(__GNUC__)
+		return __builtin_ctzll(word);
+#else
+		int bit = 0;
+		for (int shift = 32; shift > 0; shift /= 2)
+		{
+			if ((word & ((1ull << shift) - 1)) == 0)
+			{
+				word >>= shift;
+				bit += shift;
+			}
+		}
+		return bit;
+#endif
+	}
+
+	static int GetHighestBit(Word word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long bit;
+		_BitScanReverse64(&bit, word);
+		return (int)bit;
+#elif defined(__GNUC__)
+		return 63 - __builtin_clzll(word);
+#else
+		int bit = 0;
+		for (int shift = 32; shift > 0; shift /= 2)
+		{
+			if ((word >> shift) != 0)
+			{
+				word >>= shift;
+				bit += shift;
+			}
+		}
+		return bit;
+#endif
+	}
+
+	// Spreads the cells along the open runs of their row within the word, every step doubling the distance
+	// covered, until they fill the runs they're in.
+	static Word FillRow(Word cells, Word open)
+	{
+		Word up = cells;
+		Word down = cells;
+		Word upopen = open;
+		Word downopen = open;
+
+		for (int shift = 1; shift < 64; shift *= 2)
+		{
+			up |= upopen & (up << shift);
+			upopen &= upopen << shift;
+			down |= downopen & (down >> shift);
+			downopen &= downopen >> shift;
+		}
+
+		return up | down;
+	}
+
+	// A cell's neighbours in the rows above and below are the same bit of the previous and next word, and its
+	// neighbours to the sides are the next bits over, carried in from the word columns on either side.
+	static Word GetNeighbours(const Word* source, size_t index, size_t stride)
+	{
+		Word word = source[index];
+		return word | (word << 1) | (word >> 1) | source[index - 1] | source[index + 1] | (source[index - stride] >> 63) | (source[index + stride] << 63);
+	}
+
+	// The cells a territory claimed in a word column in a step, with the first and last word the kernel found any in.
+	struct ClaimedCells
+	{
+		unsigned int count;
+		Word cells; // Every claimed word or'ed together, for the columns they're in.
+		Word contested; // Non zero if the territory grew into any cell another one also did.
+		size_t first; // The end of the words if none were claimed.
+		size_t last;
+	};
+
+	static bool FillScalar(const Word* source, const Word* mask, Word* out, size_t begin, size_t end, size_t stride)
+	{
+		Word grew = 0;
+
+		for (size_t index = begin; index < end; index++)
+		{
+			Word grown = FillRow(GetNeighbours(source, index, stride) & mask[index], mask[index]);
+			out[index] = grown;
+			grew |= grown & ~source[index];
+		}
+
+		return grew != 0;
+	}
+
+	// Grows a territory's frontier into the open cells no territory has taken yet, and marks the cells it grows
+	// into once, or twice if another territory already grew into them this step.
+	static void ContestScalar(const Word* frontier, const Word* open, const Word* taken, Word* once, Word* twice, Word* grown, size_t begin, size_t end, size_t stride)
+	{
+		for (size_t index = begin; index < end; index++)
+		{
+			Word cells = GetNeighbours(frontier, index, stride) & open[index] & ~taken[index];
+			grown[index] = cells;
+			twice[index] |= once[index] & cells;
+			once[index] |= cells;
+		}
+	}
+
+	// Keeps the cells no other territory grew into as the next frontier, and clears the last one. Every cell grown
+	// into is taken, contested or not. Only the contest marks are needed by the other territories' claims, the
+	// marks of cells grown into once are cleared as it goes.
+	static void ClaimScalar(Word* frontier, Word* grown, const Word* twice, Word* once, Word* taken, size_t begin, size_t end, ClaimedCells& claimed)
+	{
+		// Kept out of claimed while the words are written, so the compiler doesn't have to reload them every store.
+		unsigned int count = 0;
+		Word any = 0;
+		Word contested = 0;
+		size_t first = end;
+		size_t last = begin;
+
+		for (size_t index = begin; index < end; index++)
+		{
+			Word words = grown[index];
+			Word cells = words & ~twice[index];
+			taken[index] |= words;
+			contested |= words & twice[index];
+			grown[index] = cells;
+			frontier[index] = 0;
+			once[index] = 0;
+
+			if (cells != 0)
+			{
+				count += CountBits(cells);
+				any |= cells;
+				first = std::min(first, index);
+				last = index;
+			}
+		}
+
+		claimed.count = count;
+		claimed.cells = any;
+		claimed.contested = contested;
+		claimed.first = first;
+		claimed.last = last;
+	}
+
+#ifdef BITBOARD_X86
+	// The SIMD kernels do the same as the scalar ones, for 2 or 4 rows at a time. The claimed cells' first and last
+	// words are found to within a vector, the caller narrows them down.
+	BITBOARD_TARGET("sse2")
+	static __m128i FillRowSSE2(__m128i cells, __m128i open)
+	{
+		__m128i up = cells;
+		__m128i down = cells;
+		__m128i upopen = open;
+		__m128i downopen = open;
+
+#define BITBOARD_FILL_ROW_SSE2(shift) \
+		up = _mm_or_si128(up, _mm_and_si128(upopen, _mm_slli_epi64(up, shift))); \
+		upopen = _mm_and_si128(upopen, _mm_slli_epi64(upopen, shift)); \
+		down = _mm_or_si128(down, _mm_and_si128(downopen, _mm_srli_epi64(down, shift))); \
+		downopen = _mm_and_si128(downopen, _mm_srli_epi64(downopen, shift));
+
+		BITBOARD_FILL_ROW_SSE2(1)
+		BITBOARD_FILL_ROW_SSE2(2)
+		BITBOARD_FILL_ROW_SSE2(4)
+		BITBOARD_FILL_ROW_SSE2(8)
+		BITBOARD_FILL_ROW_SSE2(16)
+		BITBOARD_FILL_ROW_SSE2(32)
+#undef BITBOARD_FILL_ROW_SSE2
+
+		return _mm_or_si128(up, down);
+	}
+
+	BITBOARD_TARGET("sse2")
+	static __m128i GetNeighboursSSE2(const Word* source, size_t index, size_t stride)
+	{
+		__m128i word = _mm_loadu_si128((const __m128i*)(source + index));
+		__m128i neighbours = _mm_or_si128(word, _mm_slli_epi64(word, 1));
+		neighbours = _mm_or_si128(neighbours, _mm_srli_epi64(word, 1));
+		neighbours = _mm_or_si128(neighbours, _mm_loadu_si128((const __m128i*)(source + index - 1)));
+		neighbours = _mm_or_si128(neighbours, _mm_loadu_si128((const __m128i*)(source + index + 1)));
+		neighbours = _mm_or_si128(neighbours, _mm_srli_epi64(_mm_loadu_si128((const __m128i*)(source + index - stride)), 63));
+		return _mm_or_si128(neighbours, _mm_slli_epi64(_mm_loadu_si128((const __m128i*)(source + index + stride)), 63));
+	}
+
+	// The bits set in each byte, summed over the bytes of each word.
+	BITBOARD_TARGET("sse2")
+	static __m128i CountBitsSSE2(__m128i words)
+	{
+		words = _mm_sub_epi64(words, _mm_and_si128(_mm_srli_epi64(words, 1), _mm_set1_epi8(0x55)));
+		words = _mm_add_epi64(_mm_and_si128(words, _mm_set1_epi8(0x33)), _mm_and_si128(_mm_srli_epi64(words, 2), _mm_set1_epi8(0x33)));
+		words = _mm_and_si128(_mm_add_epi64(words, _mm_srli_epi64(words, 4)), _mm_set1_epi8(0x0F));
+		return _mm_sad_epu8(words, _mm_setzero_si128());
+	}
+
+	BITBOARD_TARGET("sse2")
+	static bool FillSSE2(const Word* source, const Word* mask, Word* out, size_t begin, size_t end, size_t stride)
+	{
+		__m128i grew = _mm_setzero_si128();
+
+		for (size_t index = begin; index < end; index += 2)
+		{
+			__m128i open = _mm_loadu_si128((const __m128i*)(mask + index));
+			__m128i grown = FillRowSSE2(_mm_and_si128(GetNeighboursSSE2(source, index, stride), open), open);
+			_mm_storeu_si128((__m128i*)(out + index), grown);
+			grew = _mm_or_si128(grew, _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(source + index)), grown));
+		}
+
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(grew, _mm_setzero_si128())) != 0xFFFF;
+	}
+
+	BITBOARD_TARGET("sse2")
+	static void ContestSSE2(const Word* frontier, const Word* open, const Word* taken, Word* once, Word* twice, Word* grown, size_t begin, size_t end, size_t stride)
+	{
+		for (size_t index = begin; index < end; index += 2)
+		{
+			__m128i available = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(taken + index)), _mm_loadu_si128((const __m128i*)(open + index)));
+			__m128i cells = _mm_and_si128(GetNeighboursSSE2(frontier, index, stride), available);
+			__m128i marked = _mm_loadu_si128((const __m128i*)(once + index));
+			_mm_storeu_si128((__m128i*)(grown + index), cells);
+			_mm_storeu_si128((__m128i*)(twice + index), _mm_or_si128(_mm_loadu_si128((const __m128i*)(twice + index)), _mm_and_si128(marked, cells)));
+			_mm_storeu_si128((__m128i*)(once + index), _mm_or_si128(marked, cells));
+		}
+	}
+
+	BITBOARD_TARGET("sse2")
+	static void ClaimSSE2(Word* frontier, Word* grown, const Word* twice, Word* once, Word* taken, size_t begin, size_t end, ClaimedCells& claimed)
+	{
+		__m128i counts = _mm_setzero_si128();
+		__m128i any = _mm_setzero_si128();
+		__m128i contested = _mm_setzero_si128();
+		size_t first = end;
+		size_t last = begin;
+
+		for (size_t index = begin; index < end; index += 2)
+		{
+			__m128i words = _mm_loadu_si128((const __m128i*)(grown + index));
+			__m128i marks = _mm_loadu_si128((const __m128i*)(twice + index));
+			__m128i cells = _mm_andnot_si128(marks, words);
+			_mm_storeu_si128((__m128i*)(taken + index), _mm_or_si128(_mm_loadu_si128((const __m128i*)(taken + index)), words));
+			contested = _mm_or_si128(contested, _mm_and_si128(words, marks));
+			_mm_storeu_si128((__m128i*)(grown + index), cells);
+			_mm_storeu_si128((__m128i*)(frontier + index), _mm_setzero_si128());
+			_mm_storeu_si128((__m128i*)(once + index), _mm_setzero_si128());
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(cells, _mm_setzero_si128())) != 0xFFFF)
+			{
+				counts = _mm_add_epi64(counts, CountBitsSSE2(cells));
+				any = _mm_or_si128(any, cells);
+				first = std::min(first, index);
+				last = index + 1;
+			}
+		}
+
+		Word lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, counts);
+		claimed.count = (unsigned int)(lanes[0] + lanes[1]);
+		_mm_storeu_si128((__m128i*)lanes, any);
+		claimed.cells = lanes[0] | lanes[1];
+		_mm_storeu_si128((__m128i*)lanes, contested);
+		claimed.contested = lanes[0] | lanes[1];
+		claimed.first = first;
+		claimed.last = last;
+	}
+
+	BITBOARD_TARGET("avx2")
+	static __m256i FillRowAVX2(__m256i cells, __m256i open)
+	{
+		__m256i up = cells;
+		__m256i down = cells;
+		__m256i upopen = open;
+		__m256i downopen = open;
+
+#define BITBOARD_FILL_ROW_AVX2(shift) \
+		up = _mm256_or_si256(up, _mm256_and_si256(upopen, _mm256_slli_epi64(up, shift))); \
+		upopen = _mm256_and_si256(upopen, _mm256_slli_epi64(upopen, shift)); \
+		down = _mm256_or_si256(down, _mm256_and_si256(downopen, _mm256_srli_epi64(down, shift))); \
+		downopen = _mm256_and_si256(downopen, _mm256_srli_epi64(downopen, shift));
+
+		BITBOARD_FILL_ROW_AVX2(1)
+		BITBOARD_FILL_ROW_AVX2(2)
+		BITBOARD_FILL_ROW_AVX2(4)
+		BITBOARD_FILL_ROW_AVX2(8)
+		BITBOARD_FILL_ROW_AVX2(16)
+		BITBOARD_FILL_ROW_AVX2(32)
+#undef BITBOARD_FILL_ROW_AVX2
+
+		return _mm256_or_si256(up, down);
+	}
+
+	BITBOARD_TARGET("avx2")
+	static __m256i GetNeighboursAVX2(const Word* source, size_t index, size_t stride)
+	{
+		__m256i word = _mm256_loadu_si256((const __m256i*)(source + index));
+		__m256i neighbours = _mm256_or_si256(word, _mm256_slli_epi64(word, 1));
+		neighbours = _mm256_or_si256(neighbours, _mm256_srli_epi64(word, 1));
+		neighbours = _mm256_or_si256(neighbours, _mm256_loadu_si256((const __m256i*)(source + index - 1)));
+		neighbours = _mm256_or_si256(neighbours, _mm256_loadu_si256((const __m256i*)(source + index + 1)));
+		neighbours = _mm256_or_si256(neighbours, _mm256_srli_epi64(_mm256_loadu_si256((const __m256i*)(source + index - stride)), 63));
+		return _mm256_or_si256(neighbours, _mm256_slli_epi64(_mm256_loadu_si256((const __m256i*)(source + index + stride)), 63));
+	}
+
+	BITBOARD_TARGET("avx2")
+	static __m256i CountBitsAVX2(__m256i words)
+	{
+		words = _mm256_sub_epi64(words, _mm256_and_si256(_mm256_srli_epi64(words, 1), _mm256_set1_epi8(0x55)));
+		words = _mm256_add_epi64(_mm256_and_si256(words, _mm256_set1_epi8(0x33)), _mm256_and_si256(_mm256_srli_epi64(words, 2), _mm256_set1_epi8(0x33)));
+		words = _mm256_and_si256(_mm256_add_epi64(words, _mm256_srli_epi64(words, 4)), _mm256_set1_epi8(0x0F));
+		return _mm256_sad_epu8(words, _mm256_setzero_si256());
+	}
+
+	BITBOARD_TARGET("avx2")
+	static bool FillAVX2(const Word* source, const Word* mask, Word* out, size_t begin, size_t end, size_t stride)
+	{
+		__m256i grew = _mm256_setzero_si256();
+
+		for (size_t index = begin; index < end; index += 4)
+		{
+			__m256i open = _mm256_loadu_si256((const __m256i*)(mask + index));
+			__m256i grown = FillRowAVX2(_mm256_and_si256(GetNeighboursAVX2(source, index, stride), open), open);
+			_mm256_storeu_si256((__m256i*)(out + index), grown);
+			grew = _mm256_or_si256(grew, _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(source + index)), grown));
+		}
+
+		return _mm256_testz_si256(grew, grew) == 0;
+	}
+
+	BITBOARD_TARGET("avx2")
+	static void ContestAVX2(const Word* frontier, const Word* open, const Word* taken, Word* once, Word* twice, Word* grown, size_t begin, size_t end, size_t stride)
+	{
+		for (size_t index = begin; index < end; index += 4)
+		{
+			__m256i available = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(taken + index)), _mm256_loadu_si256((const __m256i*)(open + index)));
+			__m256i cells = _mm256_and_si256(GetNeighboursAVX2(frontier, index, stride), available);
+			__m256i marked = _mm256_loadu_si256((const __m256i*)(once + index));
+			_mm256_storeu_si256((__m256i*)(grown + index), cells);
+			_mm256_storeu_si256((__m256i*)(twice + index), _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(twice + index)), _mm256_and_si256(marked, cells)));
+			_mm256_storeu_si256((__m256i*)(once + index), _mm256_or_si256(marked, cells));
+		}
+	}
+
+	BITBOARD_TARGET("avx2")
+	static void ClaimAVX2(Word* frontier, Word* grown, const Word* twice, Word* once, Word* taken, size_t begin, size_t end, ClaimedCells& claimed)
+	{
+		__m256i counts = _mm256_setzero_si256();
+		__m256i any = _mm256_setzero_si256();
+		__m256i contested = _mm256_setzero_si256();
+		size_t first = end;
+		size_t last = begin;
+
+		for (size_t index = begin; index < end; index += 4)
+		{
+			__m256i words = _mm256_loadu_si256((const __m256i*)(grown + index));
+			__m256i marks = _mm256_loadu_si256((const __m256i*)(twice + index));
+			__m256i cells = _mm256_andnot_si256(marks, words);
+			_mm256_storeu_si256((__m256i*)(taken + index), _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(taken + index)), words));
+			contested = _mm256_or_si256(contested, _mm256_and_si256(words, marks));
+			_mm256_storeu_si256((__m256i*)(grown + index), cells);
+			_mm256_storeu_si256((__m256i*)(frontier + index), _mm256_setzero_si256());
+			_mm256_storeu_si256((__m256i*)(once + index), _mm256_setzero_si256());
+
+			if (_mm256_testz_si256(cells, cells) == 0)
+			{
+				counts = _mm256_add_epi64(counts, CountBitsAVX2(cells));
+				any = _mm256_or_si256(any, cells);
+				first = std::min(first, index);
+				last = index + 3;
+			}
+		}
+
+		Word lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, counts);
+		claimed.count = (unsigned int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+		_mm256_storeu_si256((__m256i*)lanes, any);
+		claimed.cells = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+		_mm256_storeu_si256((__m256i*)lanes, contested);
+		claimed.contested = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+		claimed.first = first;
+		claimed.last = last;
+	}
+
+#endif
+
+	// The kernels of an instruction set, indexed by BitboardKernel.
+	struct KernelSet
+	{
+		bool (*fill)(const Word* source, const Word* mask, Word* out, size_t begin, size_t end, size_t stride);
+		void (*contest)(const Word* frontier, const Word* open, const Word* taken, Word* once, Word* twice, Word* grown, size_t begin, size_t end, size_t stride);
+		void (*claim)(Word* frontier, Word* grown, const Word* twice, Word* once, Word* taken, size_t begin, size_t end, ClaimedCells& claimed);
+	};
+
+	static const KernelSet KERNEL_SETS[] =
+	{
+		{ FillScalar, ContestScalar, ClaimScalar },
+#ifdef BITBOARD_X86
+		{ FillSSE2, ContestSSE2, ClaimSSE2 },
+		{ FillAVX2, ContestAVX2, ClaimAVX2 },
+#endif
+	};
+
+	BitboardArena::BitboardArena(int columns, int rows) :
+		m_Columns(std::max(columns, 1)),
+		m_Rows(std::max(rows, 1)),
+		m_Kernel(GetBestKernel())
+	{
+		m_WordColumns = (m_Columns + 63) / 64;
+		m_Stride = ((size_t)m_Rows + 2 + 3) & ~(size_t)3;
+		m_Size = (m_WordColumns + 2) * m_Stride;
+
+		m_Open.resize(m_Size);
+		m_Reach.resize(m_Size);
+		m_Next.resize(m_Size);
+		m_Taken.resize(m_Size);
+		m_Once.resize(m_Size);
+		m_Twice.resize(m_Size);
+
+		Clear();
+	}
+
+	void BitboardArena::Clear()
+	{
+		std::fill(m_Open.begin(), m_Open.end(), 0);
+
+		for (int wordcolumn = 0; wordcolumn < m_WordColumns; wordcolumn++)
+		{
+			int bits = std::min(m_Columns - wordcolumn * 64, 64);
+			Word columnmask = bits == 64 ? ~0ull : (1ull << bits) - 1;
+
+			Word* column = &m_Open[(wordcolumn + 1) * m_Stride + 1];
+			std::fill(column, column + m_Rows, columnmask);
+		}
+	}
+
+	void BitboardArena::BlockLine(int startcolumn, int startrow, int endcolumn, int endrow)
+	{
+		int mincolumn = std::max(std::min(startcolumn, endcolumn), 0);
+		int maxcolumn = std::min(std::max(startcolumn, endcolumn), m_Columns - 1);
+		int minrow = std::max(std::min(startrow, endrow), 0);
+		int maxrow = std::min(std::max(startrow, endrow), m_Rows - 1);
+
+		for (int column = mincolumn; column <= maxcolumn; column++)
+		{
+			for (int row = minrow; row <= maxrow; row++)
+				m_Open[GetIndex(column, row)] &= ~(1ull << (column % 64));
+		}
+	}
+
+	void BitboardArena::OpenBox(int mincolumn, int minrow, int maxcolumn, int maxrow)
+	{
+		mincolumn = std::max(mincolumn, 0);
+		maxcolumn = std::min(maxcolumn, m_Columns - 1);
+		minrow = std::max(minrow, 0);
+		maxrow = std::min(maxrow, m_Rows - 1);
+
+		for (int column = mincolumn; column <= maxcolumn; column++)
+		{
+			for (int row = minrow; row <= maxrow; row++)
+				m_Open[GetIndex(column, row)] |= 1ull << (column % 64);
+		}
+	}
+
+	void BitboardArena::SetOpen(int column, int row, bool isopen)
+	{
+		Word bit = 1ull << (column % 64);
+		Word& word = m_Open[GetIndex(column, row)];
+		word = isopen ? word | bit : word & ~bit;
+	}
+
+	void BitboardArena::CopyCells(const BitboardArena& arena)
+	{
+		m_Open = arena.m_Open;
+	}
+
+	bool BitboardArena::IsOpen(int column, int row) const
+	{
+		return IsInside(column, row) && (m_Open[GetIndex(column, row)] >> (column % 64) & 1) != 0;
+	}
+
+	int BitboardArena::GetColumns() const
+	{
+		return m_Columns;
+	}
+
+	int BitboardArena::GetRows() const
+	{
+		return m_Rows;
+	}
+
+	unsigned int BitboardArena::GetOpenCount() const
+	{
+		return CountBits(m_Open.data(), m_Open.data(), 0, m_Size);
+	}
+
+	unsigned int BitboardArena::CountReachable(int column, int row) const
+	{
+		if (!IsInside(column, row)) return 0;
+
+		return CountBits(FillFrom(column, row, 0, 0), m_Open.data(), 0, m_Size);
+	}
+
+	bool BitboardArena::IsReachable(int column, int row, int targetcolumn, int targetrow) const
+	{
+		if (!IsInside(column, row) || !IsOpen(targetcolumn, targetrow)) return false;
+
+		size_t target = GetIndex(targetcolumn, targetrow);
+		Word targetbit = 1ull << (targetcolumn % 64);
+		return (FillFrom(column, row, target, targetbit)[target] & targetbit) != 0;
+	}
+
+	void BitboardArena::GetTerritory(const int* columns, const int* rows, unsigned int count, unsigned int* territories, unsigned int maxsteps) const
+	{
+		if (count == 0) return;
+
+		if (m_Frontiers.size() < 2 * count * m_Size)
+			m_Frontiers.resize(2 * count * m_Size);
+		m_Boxes.resize(count);
+		m_FrontierBoxes.resize(count);
+		m_GrowBoxes.resize(count);
+		m_IsGrowing.assign(count, 0);
+		m_IsContested.resize(count);
+
+		const KernelSet& kernels = KERNEL_SETS[(int)m_Kernel];
+		const Word* open = m_Open.data();
+		Word* taken = m_Taken.data();
+		Word* once = m_Once.data();
+		Word* twice = m_Twice.data();
+
+		// The sources' cells are taken from the start, and are the first frontiers.
+		for (unsigned int source = 0; source < count; source++)
+		{
+			territories[source] = 0;
+			if (!IsInside(columns[source], rows[source])) continue;
+
+			size_t index = GetIndex(columns[source], rows[source]);
+			Word bit = 1ull << (columns[source] % 64);
+			m_Frontiers[2 * source * m_Size + index] |= bit;
+			taken[index] |= bit;
+			if ((open[index] & bit) != 0)
+				territories[source] = 1;
+
+			CellBox box = { columns[source], rows[source], columns[source], rows[source] };
+			m_Boxes[source] = box;
+			m_FrontierBoxes[source] = box;
+			m_IsGrowing[source] = 1;
+		}
+
+		// Every step each territory grows from the cells it claimed last step into the cells no territory has taken,
+		// cells more than one grew into this step are contested and go to none. Either way they're taken, so a
+		// territory that claimed nothing never will again. Each frontier is only grown within its box, one cell
+		// larger than the cells it holds, and each territory's box holds every cell it took or contested.
+		size_t current = 0;
+		bool grew = true;
+		for (unsigned int step = 0; grew && (maxsteps == 0 || step < maxsteps); step++)
+		{
+			grew = false;
+
+			for (unsigned int source = 0; source < count; source++)
+			{
+				if (!m_IsGrowing[source]) continue;
+
+				const CellBox& frontierbox = m_FrontierBoxes[source];
+				CellBox growbox = { std::max(frontierbox.mincolumn - 1, 0), std::max(frontierbox.minrow - 1, 0), std::min(frontierbox.maxcolumn + 1, m_Columns - 1), std::min(frontierbox.maxrow + 1, m_Rows - 1) };
+				m_GrowBoxes[source] = growbox;
+
+				CellBox& box = m_Boxes[source];
+				box.mincolumn = std::min(box.mincolumn, growbox.mincolumn);
+				box.minrow = std::min(box.minrow, growbox.minrow);
+				box.maxcolumn = std::max(box.maxcolumn, growbox.maxcolumn);
+				box.maxrow = std::max(box.maxrow, growbox.maxrow);
+
+				const Word* frontier = &m_Frontiers[(2 * source + current) * m_Size];
+				Word* grown = &m_Frontiers[(2 * source + 1 - current) * m_Size];
+				for (int wordcolumn = growbox.mincolumn / 64; wordcolumn <= growbox.maxcolumn / 64; wordcolumn++)
+				{
+					size_t begin, end;
+					GetWordRange(growbox, wordcolumn, begin, end);
+					kernels.contest(frontier, open, taken, once, twice, grown, begin, end, m_Stride);
+				}
+			}
+
+			// The cells each territory alone grew into are its next frontier, they and their box replace the last.
+			for (unsigned int source = 0; source < count; source++)
+			{
+				if (!m_IsGrowing[source]) continue;
+
+				const CellBox& growbox = m_GrowBoxes[source];
+				CellBox frontierbox = { m_Columns, m_Rows, -1, -1 };
+				Word contested = 0;
+
+				Word* frontier = &m_Frontiers[(2 * source + current) * m_Size];
+				Word* grown = &m_Frontiers[(2 * source + 1 - current) * m_Size];
+				for (int wordcolumn = growbox.mincolumn / 64; wordcolumn <= growbox.maxcolumn / 64; wordcolumn++)
+				{
+					size_t begin, end;
+					GetWordRange(growbox, wordcolumn, begin, end);
+
+					ClaimedCells claimed;
+					kernels.claim(frontier, grown, twice, once, taken, begin, end, claimed);
+					contested |= claimed.contested;
+					if (claimed.count == 0) continue;
+
+					territories[source] += claimed.count;
+
+					while (grown[claimed.first] == 0)
+						claimed.first++;
+					while (grown[claimed.last] == 0)
+						claimed.last--;
+
+					size_t column = (size_t)(wordcolumn + 1) * m_Stride + 1;
+					frontierbox.mincolumn = std::min(frontierbox.mincolumn, wordcolumn * 64 + GetLowestBit(claimed.cells));
+					frontierbox.maxcolumn = std::max(frontierbox.maxcolumn, wordcolumn * 64 + GetHighestBit(claimed.cells));
+					frontierbox.minrow = std::min(frontierbox.minrow, (int)(claimed.first - column));
+					frontierbox.maxrow = std::max(frontierbox.maxrow, (int)(claimed.last - column));
+				}
+
+				m_FrontierBoxes[source] = frontierbox;
+				m_IsContested[source] = contested != 0 ? 1 : 0;
+			}
+
+			// Only then can the contest marks be cleared, every claim needs them. Few territories meet any step, the
+			// others have none to clear.
+			for (unsigned int source = 0; source < count; source++)
+			{
+				if (!m_IsGrowing[source]) continue;
+
+				if (m_IsContested[source])
+				{
+					const CellBox& growbox = m_GrowBoxes[source];
+					for (int wordcolumn = growbox.mincolumn / 64; wordcolumn <= growbox.maxcolumn / 64; wordcolumn++)
+					{
+						size_t begin, end;
+						GetWordRange(growbox, wordcolumn, begin, end);
+						std::fill(twice + begin, twice + end, 0);
+					}
+				}
+
+				m_IsGrowing[source] = m_FrontierBoxes[source].maxcolumn >= 0 ? 1 : 0;
+				grew |= m_IsGrowing[source] != 0;
+			}
+
+			current = 1 - current;
+		}
+
+		// Cleared within the boxes, so the next query finds the taken cells and the frontiers empty whatever the
+		// size of the arena.
+		for (unsigned int source = 0; source < count; source++)
+		{
+			if (!IsInside(columns[source], rows[source])) continue;
+
+			for (int wordcolumn = m_Boxes[source].mincolumn / 64; wordcolumn <= m_Boxes[source].maxcolumn / 64; wordcolumn++)
+			{
+				size_t begin, end;
+				GetWordRange(m_Boxes[source], wordcolumn, begin, end);
+				std::fill(taken + begin, taken + end, 0);
+			}
+
+			if (!m_IsGrowing[source]) continue;
+
+			Word* frontier = &m_Frontiers[(2 * source + current) * m_Size];
+			for (int wordcolumn = m_FrontierBoxes[source].mincolumn / 64; wordcolumn <= m_FrontierBoxes[source].maxcolumn / 64; wordcolumn++)
+			{
+				size_t begin, end;
+				GetWordRange(m_FrontierBoxes[source], wordcolumn, begin, end);
+				std::fill(frontier + begin, frontier + end, 0);
+			}
+		}
+	}
+
+	bool BitboardArena::SetKernel(BitboardKernel kernel)
+	{
+		if (!IsKernelSupported(kernel)) return false;
+
+		m_Kernel = kernel;
+		return true;
+	}
+
+	BitboardKernel BitboardArena::GetKernel() const
+	{
+		return m_Kernel;
+	}
+
+	bool BitboardArena::IsKernelSupported(BitboardKernel kernel)
+	{
+		if (kernel == BitboardKernel::Scalar) return true;
+
+#if defined(BITBOARD_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int highest = info[0];
+
+		__cpuid(info, 1);
+		if (kernel == BitboardKernel::SSE2)
+			return (info[3] & (1 << 26)) != 0;
+
+		// AVX2 also needs the operating system to save the upper halves of the registers.
+		bool avx = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+		if (!avx || highest < 7) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif defined(BITBOARD_X86)
+		__builtin_cpu_init();
+		if (kernel == BitboardKernel::SSE2)
+			return __builtin_cpu_supports("sse2") != 0;
+		return __builtin_cpu_supports("avx2") != 0;
+#else
+		return false;
+#endif
+	}
+
+	BitboardKernel BitboardArena::GetBestKernel()
+	{
+		static const BitboardKernel best = IsKernelSupported(BitboardKernel::AVX2) ? BitboardKernel::AVX2 :
+			IsKernelSupported(BitboardKernel::SSE2) ? BitboardKernel::SSE2 : BitboardKernel::Scalar;
+		return best;
+	}
+
+	size_t BitboardArena::GetIndex(int column, int row) const
+	{
+		return (size_t)(column / 64 + 1) * m_Stride + row + 1;
+	}
+
+	bool BitboardArena::IsInside(int column, int row) const
+	{
+		return column >= 0 && column < m_Columns && row >= 0 && row < m_Rows;
+	}
+
+	void BitboardArena::GetWordRange(const CellBox& box, int wordcolumn, size_t& begin, size_t& end) const
+	{
+		// The padding row above the column makes row r the word at r + 1.
+		size_t column = (size_t)(wordcolumn + 1) * m_Stride;
+		begin = column + ((size_t)(box.minrow + 1) & ~(size_t)3);
+		end = column + (((size_t)box.maxrow + 1 + 4) & ~(size_t)3);
+	}
+
+	bool BitboardArena::Fill(const Word* source, Word* out) const
+	{
+		// The padding columns on either side are left out, the padding rows are in but nothing's open on them.
+		if (!KERNEL_SETS[(int)m_Kernel].fill(source, m_Open.data(), out, m_Stride, m_Stride * (m_WordColumns + 1), m_Stride))
+			return false;
+
+		// Down and back up every column of words, 64 columns of cells at a time.
+		const Word* open = m_Open.data();
+		for (int wordcolumn = 1; wordcolumn <= m_WordColumns; wordcolumn++)
+		{
+			size_t first = wordcolumn * m_Stride + 1;
+			size_t last = first + m_Rows - 1;
+
+			for (size_t index = first + 1; index <= last; index++)
+				out[index] |= out[index - 1] & open[index];
+			for (size_t index = last; index > first; index--)
+				out[index - 1] |= out[index] & open[index - 1];
+		}
+
+		return true;
+	}
+
+	const Word* BitboardArena::FillFrom(int column, int row, size_t target, Word targetbit) const
+	{
+		std::fill(m_Reach.begin(), m_Reach.end(), 0);
+		m_Reach[GetIndex(column, row)] = 1ull << (column % 64);
+
+		// Once nothing grows the last fill holds the reachable cells.
+		Word* reach = m_Reach.data();
+		Word* next = m_Next.data();
+		while (Fill(reach, next))
+		{
+			if ((next[target] & targetbit) != 0)
+				break;
+			std::swap(reach, next);
+		}
+
+		return next;
+	}
+}
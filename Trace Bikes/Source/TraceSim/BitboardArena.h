@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	// The instruction sets the bitboard queries can run on. The scalar kernel runs everywhere, the others are
+	// picked at runtime if the processor supports them.
+	enum class BitboardKernel
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+	};
+
+	// The arena as a grid of cells, one bit each, set while the cell is open. The queries grow sets of cells 64 at
+	// a time, a word per row of a 64 cell wide column, instead of visiting cells one by one, so an AI can run
+	// thousands of them per frame. A fill spreads along the open runs of the rows and columns every step, a
+	// territory grows by a cell in every direction per step.
+	//
+	// The bits are stored by 64 cell wide columns of words, with a row of padding above and below every column and
+	// a column of padding on each side, so the neighbours of a word are at fixed offsets and the kernels run over
+	// the grid without any checks for its edges. The queries use scratch boards held by the arena, an arena can
+	// only be queried from one thread at a time.
+	class BitboardArena
+	{
+	public:
+		BitboardArena(int columns, int rows);
+
+		// Opens every cell.
+		void Clear();
+
+		// Blocks the cells from one cell to another along a row or a column, cells outside the arena are left out.
+		void BlockLine(int startcolumn, int startrow, int endcolumn, int endrow);
+
+		// Opens the cells in a box, cells outside the arena are left out. A restore opens the cells the runs it
+		// drops were in, and blocks them again along the runs it keeps.
+		void OpenBox(int mincolumn, int minrow, int maxcolumn, int maxrow);
+
+		// Opens or blocks a cell inside the arena, for searches that play moves out and take them back.
+		void SetOpen(int column, int row, bool isopen);
+
+		// Copies which cells are open from an arena of the same size, without its scratch boards.
+		void CopyCells(const BitboardArena& arena);
+
+		bool IsOpen(int column, int row) const;
+		int GetColumns() const;
+		int GetRows() const;
+		unsigned int GetOpenCount() const;
+
+		// The number of open cells that can be reached from a cell. The cell itself doesn't have to be open, a
+		// bike's own cell is blocked by its trail.
+		unsigned int CountReachable(int column, int row) const;
+
+		// Returns wether a cell can be reached from another, the fill stops as soon as it gets there.
+		bool IsReachable(int column, int row, int targetcolumn, int targetrow) const;
+
+		// Grows out from every source at once, each open cell goes to the source that reaches it first and cells
+		// reached first by more than one source go to none. Fills territories with each source's cell count. With a
+		// step limit other than 0 the territories stop growing after that many steps, only the cells within that
+		// many moves of the sources are shared out, so the query's cost doesn't depend on the size of the arena.
+		void GetTerritory(const int* columns, const int* rows, unsigned int count, unsigned int* territories, unsigned int maxsteps = 0) const;
+
+		// Returns false if the processor doesn't support the kernel.
+		bool SetKernel(BitboardKernel kernel);
+		BitboardKernel GetKernel() const;
+
+		static bool IsKernelSupported(BitboardKernel kernel);
+
+		// The fastest kernel the processor supports.
+		static BitboardKernel GetBestKernel();
+
+	private:
+		// A box of cells, around a territory, its frontier and where the frontier can grow next.
+		struct CellBox
+		{
+			int mincolumn;
+			int minrow;
+			int maxcolumn;
+			int maxrow;
+		};
+
+		size_t GetIndex(int column, int row) const;
+		bool IsInside(int column, int row) const;
+
+		// The words of a word column the box covers, rounded out to whole groups of 4 rows for the kernels.
+		void GetWordRange(const CellBox& box, int wordcolumn, size_t& begin, size_t& end) const;
+
+		// Sets out to the cells of source and their open neighbours over the whole arena, then spreads them along the
+		// open runs of their rows and columns, so a fill needs a step per turn of the paths through the arena, not
+		// per cell. Returns wether out holds any cell that isn't in source.
+		bool Fill(const unsigned long long* source, unsigned long long* out) const;
+
+		// Fills from a cell until nothing more can be reached, or the target cell is reached if there's one.
+		// Returns the board holding the reached cells.
+		const unsigned long long* FillFrom(int column, int row, size_t target, unsigned long long targetbit) const;
+
+		int m_Columns;
+		int m_Rows;
+		int m_WordColumns;
+		size_t m_Stride; // Words per column of words, padding included, a multiple of 4 so the kernels never need a tail.
+		size_t m_Size; // Words per board.
+		BitboardKernel m_Kernel;
+
+		std::vector<unsigned long long> m_Open;
+
+		// Scratch boards for the queries.
+		mutable std::vector<unsigned long long> m_Reach;
+		mutable std::vector<unsigned long long> m_Next;
+		mutable std::vector<unsigned long long> m_Taken; // Empty outside the queries, like the boards below.
+		mutable std::vector<unsigned long long> m_Once;
+		mutable std::vector<unsigned long long> m_Twice;
+		mutable std::vector<unsigned long long> m_Frontiers; // Two boards per source, the last frontier and the next.
+		mutable std::vector<CellBox> m_Boxes;
+		mutable std::vector<CellBox> m_FrontierBoxes;
+		mutable std::vector<CellBox> m_GrowBoxes;
+		mutable std::vector<unsigned char> m_IsGrowing;
+		mutable std::vector<unsigned char> m_IsContested;
+	};
+}
@@ -0,0 +1,292 @@
+#include "LoopbackBots.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+namespace GameDev2D
+{
+	const double BOT_TURN_TIMEOUT = 0.5; // Seconds a turn is waited for, a bike that crashed first never shows it.
+	const int BOT_WAIT_TIME = 10; // Milliseconds a bot thread waits for states at most, it checks for stopping in between.
+
+	static double GetBotTime()
+	{
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	static Direction GetDirection(int directionx, int directiony)
+	{
+		if (directionx != 0)
+			return directionx < 0 ? Direction::Left : Direction::Right;
+		return directiony > 0 ? Direction::Up : Direction::Down;
+	}
+
+	static double GetPercentile(const std::vector<float>& sorted, double percentile)
+	{
+		if (sorted.empty()) return 0.0;
+
+		size_t rank = (size_t)ceil(percentile * 0.01 * sorted.size());
+		return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+	}
+
+	LoopbackBots::LoopbackBots(const MatchServer& server, unsigned int threadcount) :
+		m_Server(server),
+		m_IsStopping(false)
+	{
+		threadcount = std::max(std::min(threadcount, server.GetMatchCount()), 1u);
+
+		for (unsigned int index = 0; index < threadcount; index++)
+		{
+			Client* client = new Client();
+			client->statesreceived = 0;
+			client->turnssent = 0;
+			client->seed = index + 1;
+
+			Player player;
+			memset(&player, 0, sizeof(player));
+
+			for (unsigned int match = index; match < server.GetMatchCount(); match += threadcount)
+			{
+				client->matches.push_back(match);
+				client->players.insert(client->players.end(), SERVER_MATCH_PLAYERS, player);
+			}
+
+			m_Clients.push_back(client);
+		}
+	}
+
+	LoopbackBots::~LoopbackBots()
+	{
+		Stop();
+
+		for (Client* client : m_Clients)
+			delete client;
+	}
+
+	bool LoopbackBots::Start()
+	{
+		if (!m_Threads.empty()) return false;
+
+		for (Client* client : m_Clients)
+		{
+			if (!client->socket.Open(0, true))
+			{
+				for (Client* opened : m_Clients)
+					opened->socket.Close();
+				return false;
+			}
+		}
+
+		m_IsStopping = false;
+		for (unsigned int index = 0; index < m_Clients.size(); index++)
+		{
+			m_Clients[index]->poller.Add(m_Clients[index]->socket);
+			m_Threads.push_back(std::thread(&LoopbackBots::Run, this, index));
+		}
+
+		return true;
+	}
+
+	void LoopbackBots::Stop()
+	{
+		if (m_Threads.empty()) return;
+
+		m_IsStopping = true;
+		for (std::thread& thread : m_Threads)
+			thread.join();
+		m_Threads.clear();
+
+		for (Client* client : m_Clients)
+			client->socket.Close();
+	}
+
+	BotStats LoopbackBots::GetStats() const
+	{
+		BotStats stats;
+		memset(&stats, 0, sizeof(stats));
+
+		std::vector<float> latencies;
+		for (const Client* client : m_Clients)
+		{
+			for (const Player& player : client->players)
+				stats.joinedplayers += player.isjoined;
+
+			stats.statesreceived += client->statesreceived;
+			stats.turnssent += client->turnssent;
+			latencies.insert(latencies.end(), client->turnlatencies.begin(), client->turnlatencies.end());
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		stats.turnsseen = latencies.size();
+		stats.turnlatencypercentiles[0] = GetPercentile(latencies, 50.0);
+		stats.turnlatencypercentiles[1] = GetPercentile(latencies, 90.0);
+		stats.turnlatencypercentiles[2] = GetPercentile(latencies, 99.0);
+		return stats;
+	}
+
+	void LoopbackBots::Run(unsigned int index)
+	{
+		Client& client = *m_Clients[index];
+		double nextjoin = 0.0;
+
+		while (!m_IsStopping)
+		{
+			double now = GetBotTime();
+			if (now >= nextjoin)
+			{
+				SendJoins(client);
+				nextjoin = now + BOT_JOIN_RESEND_TIME;
+			}
+
+			client.poller.Wait(BOT_WAIT_TIME);
+			ReceivePackets(client);
+		}
+	}
+
+	void LoopbackBots::SendJoins(Client& client)
+	{
+		for (unsigned int local = 0; local < client.matches.size(); local++)
+		{
+			for (unsigned int player = 0; player < SERVER_MATCH_PLAYERS; player++)
+			{
+				if (!client.players[local * SERVER_MATCH_PLAYERS + player].isjoined)
+					SendJoin(client, local, player);
+			}
+		}
+	}
+
+	void LoopbackBots::SendJoin(Client& client, unsigned int local, unsigned int player)
+	{
+		const Player& state = client.players[local * SERVER_MATCH_PLAYERS + player];
+
+		JoinPacket join;
+		memset(&join, 0, sizeof(join));
+		join.type = ServerPacketType::Join;
+		join.player = (unsigned char)player;
+		join.match = client.matches[local];
+		join.challenge = state.challenge;
+		join.session = state.session;
+
+		NetAddress address = { NET_LOOPBACK_IP, m_Server.GetMatchPort(join.match) };
+		client.socket.SendTo(address, &join, sizeof(join));
+	}
+
+	void LoopbackBots::ReceivePackets(Client& client)
+	{
+		char buffer[NET_MAX_DATAGRAM];
+		NetAddress address;
+
+		for (unsigned int count = 0; count < BOT_RECEIVE_BATCH; count++)
+		{
+			int size = client.socket.ReceiveFrom(address, buffer, sizeof(buffer));
+			if (size < 0) break;
+
+			if (size == (int)sizeof(JoinPacket))
+			{
+				JoinPacket answer;
+				memcpy(&answer, buffer, sizeof(answer));
+				ReceiveJoinAnswer(client, answer);
+			}
+			else if (size == (int)sizeof(StatePacket))
+			{
+				StatePacket state;
+				memcpy(&state, buffer, sizeof(state));
+				ReceiveState(client, state);
+			}
+		}
+	}
+
+	void LoopbackBots::ReceiveJoinAnswer(Client& client, const JoinPacket& answer)
+	{
+		unsigned int threadcount = (unsigned int)m_Clients.size();
+		if (answer.match >= m_Server.GetMatchCount() || answer.player >= SERVER_MATCH_PLAYERS) return;
+
+		unsigned int local = answer.match / threadcount;
+		Player& player = client.players[local * SERVER_MATCH_PLAYERS + answer.player];
+
+		// The challenge is sent back straight away rather than with the next joins.
+		if (answer.type == ServerPacketType::Challenge && !player.isjoined)
+		{
+			player.challenge = answer.challenge;
+			SendJoin(client, local, answer.player);
+		}
+		else if (answer.type == ServerPacketType::Joined)
+		{
+			player.session = answer.session;
+			player.isjoined = true;
+		}
+	}
+
+	void LoopbackBots::ReceiveState(Client& client, const StatePacket& state)
+	{
+		if (state.type != ServerPacketType::State || state.match >= m_Server.GetMatchCount()) return;
+
+		unsigned int threadcount = (unsigned int)m_Clients.size();
+		float width = (float)ToFixed(SERVER_ARENA_WIDTH);
+		float height = (float)ToFixed(SERVER_ARENA_HEIGHT);
+		float walldistance = (float)ToFixed(BOT_WALL_DISTANCE);
+
+		client.statesreceived++;
+		double now = GetBotTime();
+		unsigned int local = state.match / threadcount;
+		NetAddress serveraddress = { NET_LOOPBACK_IP, m_Server.GetMatchPort(state.match) };
+
+		for (unsigned int index = 0; index < SERVER_MATCH_PLAYERS; index++)
+		{
+			Player& player = client.players[local * SERVER_MATCH_PLAYERS + index];
+			if (!player.isjoined || state.tick < player.tick) continue;
+
+			player.tick = state.tick;
+
+			bool isalive = (state.alive >> index) & 1;
+			if (state.roundstate != (unsigned char)RoundState::Running || !isalive)
+			{
+				player.isturning = false;
+				continue;
+			}
+
+			int directionx = state.directionx[index];
+			int directiony = state.directiony[index];
+			Direction direction = GetDirection(directionx, directiony);
+
+			if (player.isturning)
+			{
+				if (direction == player.turn)
+					client.turnlatencies.push_back((float)(now - player.turntime));
+				else if (now - player.turntime < BOT_TURN_TIMEOUT)
+					continue;
+				player.isturning = false;
+			}
+
+			// Away from a wall ahead towards the middle of the arena, or at random to either side.
+			float x = (float)state.x[index];
+			float y = (float)state.y[index];
+			bool wallahead = (directionx > 0 && x > width - walldistance) || (directionx < 0 && x < walldistance) ||
+				(directiony > 0 && y > height - walldistance) || (directiony < 0 && y < walldistance);
+
+			client.seed = client.seed * 1664525u + 1013904223u;
+			if (!wallahead && (client.seed >> 8) % BOT_TURN_CHANCE != 0) continue;
+
+			if (directionx != 0)
+				player.turn = (wallahead ? y < height * 0.5f : (client.seed >> 20) % 2 == 0) ? Direction::Up : Direction::Down;
+			else
+				player.turn = (wallahead ? x < width * 0.5f : (client.seed >> 20) % 2 == 0) ? Direction::Right : Direction::Left;
+
+			TurnPacket turn;
+			memset(&turn, 0, sizeof(turn));
+			turn.type = ServerPacketType::Turn;
+			turn.player = (unsigned char)index;
+			turn.direction = (unsigned char)player.turn;
+			turn.match = state.match;
+			turn.session = player.session;
+
+			if (client.socket.SendTo(serveraddress, &turn, sizeof(turn)))
+			{
+				client.turnssent++;
+				player.isturning = true;
+				player.turntime = now;
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MatchServer.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace GameDev2D
+{
+	const double BOT_JOIN_RESEND_TIME = 0.25; // Seconds between joins until the server answers that the player joined.
+	const float BOT_WALL_DISTANCE = 32.0f; // Pixels from the arena's edge a bot turns away at.
+	const unsigned int BOT_TURN_CHANCE = 30; // One random turn every 30 states on average.
+	const unsigned int BOT_RECEIVE_BATCH = 4096; // States a bot thread takes in at most before it checks for stopping.
+
+	// What the bots saw while they played. Turn latency is the time from sending a turn until a state came back
+	// with the bike going that way.
+	struct BotStats
+	{
+		unsigned int joinedplayers;
+		unsigned long long statesreceived;
+		unsigned long long turnssent;
+		unsigned long long turnsseen;
+		double turnlatencypercentiles[3]; // 50th, 90th and 99th, in seconds.
+	};
+
+	// Clients that play every player of a MatchServer's matches from this process, over loopback, for load tests
+	// without anything outside of it. Each thread has a socket and plays the matches thread % threadcount, steering
+	// from the states it's sent like the benchmarks' scripted driver: away from the walls, and at random now and then.
+	class LoopbackBots
+	{
+	public:
+		// The server must be started, and outlive the bots.
+		LoopbackBots(const MatchServer& server, unsigned int threadcount = 1);
+		~LoopbackBots();
+
+		// Returns false if a socket couldn't be opened, the bots aren't started then.
+		bool Start();
+		void Stop();
+
+		// Only valid once the bots have stopped.
+		BotStats GetStats() const;
+
+	private:
+		struct Player
+		{
+			unsigned int tick; // Of the newest state, older states that come in late are ignored.
+			unsigned int challenge; // The server's answers to the joins.
+			unsigned int session;
+			bool isjoined;
+			bool isturning; // A turn was sent and hasn't shown up in a state yet.
+			Direction turn;
+			double turntime;
+		};
+
+		struct Client
+		{
+			UdpSocket socket;
+			UdpPoller poller;
+			std::vector<unsigned int> matches;
+			std::vector<Player> players; // SERVER_MATCH_PLAYERS per match, in the order of matches.
+			std::vector<float> turnlatencies;
+			unsigned long long statesreceived;
+			unsigned long long turnssent;
+			unsigned int seed;
+		};
+
+		void Run(unsigned int index);
+		void SendJoins(Client& client);
+		void SendJoin(Client& client, unsigned int local, unsigned int player);
+		void ReceivePackets(Client& client);
+		void ReceiveJoinAnswer(Client& client, const JoinPacket& answer);
+		void ReceiveState(Client& client, const StatePacket& state);
+
+		const MatchServer& m_Server;
+		std::vector<Client*> m_Clients;
+		std::vector<std::thread> m_Threads;
+		std::atomic<bool> m_IsStopping;
+	};
+}
@@ -0,0 +1,497 @@
+#include "MatchServer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <math.h>
+#include <random>
+#include <signal.h>
+#include <sstream>
+#include <string.h>
+
+namespace GameDev2D
+{
+	typedef std::chrono::steady_clock ServerClock;
+
+	const double SERVER_TICK_PERIOD = 1.0 / FIXED_TICK_RATE;
+	const double SERVER_PERCENTILES[] = { 50.0, 90.0, 99.0, 99.9 };
+
+	// Set by the interrupt and termination signals, the server mode stops once it sees it.
+	static volatile sig_atomic_t s_IsServerInterrupted = 0;
+
+	static void InterruptServer(int)
+	{
+		s_IsServerInterrupted = 1;
+	}
+
+	static unsigned long long RotateLeft(unsigned long long value, int bits)
+	{
+		return value << bits | value >> (64 - bits);
+	}
+
+	static void SipRound(unsigned long long v[4])
+	{
+		v[0] += v[1];
+		v[1] = RotateLeft(v[1], 13) ^ v[0];
+		v[0] = RotateLeft(v[0], 32);
+		v[2] += v[3];
+		v[3] = RotateLeft(v[3], 16) ^ v[2];
+		v[0] += v[3];
+		v[3] = RotateLeft(v[3], 21) ^ v[0];
+		v[2] += v[1];
+		v[1] = RotateLeft(v[1], 17) ^ v[2];
+		v[2] = RotateLeft(v[2], 32);
+	}
+
+	// SipHash-2-4 of a message of whole 64-bit words, unlike the sim's hashes it can't be run backwards to the key.
+	static unsigned long long SipHash(const unsigned long long key[2], const unsigned long long* words, size_t count)
+	{
+		unsigned long long v[4] = { key[0] ^ 0x736F6D6570736575ull, key[1] ^ 0x646F72616E646F6Dull, key[0] ^ 0x6C7967656E657261ull, key[1] ^ 0x7465646279746573ull };
+
+		for (size_t index = 0; index <= count; index++)
+		{
+			// The last block only holds the message's length in bytes.
+			unsigned long long word = index < count ? words[index] : (unsigned long long)(count * 8) << 56;
+			v[3] ^= word;
+			SipRound(v);
+			SipRound(v);
+			v[0] ^= word;
+		}
+
+		v[2] ^= 0xFF;
+		for (unsigned int round = 0; round < 4; round++)
+			SipRound(v);
+		return v[0] ^ v[1] ^ v[2] ^ v[3];
+	}
+
+	// Returns the value the percentile of the samples are at or under.
+	static double GetPercentile(const std::vector<float>& sorted, double percentile)
+	{
+		if (sorted.empty()) return 0.0;
+
+		size_t rank = (size_t)ceil(percentile * 0.01 * sorted.size());
+		return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+	}
+
+	MatchServer::MatchServer(unsigned int matchcount, unsigned int threadcount, bool isloopback) :
+		m_IsStopping(false),
+		m_MatchCount(matchcount),
+		m_IsLoopback(isloopback),
+		m_Seconds(0.0)
+	{
+		std::random_device random;
+		m_Key[0] = (unsigned long long)random() << 32 | random();
+		m_Key[1] = (unsigned long long)random() << 32 | random();
+
+		if (threadcount == 0)
+			threadcount = std::max(std::thread::hardware_concurrency(), 1u);
+		threadcount = std::max(std::min(threadcount, matchcount), 1u);
+
+		for (unsigned int index = 0; index < threadcount; index++)
+		{
+			Shard* shard = new Shard();
+			shard->busyseconds = 0.0;
+			shard->ticks = 0;
+			shard->lateticks = 0;
+			shard->matchticks = 0;
+			shard->rounds = 0;
+			shard->packetsreceived = 0;
+			shard->packetssent = 0;
+			shard->sendsdropped = 0;
+			shard->sessioncount = 0;
+
+			for (unsigned int match = index; match < matchcount; match += threadcount)
+			{
+				Match state;
+				state.sim = new TraceSim(SERVER_ARENA_WIDTH, SERVER_ARENA_HEIGHT, SERVER_MATCH_PLAYERS);
+				state.joined = 0;
+				state.tick = 0;
+				state.round = 0;
+				state.gameoverticks = 0;
+				state.inputs.reserve(SERVER_MATCH_PLAYERS * 2);
+				memset(state.players, 0, sizeof(state.players));
+				memset(state.sessions, 0, sizeof(state.sessions));
+				shard->matches.push_back(state);
+			}
+
+			m_Shards.push_back(shard);
+		}
+	}
+
+	MatchServer::~MatchServer()
+	{
+		Stop();
+
+		for (Shard* shard : m_Shards)
+		{
+			for (Match& match : shard->matches)
+				delete match.sim;
+			delete shard;
+		}
+	}
+
+	bool MatchServer::Start(unsigned short port)
+	{
+		if (!m_Threads.empty()) return false;
+
+		for (unsigned int index = 0; index < m_Shards.size(); index++)
+		{
+			Shard* shard = m_Shards[index];
+			if (!shard->socket.Open(port != 0 ? (unsigned short)(port + index) : 0, m_IsLoopback))
+			{
+				for (Shard* opened : m_Shards)
+					opened->socket.Close();
+				return false;
+			}
+		}
+
+		m_IsStopping = false;
+		for (unsigned int index = 0; index < m_Shards.size(); index++)
+		{
+			m_Shards[index]->poller.Add(m_Shards[index]->socket);
+			m_Threads.push_back(std::thread(&MatchServer::Run, this, index));
+		}
+
+		return true;
+	}
+
+	void MatchServer::Stop()
+	{
+		if (m_Threads.empty()) return;
+
+		m_IsStopping = true;
+		for (std::thread& thread : m_Threads)
+			thread.join();
+		m_Threads.clear();
+
+		for (Shard* shard : m_Shards)
+			shard->socket.Close();
+	}
+
+	unsigned int MatchServer::GetMatchCount() const
+	{
+		return m_MatchCount;
+	}
+
+	unsigned int MatchServer::GetThreadCount() const
+	{
+		return (unsigned int)m_Shards.size();
+	}
+
+	unsigned short MatchServer::GetMatchPort(unsigned int match) const
+	{
+		return m_Shards[match % m_Shards.size()]->socket.GetPort();
+	}
+
+	ServerStats MatchServer::GetStats() const
+	{
+		ServerStats stats;
+		memset(&stats, 0, sizeof(stats));
+		stats.seconds = m_Seconds;
+
+		std::vector<float> latencies;
+		std::vector<float> works;
+
+		for (const Shard* shard : m_Shards)
+		{
+			stats.busyseconds += shard->busyseconds;
+			stats.ticks += shard->ticks;
+			stats.lateticks += shard->lateticks;
+			stats.matchticks += shard->matchticks;
+			stats.rounds += shard->rounds;
+			stats.packetsreceived += shard->packetsreceived;
+			stats.packetssent += shard->packetssent;
+			stats.sendsdropped += shard->sendsdropped;
+			latencies.insert(latencies.end(), shard->latencies.begin(), shard->latencies.end());
+			works.insert(works.end(), shard->works.begin(), shard->works.end());
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		std::sort(works.begin(), works.end());
+
+		for (unsigned int index = 0; index < 4; index++)
+		{
+			stats.latencypercentiles[index] = GetPercentile(latencies, SERVER_PERCENTILES[index]);
+			stats.workpercentiles[index] = GetPercentile(works, SERVER_PERCENTILES[index]);
+		}
+		stats.latencymax = latencies.empty() ? 0.0 : latencies.back();
+
+		return stats;
+	}
+
+	void MatchServer::Run(unsigned int index)
+	{
+		Shard& shard = *m_Shards[index];
+		ServerClock::time_point start = ServerClock::now();
+		ServerClock::duration period = std::chrono::duration_cast<ServerClock::duration>(std::chrono::duration<double>(SERVER_TICK_PERIOD));
+		ServerClock::time_point deadline = start + period;
+
+		while (!m_IsStopping)
+		{
+			// The poller waits in whole milliseconds, rounded up so it doesn't spin for the last one.
+			ServerClock::time_point now = ServerClock::now();
+			if (now < deadline)
+			{
+				int timeout = (int)ceil(std::chrono::duration<double, std::milli>(deadline - now).count());
+				shard.poller.Wait(timeout);
+			}
+
+			ServerClock::time_point workstart = ServerClock::now();
+			ReceivePackets(shard, index);
+
+			if (workstart >= deadline)
+			{
+				TickMatches(shard, index);
+
+				ServerClock::time_point workend = ServerClock::now();
+				double latency = std::chrono::duration<double>(workend - deadline).count();
+				size_t sample = shard.ticks % SERVER_LATENCY_SAMPLES;
+				if (shard.latencies.size() < SERVER_LATENCY_SAMPLES)
+				{
+					shard.latencies.push_back(0.0f);
+					shard.works.push_back(0.0f);
+				}
+				shard.latencies[sample] = (float)latency;
+				shard.works[sample] = (float)std::chrono::duration<double>(workend - workstart).count();
+
+				shard.ticks++;
+				shard.lateticks += latency >= SERVER_TICK_PERIOD;
+				deadline += period;
+			}
+
+			shard.busyseconds += std::chrono::duration<double>(ServerClock::now() - workstart).count();
+		}
+
+		// Every thread runs about as long, the first one's time is the server's.
+		if (index == 0)
+			m_Seconds = std::chrono::duration<double>(ServerClock::now() - start).count();
+	}
+
+	void MatchServer::ReceivePackets(Shard& shard, unsigned int index)
+	{
+		unsigned int threadcount = (unsigned int)m_Shards.size();
+		char buffer[NET_MAX_DATAGRAM];
+		NetAddress address;
+
+		for (unsigned int count = 0; count < SERVER_RECEIVE_BATCH; count++)
+		{
+			int size = shard.socket.ReceiveFrom(address, buffer, sizeof(buffer));
+			if (size < 0) break;
+
+			shard.packetsreceived++;
+
+			// Anything that isn't for one of this thread's matches is dropped.
+			if (size < (int)sizeof(PacketHeader)) continue;
+
+			PacketHeader header;
+			memcpy(&header, buffer, sizeof(header));
+			if (header.match >= m_MatchCount || header.match % threadcount != index || header.player >= SERVER_MATCH_PLAYERS) continue;
+
+			Match& match = shard.matches[header.match / threadcount];
+			unsigned int bit = 1u << header.player;
+
+			if (header.type == ServerPacketType::Join && size == (int)sizeof(JoinPacket))
+			{
+				JoinPacket join;
+				memcpy(&join, buffer, sizeof(join));
+				ReceiveJoin(shard, match, join, address);
+			}
+			else if (header.type == ServerPacketType::Turn && size == (int)sizeof(TurnPacket))
+			{
+				TurnPacket turn;
+				memcpy(&turn, buffer, sizeof(turn));
+				if ((match.joined & bit) == 0 || !IsSameAddress(match.players[turn.player], address) || turn.session != match.sessions[turn.player] ||
+					turn.direction > (unsigned char)Direction::Down) continue;
+
+				TurnInput input;
+				input.player = turn.player;
+				input.direction = (Direction)turn.direction;
+				input.time = 0.0f;
+				match.inputs.push_back(input);
+			}
+		}
+	}
+
+	void MatchServer::ReceiveJoin(Shard& shard, Match& match, const JoinPacket& join, const NetAddress& address)
+	{
+		unsigned int bit = 1u << join.player;
+		bool isjoined = (match.joined & bit) != 0;
+		if (isjoined && !IsSameAddress(match.players[join.player], address) && join.session != match.sessions[join.player]) return;
+
+		JoinPacket answer = join;
+		unsigned int challenge = GetKeyedHash((unsigned long long)join.match << 8 | join.player, (unsigned long long)address.ip << 16 | address.port);
+
+		if (join.challenge != challenge)
+		{
+			answer.type = ServerPacketType::Challenge;
+			answer.challenge = challenge;
+		}
+		else
+		{
+			// A new session starts with each player that takes the place, the sessions before it can't get it back.
+			if (!isjoined)
+			{
+				match.sessions[join.player] = GetKeyedHash((unsigned long long)join.match << 8 | join.player, ++shard.sessioncount);
+				match.joined |= bit;
+			}
+
+			match.players[join.player] = address;
+			answer.type = ServerPacketType::Joined;
+			answer.session = match.sessions[join.player];
+		}
+
+		if (shard.socket.SendTo(address, &answer, sizeof(answer)))
+			shard.packetssent++;
+		else
+			shard.sendsdropped++;
+	}
+
+	unsigned int MatchServer::GetKeyedHash(unsigned long long first, unsigned long long second) const
+	{
+		unsigned long long words[2] = { first, second };
+		unsigned int hash = (unsigned int)SipHash(m_Key, words, 2);
+		return hash != 0 ? hash : 1;
+	}
+
+	void MatchServer::TickMatches(Shard& shard, unsigned int index)
+	{
+		unsigned int threadcount = (unsigned int)m_Shards.size();
+		unsigned int alljoined = (1u << SERVER_MATCH_PLAYERS) - 1;
+
+		for (unsigned int local = 0; local < shard.matches.size(); local++)
+		{
+			Match& match = shard.matches[local];
+			if (match.joined != alljoined) continue;
+
+			if (match.sim->GetRoundState() == RoundState::GameOver && ++match.gameoverticks >= SERVER_GAME_OVER_TICKS)
+			{
+				match.sim->Reset();
+				match.gameoverticks = 0;
+				match.round++;
+				shard.rounds++;
+			}
+
+			match.sim->Step(SERVER_TICK_PERIOD, match.inputs);
+			match.inputs.clear();
+			match.tick++;
+			shard.matchticks++;
+
+			// The matches take turns sending, rather than all of them every SERVER_SEND_INTERVAL-th tick.
+			if ((match.tick + local) % SERVER_SEND_INTERVAL == 0)
+				SendState(shard, match, index + local * threadcount);
+		}
+	}
+
+	void MatchServer::SendState(Shard& shard, Match& match, unsigned int matchindex)
+	{
+		const BikeStates& bikes = match.sim->GetBikes();
+
+		StatePacket state;
+		memset(&state, 0, sizeof(state));
+		state.type = ServerPacketType::State;
+		state.roundstate = (unsigned char)match.sim->GetRoundState();
+		state.joined = (unsigned char)match.joined;
+		state.match = matchindex;
+		state.tick = match.tick;
+		state.round = match.round;
+		state.statehash = match.sim->GetStateHash();
+
+		for (unsigned int player = 0; player < SERVER_MATCH_PLAYERS; player++)
+		{
+			state.alive |= (unsigned char)(bikes.alive[player] << player);
+			state.x[player] = bikes.fixedx[player];
+			state.y[player] = bikes.fixedy[player];
+			state.directionx[player] = (signed char)bikes.directionx[player];
+			state.directiony[player] = (signed char)bikes.directiony[player];
+		}
+
+		for (unsigned int player = 0; player < SERVER_MATCH_PLAYERS; player++)
+		{
+			if ((match.joined & (1u << player)) == 0) continue;
+
+			if (shard.socket.SendTo(match.players[player], &state, sizeof(state)))
+				shard.packetssent++;
+			else
+				shard.sendsdropped++;
+		}
+	}
+
+	void WriteServerStatsHeader(std::ostream& output)
+	{
+		output << "matches,threads,seconds,ticks_per_thread,late_ticks,match_ticks_per_second,busy_percent,matches_per_core,rounds,packets_received,"
+			"packets_sent,sends_dropped,latency_us_p50,latency_us_p90,latency_us_p99,latency_us_p999,latency_us_max,work_us_p50,work_us_p90,work_us_p99,"
+			"work_us_p999";
+	}
+
+	void WriteServerStats(std::ostream& output, const MatchServer& server, const ServerStats& stats)
+	{
+		// A core stepping matches all the time would keep this many of them at FIXED_TICK_RATE.
+		double matchespercore = stats.busyseconds > 0.0 ? stats.matchticks / stats.busyseconds / FIXED_TICK_RATE : 0.0;
+
+		output << server.GetMatchCount() << "," << server.GetThreadCount() << "," << stats.seconds << "," << stats.ticks / server.GetThreadCount() << ","
+			<< stats.lateticks << "," << stats.matchticks / stats.seconds << "," << stats.busyseconds / (stats.seconds * server.GetThreadCount()) * 100.0 << ","
+			<< matchespercore << "," << stats.rounds << "," << stats.packetsreceived << "," << stats.packetssent << "," << stats.sendsdropped;
+
+		for (double latency : stats.latencypercentiles)
+			output << "," << latency * 1e6;
+		output << "," << stats.latencymax * 1e6;
+		for (double work : stats.workpercentiles)
+			output << "," << work * 1e6;
+	}
+
+	bool RunServerFromCommandLine(const std::string& commandline)
+	{
+		std::stringstream arguments(commandline);
+		std::string argument;
+		bool isserver = false;
+		unsigned int port = SERVER_DEFAULT_PORT;
+		unsigned int matches = SERVER_DEFAULT_MATCHES;
+		unsigned int threads = 0;
+		double seconds = 0.0;
+
+		while (arguments >> argument)
+		{
+			if (argument == "-server")
+				isserver = true;
+			else if (argument == "-port")
+				arguments >> port;
+			else if (argument == "-matches")
+				arguments >> matches;
+			else if (argument == "-threads")
+				arguments >> threads;
+			else if (argument == "-seconds")
+				arguments >> seconds;
+		}
+
+		if (!isserver) return false;
+
+		// The game runs without a console, nothing would end a server that doesn't stop by itself.
+		std::ofstream output(SERVER_STATS_PATH);
+		if (matches == 0 || seconds <= 0.0)
+		{
+			output << "error" << std::endl << "the server needs -seconds to stop after and at least one match" << std::endl;
+			return true;
+		}
+
+		MatchServer server(matches, threads);
+		if (!server.Start((unsigned short)port))
+		{
+			output << "error" << std::endl << "couldn't open the server's sockets from port " << port << std::endl;
+			return true;
+		}
+
+		signal(SIGINT, InterruptServer);
+		signal(SIGTERM, InterruptServer);
+
+		ServerClock::time_point start = ServerClock::now();
+		while (!s_IsServerInterrupted && std::chrono::duration<double>(ServerClock::now() - start).count() < seconds)
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		server.Stop();
+
+		WriteServerStatsHeader(output);
+		output << std::endl;
+		WriteServerStats(output, server, server.GetStats());
+		output << std::endl;
+		return true;
+	}
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "TraceSim.h"
+#include "UdpSocket.h"
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace GameDev2D
+{
+	const unsigned short SERVER_DEFAULT_PORT = 27960; // Each server thread listens on its own port, counting up from this one.
+	const unsigned int SERVER_DEFAULT_MATCHES = 1024;
+	const unsigned int SERVER_MATCH_PLAYERS = PLAYER_COUNT;
+	const float SERVER_ARENA_WIDTH = 1024.0f; // The game's screen.
+	const float SERVER_ARENA_HEIGHT = 768.0f;
+	const unsigned int SERVER_SEND_INTERVAL = 4; // Ticks between the states sent to the players, 60 a second.
+	const unsigned int SERVER_GAME_OVER_TICKS = (unsigned int)FIXED_TICK_RATE; // A finished round is shown for a second before the next.
+	const unsigned int SERVER_RECEIVE_BATCH = 4096; // Packets a thread takes in at most before it checks for its tick again.
+	const unsigned int SERVER_LATENCY_SAMPLES = 65536; // Tick latencies kept per thread, the newest overwrite the oldest.
+	const char* const SERVER_STATS_PATH = "ServerStats.csv"; // Written by the server mode when it stops.
+
+	enum class ServerPacketType : unsigned char
+	{
+		Join,
+		Turn,
+		State,
+		Challenge,
+		Joined,
+	};
+
+	// The packets are sent as they are laid out in memory, the server and its clients are the same build. Joins and
+	// turns both start with the type, player and match, the server reads those before it knows which it has.
+	struct PacketHeader
+	{
+		ServerPacketType type;
+		unsigned char player;
+		unsigned short reserved;
+		unsigned int match;
+	};
+
+	// Takes a player's place in a match, sent again until the server answers that the player joined. A match
+	// starts once every player has joined.
+	//
+	// The server answers a join with a packet of the same layout, only to the address the join came from, so a
+	// join with a forged address can't make it send anything bigger, or anything to somebody else. The first
+	// answer is a challenge, which the client sends back in its next join to show it receives at its address.
+	// Once it does, the server answers that the player joined, with the session that holds the place. A place
+	// that's taken is only given to a join from the same address or with its session, from a client whose
+	// address changed.
+	struct JoinPacket
+	{
+		ServerPacketType type; // Join, Challenge or Joined.
+		unsigned char player;
+		unsigned short reserved;
+		unsigned int match;
+		unsigned int challenge; // 0 until the server sent one.
+		unsigned int session; // 0 until the player joined.
+	};
+
+	// Turns the player's bike at the start of the server's next tick. Only the address that joined as the player,
+	// with its session, can turn its bike.
+	struct TurnPacket
+	{
+		ServerPacketType type;
+		unsigned char player;
+		unsigned char direction; // A Direction, the enum is an int.
+		unsigned char reserved;
+		unsigned int match;
+		unsigned int session;
+	};
+
+	// A match after a tick, sent to its players every SERVER_SEND_INTERVAL ticks.
+	struct StatePacket
+	{
+		ServerPacketType type;
+		unsigned char roundstate; // A RoundState.
+		unsigned char alive; // A bit per player.
+		unsigned char joined; // A bit per player.
+		unsigned int match;
+		unsigned int tick; // Ticks the match has been stepped.
+		unsigned int round;
+		int x[SERVER_MATCH_PLAYERS]; // Fixed point units.
+		int y[SERVER_MATCH_PLAYERS];
+		signed char directionx[SERVER_MATCH_PLAYERS];
+		signed char directiony[SERVER_MATCH_PLAYERS];
+		unsigned long long statehash;
+	};
+
+	// What the server did while it ran, summed over its threads. Tick latency is the time from a tick's deadline
+	// until every match of the thread was stepped and its states sent, tick work leaves out the time the thread
+	// woke up late.
+	struct ServerStats
+	{
+		double seconds; // From start to stop.
+		double busyseconds; // Receiving, stepping and sending, summed over the threads.
+		unsigned long long ticks; // Ticks of each thread, summed.
+		unsigned long long lateticks; // Ticks that finished a whole tick after their deadline.
+		unsigned long long matchticks; // Steps of running matches.
+		unsigned long long rounds;
+		unsigned long long packetsreceived;
+		unsigned long long packetssent;
+		unsigned long long sendsdropped;
+		double latencypercentiles[4]; // 50th, 90th, 99th and 99.9th, in seconds.
+		double latencymax;
+		double workpercentiles[4];
+	};
+
+	// A headless authoritative server: every match is a TraceSim stepped at FIXED_TICK_RATE, the players only send
+	// their joins and turns and are sent the match's state. The matches are split over a few threads, a match is
+	// played by thread match % threadcount. Each thread has a UDP socket of its own, waits on it with a UdpPoller
+	// until its next tick or a packet comes in, and steps all of its matches every tick.
+	class MatchServer
+	{
+	public:
+		// A thread count of 0 starts one thread per hardware thread. The loopback server only takes packets from
+		// this machine.
+		MatchServer(unsigned int matchcount, unsigned int threadcount = 0, bool isloopback = false);
+		~MatchServer();
+
+		// Opens a socket per thread, on port, port + 1 and so on, or on any free ports for port 0, and starts the
+		// threads. Returns false if a socket couldn't be opened, the server isn't started then.
+		bool Start(unsigned short port);
+		void Stop();
+
+		unsigned int GetMatchCount() const;
+		unsigned int GetThreadCount() const;
+
+		// The port a match's players send to, once started.
+		unsigned short GetMatchPort(unsigned int match) const;
+
+		// Only valid once the server has stopped.
+		ServerStats GetStats() const;
+
+	private:
+		struct Match
+		{
+			TraceSim* sim;
+			NetAddress players[SERVER_MATCH_PLAYERS];
+			unsigned int sessions[SERVER_MATCH_PLAYERS];
+			unsigned int joined; // A bit per player.
+			unsigned int tick;
+			unsigned int round;
+			unsigned int gameoverticks; // Ticks the round has been over.
+			std::vector<TurnInput> inputs; // The turns for the next tick.
+		};
+
+		struct Shard
+		{
+			UdpSocket socket;
+			UdpPoller poller;
+			std::vector<Match> matches; // Thread index's matches, match index + n * threadcount is matches[n].
+			std::vector<float> latencies; // Ring buffers of SERVER_LATENCY_SAMPLES.
+			std::vector<float> works;
+			double busyseconds;
+			unsigned long long ticks;
+			unsigned long long lateticks;
+			unsigned long long matchticks;
+			unsigned long long rounds;
+			unsigned long long packetsreceived;
+			unsigned long long packetssent;
+			unsigned long long sendsdropped;
+			unsigned long long sessioncount; // Sessions started, hashed into the next one.
+		};
+
+		void Run(unsigned int index);
+		void ReceivePackets(Shard& shard, unsigned int index);
+		void TickMatches(Shard& shard, unsigned int index);
+		void SendState(Shard& shard, Match& match, unsigned int matchindex);
+
+		// Answers a join with a challenge until it sends the address's challenge back, then joins the player.
+		void ReceiveJoin(Shard& shard, Match& match, const JoinPacket& join, const NetAddress& address);
+
+		// A keyed hash of the values, the server's secret key is random so the hashes can't be worked out from
+		// the ones sent to other addresses. Never 0.
+		unsigned int GetKeyedHash(unsigned long long first, unsigned long long second) const;
+
+		std::vector<Shard*> m_Shards; // Shards hold sockets, they can't be moved when the vector grows.
+		std::vector<std::thread> m_Threads;
+		std::atomic<bool> m_IsStopping;
+		unsigned int m_MatchCount;
+		bool m_IsLoopback;
+		double m_Seconds;
+		unsigned long long m_Key[2]; // Random, for the challenges and sessions.
+	};
+
+	// Runs the headless server mode if it's on the command line ("-server"), with "-seconds <seconds>" to stop after,
+	// "-port <port>", "-matches <count>" and "-threads <count>". It stops early on an interrupt or termination
+	// signal, where the process gets them. The stats are written to SERVER_STATS_PATH when it stops, or the error
+	// if the server couldn't run, there's no console to report it on. Returns false if no server was requested.
+	bool RunServerFromCommandLine(const std::string& commandline);
+
+	// Writes the stats of a server run as a csv row, and the header for them.
+	void WriteServerStatsHeader(std::ostream& output);
+	void WriteServerStats(std::ostream& output, const MatchServer& server, const ServerStats& stats);
+}
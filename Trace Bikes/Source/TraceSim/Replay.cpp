@@ -0,0 +1,281 @@
+#include "Replay.h"
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GameDev2D
+{
+	ReplayRecorder::ReplayRecorder(const std::string& path, const TraceSim& sim) :
+		m_Sim(sim),
+		m_Output(path, std::ios::binary | std::ios::trunc),
+		m_RoundState(sim.GetRoundState())
+	{
+		memcpy(m_Header.magic, REPLAY_MAGIC, sizeof(m_Header.magic));
+		m_Header.version = REPLAY_VERSION;
+		m_Header.playercount = sim.GetPlayerCount();
+		m_Header.tickrate = (unsigned int)FIXED_TICK_RATE;
+		m_Header.arenawidth = sim.GetArenaWidth();
+		m_Header.arenaheight = sim.GetArenaHeight();
+		m_Header.tickcount = 0;
+		m_Header.reserved = 0;
+		m_Header.statehash = 0;
+
+		m_Buffer.reserve(REPLAY_BUFFER_RECORDS);
+
+		// The header is written again with the tick count and state hash when the recording is closed.
+		if (m_Output.is_open())
+			m_Output.write((const char*)&m_Header, sizeof(m_Header));
+	}
+
+	ReplayRecorder::~ReplayRecorder()
+	{
+		Close();
+	}
+
+	bool ReplayRecorder::IsRecording() const
+	{
+		return m_Output.is_open();
+	}
+
+	void ReplayRecorder::RecordStep(const std::vector<TurnInput>& inputs)
+	{
+		for (const TurnInput& input : inputs)
+		{
+			// Stored the way the sim rounds it, a replayed turn lands on the same subtick.
+			long long subtick = llroundf(input.time * FIXED_SUBTICKS_PER_SECOND);
+			subtick = std::min(std::max(subtick, (long long)SHRT_MIN), (long long)SHRT_MAX);
+
+			AddRecord((short)subtick, input.player, (ReplayEvent)input.direction);
+		}
+
+		if (m_RoundState != RoundState::Running && m_Sim.GetRoundState() == RoundState::Running)
+			AddRecord(0, 0, ReplayEvent::RoundStart);
+
+		m_RoundState = m_Sim.GetRoundState();
+		m_Header.statehash = FoldStateHash(m_Header.statehash, m_Sim.GetStateHash());
+		m_Header.tickcount++;
+	}
+
+	void ReplayRecorder::RecordReset()
+	{
+		AddRecord((short)std::min(m_Sim.GetTrailLimit(), (unsigned int)SHRT_MAX), 0, ReplayEvent::Reset);
+		m_RoundState = m_Sim.GetRoundState();
+	}
+
+	void ReplayRecorder::Close()
+	{
+		if (!m_Output.is_open()) return;
+
+		Flush();
+
+		m_Output.seekp(0);
+		m_Output.write((const char*)&m_Header, sizeof(m_Header));
+		m_Output.close();
+	}
+
+	void ReplayRecorder::AddRecord(short subtick, unsigned int player, ReplayEvent event)
+	{
+		if (!m_Output.is_open()) return;
+
+		ReplayRecord record;
+		record.tick = m_Header.tickcount;
+		record.subtick = subtick;
+		record.player = (unsigned char)player;
+		record.event = event;
+		m_Buffer.push_back(record);
+
+		if (m_Buffer.size() >= REPLAY_BUFFER_RECORDS)
+			Flush();
+	}
+
+	void ReplayRecorder::Flush()
+	{
+		if (!m_Buffer.empty())
+			m_Output.write((const char*)m_Buffer.data(), m_Buffer.size() * sizeof(ReplayRecord));
+
+		m_Buffer.clear();
+	}
+
+	ReplayFile::ReplayFile() :
+		m_Data(nullptr),
+		m_Size(0) { }
+
+	ReplayFile::~ReplayFile()
+	{
+		Close();
+	}
+
+	bool ReplayFile::Open(const std::string& path)
+	{
+		Close();
+
+		// The file and mapping handles can be closed once the view is mapped, the view keeps the file open.
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		HANDLE mapping = NULL;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapping == NULL) return false;
+
+		m_Data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		m_Size = m_Data != nullptr ? (size_t)size.QuadPart : 0;
+		CloseHandle(mapping);
+#else
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0) return false;
+
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+			data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED) return false;
+
+		m_Data = (const char*)data;
+		m_Size = (size_t)status.st_size;
+#endif
+
+		// Only whole records after a header this version wrote.
+		const ReplayHeader* header = (const ReplayHeader*)m_Data;
+		if (m_Data == nullptr || m_Size < sizeof(ReplayHeader) || memcmp(header->magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 ||
+			header->version != REPLAY_VERSION || (m_Size - sizeof(ReplayHeader)) % sizeof(ReplayRecord) != 0)
+		{
+			Close();
+			return false;
+		}
+
+		// The sim is constructed and stepped from the header, a tick rate of 0 would step it by an infinite delta. The
+		// comparisons are written so that a NaN size fails them.
+		if (header->playercount == 0 || header->playercount > REPLAY_MAX_PLAYERS || header->tickrate == 0 ||
+			!(header->arenawidth > 0.0f && header->arenawidth <= REPLAY_MAX_ARENA_SIZE) ||
+			!(header->arenaheight > 0.0f && header->arenaheight <= REPLAY_MAX_ARENA_SIZE))
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void ReplayFile::Close()
+	{
+		if (m_Data == nullptr) return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+#else
+		munmap((void*)m_Data, m_Size);
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	const ReplayHeader& ReplayFile::GetHeader() const
+	{
+		return *(const ReplayHeader*)m_Data;
+	}
+
+	const ReplayRecord* ReplayFile::GetRecords() const
+	{
+		return (const ReplayRecord*)(m_Data + sizeof(ReplayHeader));
+	}
+
+	size_t ReplayFile::GetRecordCount() const
+	{
+		return m_Data != nullptr ? (m_Size - sizeof(ReplayHeader)) / sizeof(ReplayRecord) : 0;
+	}
+
+	ReplayPlayer::ReplayPlayer(const ReplayFile& replay, TraceSim& sim) :
+		m_Replay(replay),
+		m_Sim(sim),
+		m_Tick(0),
+		m_NextRecord(0),
+		m_IsDesynced(false),
+		m_StateHash(0)
+	{
+		const ReplayHeader& header = replay.GetHeader();
+		m_Inputs.reserve(header.playercount);
+
+		if (sim.GetPlayerCount() != header.playercount || sim.GetArenaWidth() != header.arenawidth || sim.GetArenaHeight() != header.arenaheight)
+		{
+			m_IsDesynced = true;
+			m_Tick = header.tickcount;
+		}
+	}
+
+	bool ReplayPlayer::StepTick()
+	{
+		const ReplayHeader& header = m_Replay.GetHeader();
+		if (m_Tick >= header.tickcount) return false;
+
+		const ReplayRecord* records = m_Replay.GetRecords();
+		size_t count = m_Replay.GetRecordCount();
+		m_Inputs.clear();
+
+		// The tick's resets and turns, in the order they were recorded.
+		for (; m_NextRecord < count && records[m_NextRecord].tick == m_Tick && records[m_NextRecord].event != ReplayEvent::RoundStart; m_NextRecord++)
+		{
+			const ReplayRecord& record = records[m_NextRecord];
+
+			if (record.event == ReplayEvent::Reset)
+			{
+				if (m_Sim.GetRoundState() == RoundState::Running)
+					m_IsDesynced = true;
+
+				m_Sim.SetTrailLimit((unsigned int)std::max(record.subtick, (short)0));
+				m_Sim.Reset();
+				continue;
+			}
+
+			TurnInput input;
+			input.player = record.player;
+			input.direction = (Direction)record.event;
+			input.time = (float)record.subtick / FIXED_SUBTICKS_PER_SECOND;
+			m_Inputs.push_back(input);
+		}
+
+		RoundState roundstate = m_Sim.GetRoundState();
+		m_Sim.Step(1.0 / header.tickrate, m_Inputs);
+
+		// A round start is recorded after the tick that started it.
+		bool roundstarted = roundstate != RoundState::Running && m_Sim.GetRoundState() == RoundState::Running;
+		bool recordedstart = m_NextRecord < count && records[m_NextRecord].tick == m_Tick && records[m_NextRecord].event == ReplayEvent::RoundStart;
+		if (recordedstart)
+			m_NextRecord++;
+		if (roundstarted != recordedstart)
+			m_IsDesynced = true;
+
+		m_StateHash = FoldStateHash(m_StateHash, m_Sim.GetStateHash());
+		m_Tick++;
+
+		if (m_Tick == header.tickcount && m_StateHash != header.statehash)
+			m_IsDesynced = true;
+
+		return true;
+	}
+
+	unsigned int ReplayPlayer::GetTick() const
+	{
+		return m_Tick;
+	}
+
+	bool ReplayPlayer::IsDesynced() const
+	{
+		return m_IsDesynced;
+	}
+}
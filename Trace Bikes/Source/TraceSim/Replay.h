@@ -0,0 +1,131 @@
+#pragma once
+
+#include "TraceSim.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace GameDev2D
+{
+	const char REPLAY_MAGIC[4] = { 'T', 'B', 'R', 'P' };
+	const unsigned int REPLAY_VERSION = 1;
+	const unsigned int REPLAY_BUFFER_RECORDS = 4096; // The recorder writes to disk in blocks of this many records.
+	const unsigned int REPLAY_MAX_PLAYERS = 256; // A record's player is a byte.
+	const float REPLAY_MAX_ARENA_SIZE = 16384.0f; // Pixels on either side, larger than any arena the game or the benchmarks play.
+	const char* const MATCH_REPLAY_PATH = "Match.replay"; // Game records the match being played here, in the working directory.
+
+	// What a replay record holds, the turns are in Direction order.
+	enum class ReplayEvent : unsigned char
+	{
+		TurnLeft,
+		TurnRight,
+		TurnUp,
+		TurnDown,
+		Reset, // The sim was reset before the tick, with the trail limit it had then.
+		RoundStart, // The round was running after the tick, playback checks it.
+	};
+
+	// The start of a replay file, followed by the records in tick order. Both are written as they are laid out
+	// in memory, so playback can read them straight from the mapped file.
+	struct ReplayHeader
+	{
+		char magic[4];
+		unsigned int version;
+		unsigned int playercount;
+		unsigned int tickrate; // Every tick is stepped with a delta of 1 / tickrate.
+		float arenawidth;
+		float arenaheight;
+		unsigned int tickcount; // Filled in when the recording is closed.
+		unsigned int reserved;
+		unsigned long long statehash; // The sim's state hash after every tick, folded together by FoldStateHash().
+	};
+
+	struct ReplayRecord
+	{
+		unsigned int tick;
+		short subtick; // For turns, subticks from the start of the tick the turn was made, negative if before it. For resets, the trail limit.
+		unsigned char player;
+		ReplayEvent event;
+	};
+
+	// Folds a tick's state hash into the hash of the ticks before it.
+	inline unsigned long long FoldStateHash(unsigned long long hash, unsigned long long statehash) { return (hash ^ statehash) * 0x100000001B3ull; }
+
+	// Writes the inputs of a match to a replay file as it's played. The sim must be freshly constructed, or just
+	// reset, when the recording starts and must be stepped once per tick with a delta of 1 / FIXED_TICK_RATE.
+	// The recorder must be closed or deleted before the sim is.
+	class ReplayRecorder
+	{
+	public:
+		ReplayRecorder(const std::string& path, const TraceSim& sim);
+		~ReplayRecorder();
+
+		// Returns false if the file couldn't be opened, nothing is recorded then.
+		bool IsRecording() const;
+
+		// Call after every step with the turns it was handed, and after every reset of the sim.
+		void RecordStep(const std::vector<TurnInput>& inputs);
+		void RecordReset();
+
+		// Writes what's left and fills in the header.
+		void Close();
+
+	private:
+		void AddRecord(short subtick, unsigned int player, ReplayEvent event);
+		void Flush();
+
+		const TraceSim& m_Sim;
+		std::ofstream m_Output;
+		ReplayHeader m_Header; // Its tick count is the tick being recorded.
+		RoundState m_RoundState; // The sim's round state after the last step.
+		std::vector<ReplayRecord> m_Buffer;
+	};
+
+	// A replay file mapped into memory, read only. The records are used in place, nothing is parsed or copied.
+	class ReplayFile
+	{
+	public:
+		ReplayFile();
+		~ReplayFile();
+
+		// Returns false if the file can't be mapped or isn't a replay, or its header describes a match the sim can't
+		// be constructed for: no players or more than a record can name, a tick rate of 0, or an arena that isn't
+		// between 0 and REPLAY_MAX_ARENA_SIZE on both sides.
+		bool Open(const std::string& path);
+		void Close();
+
+		const ReplayHeader& GetHeader() const;
+		const ReplayRecord* GetRecords() const;
+		size_t GetRecordCount() const;
+
+	private:
+		const char* m_Data;
+		size_t m_Size;
+	};
+
+	// Feeds a replay's inputs to a sim tick by tick. The sim must be freshly constructed from the replay's header,
+	// a sim with a different player count or arena is desynced from the start and isn't stepped.
+	class ReplayPlayer
+	{
+	public:
+		ReplayPlayer(const ReplayFile& replay, TraceSim& sim);
+
+		// Steps the sim through the next tick. Returns false once every tick has been played.
+		bool StepTick();
+
+		unsigned int GetTick() const;
+
+		// Returns wether the sim didn't play out like the recorded match: a round started on a different tick, a reset
+		// came before the round was over, or the state hashes didn't match.
+		bool IsDesynced() const;
+
+	private:
+		const ReplayFile& m_Replay;
+		TraceSim& m_Sim;
+		unsigned int m_Tick;
+		size_t m_NextRecord;
+		bool m_IsDesynced;
+		unsigned long long m_StateHash;
+		std::vector<TurnInput> m_Inputs;
+	};
+}
@@ -0,0 +1,468 @@
+#include "SnapshotCodec.h"
+#include "BitStream.h"
+#include <algorithm>
+
+namespace GameDev2D
+{
+	// Bits per varint group, picked for what each value usually is.
+	const unsigned int SNAPSHOT_SMALL_BITS = 1; // Runs added since the baseline, mostly none.
+	const unsigned int SNAPSHOT_DELTA_BITS = 3; // Differences from a prediction, mostly none.
+	const unsigned int SNAPSHOT_LENGTH_BITS = 6; // Run lengths, a few hundred pixels at most.
+	const unsigned int SNAPSHOT_VALUE_BITS = 8; // Values sent as they are in full snapshots.
+
+	static void WriteDirection(BitWriter& writer, int directionx, int directiony)
+	{
+		writer.WriteBool(directionx != 0 || directiony != 0);
+		if (directionx != 0)
+			writer.WriteBits((unsigned int)(directionx < 0 ? Direction::Left : Direction::Right), 2);
+		else if (directiony != 0)
+			writer.WriteBits((unsigned int)(directiony > 0 ? Direction::Up : Direction::Down), 2);
+	}
+
+	static void ReadDirection(BitReader& reader, int& directionx, int& directiony)
+	{
+		directionx = 0;
+		directiony = 0;
+		if (!reader.ReadBool()) return;
+
+		switch ((Direction)reader.ReadBits(2))
+		{
+		case Direction::Left:
+			directionx = -1;
+			break;
+		case Direction::Right:
+			directionx = 1;
+			break;
+		case Direction::Up:
+			directiony = 1;
+			break;
+		case Direction::Down:
+			directiony = -1;
+			break;
+		}
+	}
+
+	// A run is written as the difference from the one before it, which it starts where the bike turned, at the time
+	// the bike got there. The trail's first run is written as it is. Runs are axis-aligned, the end is a length.
+	static void WriteRun(BitWriter& writer, const TrailRun& run, const TrailRun* previous)
+	{
+		if (previous == nullptr)
+		{
+			writer.WriteSigned(run.startx, SNAPSHOT_VALUE_BITS);
+			writer.WriteSigned(run.starty, SNAPSHOT_VALUE_BITS);
+			writer.WriteSigned(run.time, SNAPSHOT_VALUE_BITS);
+		}
+		else
+		{
+			long long time = previous->time + previous->GetLength();
+			bool isjoined = run.startx == previous->endx && run.starty == previous->endy && run.time == time;
+			writer.WriteBool(isjoined);
+
+			if (!isjoined)
+			{
+				writer.WriteSigned(run.startx - previous->endx, SNAPSHOT_DELTA_BITS);
+				writer.WriteSigned(run.starty - previous->endy, SNAPSHOT_DELTA_BITS);
+				writer.WriteSigned(run.time - time, SNAPSHOT_DELTA_BITS);
+			}
+		}
+
+		bool isvertical = run.endx == run.startx;
+		writer.WriteBool(isvertical);
+		writer.WriteSigned(isvertical ? run.endy - run.starty : run.endx - run.startx, SNAPSHOT_LENGTH_BITS);
+	}
+
+	static void ReadRun(BitReader& reader, TrailRun& run, const TrailRun* previous)
+	{
+		if (previous == nullptr)
+		{
+			run.startx = (int)reader.ReadSigned(SNAPSHOT_VALUE_BITS);
+			run.starty = (int)reader.ReadSigned(SNAPSHOT_VALUE_BITS);
+			run.time = reader.ReadSigned(SNAPSHOT_VALUE_BITS);
+		}
+		else
+		{
+			run.startx = previous->endx;
+			run.starty = previous->endy;
+			run.time = previous->time + previous->GetLength();
+
+			if (!reader.ReadBool())
+			{
+				run.startx += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+				run.starty += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+				run.time += reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+			}
+		}
+
+		run.endx = run.startx;
+		run.endy = run.starty;
+		if (reader.ReadBool())
+			run.endy += (int)reader.ReadSigned(SNAPSHOT_LENGTH_BITS);
+		else
+			run.endx += (int)reader.ReadSigned(SNAPSHOT_LENGTH_BITS);
+	}
+
+	// The newest run follows the bike, so its head is only written if it's somewhere else.
+	static void WriteHead(BitWriter& writer, int x, int y, const TrailRun& newest)
+	{
+		bool isatend = x == newest.endx && y == newest.endy;
+		writer.WriteBool(isatend);
+
+		if (!isatend)
+		{
+			writer.WriteSigned(x - newest.endx, SNAPSHOT_DELTA_BITS);
+			writer.WriteSigned(y - newest.endy, SNAPSHOT_DELTA_BITS);
+		}
+	}
+
+	static void ReadHead(BitReader& reader, int& x, int& y, const TrailRun& newest)
+	{
+		x = newest.endx;
+		y = newest.endy;
+
+		if (!reader.ReadBool())
+		{
+			x += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+			y += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+		}
+	}
+
+	// Where the baseline's newest run is expected to end now: carried on as far as the round went, unless the bike
+	// turned off it since.
+	static void PredictNewestEnd(const TrailRun& newest, int directionx, int directiony, long long subticks, bool isturned, int& x, int& y)
+	{
+		x = newest.endx;
+		y = newest.endy;
+
+		if (!isturned)
+		{
+			x += directionx * (int)subticks;
+			y += directiony * (int)subticks;
+		}
+	}
+
+	ReplicaState::ReplicaState() :
+		tick(0),
+		round(0),
+		roundstate(RoundState::Unknown),
+		time(0),
+		countdown(0.0f),
+		traillimit(0)
+	{
+	}
+
+	static void ClearHistory(SnapshotBaseline* history)
+	{
+		for (unsigned int slot = 0; slot < SNAPSHOT_HISTORY; slot++)
+		{
+			history[slot].tick = 0;
+			history[slot].issaved = false;
+			history[slot].round = 0;
+			history[slot].time = 0;
+		}
+	}
+
+	SnapshotEncoder::SnapshotEncoder() :
+		m_AckedTick(0),
+		m_IsAcked(false),
+		m_WasFull(false)
+	{
+		ClearHistory(m_History);
+	}
+
+	void SnapshotEncoder::Encode(const TraceSim& sim, unsigned int tick, std::vector<unsigned char>& output)
+	{
+		const BikeStates& bikes = sim.GetBikes();
+		unsigned int count = bikes.GetCount();
+		RoundState roundstate = sim.GetRoundState();
+
+		// The acked tick is the baseline if it's still in the history, it's looked up before this tick takes its slot.
+		const SnapshotBaseline* baseline = &m_History[m_AckedTick % SNAPSHOT_HISTORY];
+		if (!m_IsAcked || tick <= m_AckedTick || tick - m_AckedTick >= SNAPSHOT_HISTORY || !baseline->issaved || baseline->tick != m_AckedTick)
+			baseline = nullptr;
+
+		// The trails start over in a new round. A limited trail can also have dropped the baseline's newest run
+		// since, if the bike turned more times than the limit.
+		if (baseline != nullptr && (baseline->round != sim.GetRound() || baseline->runcounts.size() != count))
+			baseline = nullptr;
+
+		for (unsigned int player = 0; player < count && baseline != nullptr; player++)
+		{
+			const TrailBuffer& trail = bikes.trail[player];
+			unsigned long long runcount = baseline->runcounts[player];
+			if (runcount == 0 || runcount > trail.GetAddedCount() || runcount - 1 < trail.GetAddedCount() - trail.GetCount())
+				baseline = nullptr;
+		}
+
+		m_WasFull = baseline == nullptr;
+
+		output.clear();
+		BitWriter writer(output);
+		writer.WriteBits(tick, 32);
+		writer.WriteBool(baseline != nullptr);
+
+		// The round's time goes on a tick at a time while it's running.
+		long long time = 0;
+		if (baseline == nullptr)
+		{
+			writer.WriteVarint(count, SNAPSHOT_VALUE_BITS);
+			writer.WriteVarint(sim.GetRound(), SNAPSHOT_VALUE_BITS);
+			writer.WriteVarint(count > 0 ? bikes.trail[0].GetLimit() : 0, SNAPSHOT_VALUE_BITS);
+		}
+		else
+		{
+			unsigned int ticks = tick - m_AckedTick;
+			writer.WriteVarint(ticks, SNAPSHOT_DELTA_BITS);
+			time = baseline->time + (roundstate == RoundState::Running ? FIXED_SUBTICKS * ticks : 0);
+		}
+
+		writer.WriteBits((unsigned int)roundstate, 2);
+		writer.WriteSigned(sim.GetTime() - time, baseline != nullptr ? SNAPSHOT_DELTA_BITS : SNAPSHOT_VALUE_BITS);
+		if (roundstate == RoundState::Starting)
+			writer.WriteBits((unsigned int)(std::min(std::max(sim.GetCountdownPercentage(), 0.0f), 1.0f) * 255.0f + 0.5f), 8);
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			int directionx = bikes.directionx[player];
+			int directiony = bikes.directiony[player];
+			writer.WriteBool(bikes.alive[player] != 0);
+			WriteDirection(writer, directionx, directiony);
+
+			const TrailBuffer& trail = bikes.trail[player];
+			unsigned long long addedcount = trail.GetAddedCount();
+			unsigned long long oldest = addedcount - trail.GetCount(); // Added count of the trail's first run.
+			unsigned long long next = oldest;
+
+			if (baseline == nullptr)
+			{
+				writer.WriteVarint(addedcount, SNAPSHOT_VALUE_BITS);
+				writer.WriteVarint(trail.GetCount(), SNAPSHOT_VALUE_BITS);
+			}
+			else
+			{
+				// The baseline's newest run has grown or been cut short since, and a turn before it moved starts it later.
+				unsigned long long runcount = baseline->runcounts[player];
+				writer.WriteVarint(addedcount - runcount, SNAPSHOT_SMALL_BITS);
+
+				const TrailRun& acked = baseline->newestruns[player];
+				const TrailRun& run = trail[(size_t)(runcount - 1 - oldest)];
+				int x;
+				int y;
+				PredictNewestEnd(acked, directionx, directiony, sim.GetTime() - baseline->time, addedcount != runcount, x, y);
+
+				bool ispredicted = run.endx == x && run.endy == y && run.time == acked.time;
+				writer.WriteBool(ispredicted);
+
+				if (!ispredicted)
+				{
+					writer.WriteSigned(run.endx - x, SNAPSHOT_DELTA_BITS);
+					writer.WriteSigned(run.endy - y, SNAPSHOT_DELTA_BITS);
+					writer.WriteSigned(run.time - acked.time, SNAPSHOT_DELTA_BITS);
+				}
+				next = runcount;
+			}
+
+			for (unsigned long long index = next; index < addedcount; index++)
+			{
+				size_t position = (size_t)(index - oldest);
+				WriteRun(writer, trail[position], position > 0 ? &trail[position - 1] : nullptr);
+			}
+
+			WriteHead(writer, bikes.fixedx[player], bikes.fixedy[player], trail.GetNewest());
+		}
+
+		writer.Flush();
+
+		// Kept for the deltas from this tick, once the client acks it.
+		SnapshotBaseline& saved = m_History[tick % SNAPSHOT_HISTORY];
+		saved.tick = tick;
+		saved.issaved = true;
+		saved.round = sim.GetRound();
+		saved.time = sim.GetTime();
+		saved.runcounts.resize(count);
+		saved.newestruns.resize(count);
+		for (unsigned int player = 0; player < count; player++)
+		{
+			saved.runcounts[player] = bikes.trail[player].GetAddedCount();
+			saved.newestruns[player] = bikes.trail[player].GetNewest();
+		}
+	}
+
+	void SnapshotEncoder::Acknowledge(unsigned int tick)
+	{
+		if (!m_IsAcked || tick > m_AckedTick)
+		{
+			m_AckedTick = tick;
+			m_IsAcked = true;
+		}
+	}
+
+	void SnapshotEncoder::ForgetAcks()
+	{
+		m_IsAcked = false;
+	}
+
+	bool SnapshotEncoder::WasFull() const
+	{
+		return m_WasFull;
+	}
+
+	SnapshotDecoder::SnapshotDecoder() :
+		m_IsValid(false)
+	{
+		ClearHistory(m_History);
+	}
+
+	bool SnapshotDecoder::Decode(const unsigned char* data, size_t size)
+	{
+		BitReader reader(data, size);
+		unsigned int tick = reader.ReadBits(32);
+		bool isdelta = reader.ReadBool();
+		if (reader.IsOverrun() || (m_IsValid && tick <= m_State.tick)) return false;
+
+		const SnapshotBaseline* baseline = nullptr;
+		if (isdelta)
+		{
+			unsigned int ticks = (unsigned int)reader.ReadVarint(SNAPSHOT_DELTA_BITS);
+			baseline = &m_History[(tick - ticks) % SNAPSHOT_HISTORY];
+			if (!m_IsValid || reader.IsOverrun() || ticks == 0 || !baseline->issaved || baseline->tick != tick - ticks) return false;
+
+			// Every trail has to still have the baseline's newest run to be cut back to it.
+			unsigned int count = (unsigned int)m_State.trails.size();
+			if (baseline->round != m_State.round || baseline->runcounts.size() != count) return false;
+
+			for (unsigned int player = 0; player < count; player++)
+			{
+				unsigned long long runcount = baseline->runcounts[player];
+				unsigned long long oldest = m_State.runcounts[player] - m_State.trails[player].size();
+				if (runcount <= oldest || runcount > m_State.runcounts[player])
+					return false;
+			}
+		}
+
+		// From here on the state is changed, a broken snapshot loses it.
+		m_IsValid = false;
+
+		long long time = 0;
+		if (baseline == nullptr)
+		{
+			unsigned long long count = reader.ReadVarint(SNAPSHOT_VALUE_BITS);
+			m_State.round = (unsigned int)reader.ReadVarint(SNAPSHOT_VALUE_BITS);
+			m_State.traillimit = (unsigned int)reader.ReadVarint(SNAPSHOT_VALUE_BITS);
+
+			// Every bike takes a few bits, a count the snapshot can't hold is broken.
+			if (reader.IsOverrun() || count > size * 8) return false;
+
+			m_State.fixedx.resize((size_t)count);
+			m_State.fixedy.resize((size_t)count);
+			m_State.directionx.resize((size_t)count);
+			m_State.directiony.resize((size_t)count);
+			m_State.alive.resize((size_t)count);
+			m_State.trails.resize((size_t)count);
+			m_State.runcounts.resize((size_t)count);
+		}
+
+		m_State.roundstate = (RoundState)reader.ReadBits(2);
+		if (baseline != nullptr)
+			time = baseline->time + (m_State.roundstate == RoundState::Running ? FIXED_SUBTICKS * (tick - baseline->tick) : 0);
+		m_State.time = time + reader.ReadSigned(baseline != nullptr ? SNAPSHOT_DELTA_BITS : SNAPSHOT_VALUE_BITS);
+		m_State.countdown = m_State.roundstate == RoundState::Starting ? reader.ReadBits(8) / 255.0f : 1.0f;
+
+		unsigned int count = (unsigned int)m_State.trails.size();
+		for (unsigned int player = 0; player < count; player++)
+		{
+			m_State.alive[player] = reader.ReadBool() ? 1 : 0;
+			ReadDirection(reader, m_State.directionx[player], m_State.directiony[player]);
+
+			if (!DecodeTrail(reader, player, baseline) || m_State.trails[player].empty()) return false;
+			ReadHead(reader, m_State.fixedx[player], m_State.fixedy[player], m_State.trails[player].back());
+		}
+
+		if (reader.IsOverrun()) return false;
+
+		m_State.tick = tick;
+		m_IsValid = true;
+		Save(m_History[tick % SNAPSHOT_HISTORY], tick);
+		return true;
+	}
+
+	bool SnapshotDecoder::DecodeTrail(BitReader& reader, unsigned int player, const SnapshotBaseline* baseline)
+	{
+		std::deque<TrailRun>& trail = m_State.trails[player];
+		unsigned long long& runcount = m_State.runcounts[player];
+		unsigned long long addedcount;
+
+		if (baseline == nullptr)
+		{
+			addedcount = reader.ReadVarint(SNAPSHOT_VALUE_BITS);
+			unsigned long long count = reader.ReadVarint(SNAPSHOT_VALUE_BITS);
+			if (reader.IsOverrun() || count > addedcount) return false;
+
+			trail.clear();
+			runcount = addedcount - count;
+		}
+		else
+		{
+			// Cut the trail back to the baseline's runs, with its newest as it was then, and bring that one up to date.
+			unsigned long long ackedcount = baseline->runcounts[player];
+			trail.resize(trail.size() - (size_t)(runcount - ackedcount));
+			runcount = ackedcount;
+
+			TrailRun& run = trail.back();
+			run = baseline->newestruns[player];
+			addedcount = ackedcount + reader.ReadVarint(SNAPSHOT_SMALL_BITS);
+
+			int x;
+			int y;
+			PredictNewestEnd(run, m_State.directionx[player], m_State.directiony[player], m_State.time - baseline->time, addedcount != ackedcount, x, y);
+
+			if (!reader.ReadBool())
+			{
+				x += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+				y += (int)reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+				run.time += reader.ReadSigned(SNAPSHOT_DELTA_BITS);
+			}
+			run.endx = x;
+			run.endy = y;
+		}
+
+		// The runs past the limit fade, like on the server.
+		while (runcount < addedcount)
+		{
+			TrailRun run;
+			ReadRun(reader, run, trail.empty() ? nullptr : &trail.back());
+			if (reader.IsOverrun()) return false;
+
+			trail.push_back(run);
+			runcount++;
+
+			if (m_State.traillimit > 0 && trail.size() > m_State.traillimit)
+				trail.pop_front();
+		}
+
+		return true;
+	}
+
+	void SnapshotDecoder::Save(SnapshotBaseline& baseline, unsigned int tick) const
+	{
+		unsigned int count = (unsigned int)m_State.trails.size();
+
+		baseline.tick = tick;
+		baseline.issaved = true;
+		baseline.round = m_State.round;
+		baseline.time = m_State.time;
+		baseline.runcounts = m_State.runcounts;
+		baseline.newestruns.resize(count);
+		for (unsigned int player = 0; player < count; player++)
+			baseline.newestruns[player] = m_State.trails[player].back();
+	}
+
+	bool SnapshotDecoder::IsValid() const
+	{
+		return m_IsValid;
+	}
+
+	const ReplicaState& SnapshotDecoder::GetState() const
+	{
+		return m_State;
+	}
+}
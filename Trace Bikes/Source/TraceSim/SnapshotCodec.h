@@ -0,0 +1,105 @@
+#pragma once
+
+#include "TraceSim.h"
+#include <deque>
+#include <vector>
+
+namespace GameDev2D
+{
+	class BitReader;
+
+	const unsigned int SNAPSHOT_HISTORY = 64; // Ticks of snapshots kept on both ends, an ack older than this gets a full snapshot.
+
+	// What a delta is taken from, on both ends: the round and each trail's run count and newest run at a tick.
+	struct SnapshotBaseline
+	{
+		unsigned int tick;
+		bool issaved;
+		unsigned int round;
+		long long time;
+		std::vector<unsigned long long> runcounts;
+		std::vector<TrailRun> newestruns;
+	};
+
+	// A match as a client rebuilds it from the server's snapshots: the round, the bikes and their trails.
+	struct ReplicaState
+	{
+		ReplicaState();
+
+		unsigned int tick; // Of the newest snapshot decoded.
+		unsigned int round;
+		RoundState roundstate;
+		long long time;
+		float countdown; // Progress of the countdown, while the round is starting.
+		unsigned int traillimit;
+
+		// The bikes' fields, as in BikeStates.
+		std::vector<int> fixedx;
+		std::vector<int> fixedy;
+		std::vector<int> directionx;
+		std::vector<int> directiony;
+		std::vector<unsigned char> alive;
+
+		// The runs the server's trails hold, oldest first. The oldest was added to the server's trail as run
+		// runcounts - trails.size().
+		std::vector<std::deque<TrailRun>> trails;
+		std::vector<unsigned long long> runcounts;
+	};
+
+	// Encodes a match's state for one client, as a delta from the newest snapshot the client acked. Trails only grow,
+	// and once a bike turns away from a run it never changes again, so a snapshot holds the runs added since the
+	// acked one, the acked newest run's new end, and the bikes' heads, bit-packed and with the values coded as the
+	// difference from what the client can predict. Like a rollback's snapshot, a baseline is a few values per bike, so
+	// the encoder keeps one for every tick of history. Snapshots are sent in full until the client acks one, after a
+	// reset, and once the ack has fallen out of the history.
+	class SnapshotEncoder
+	{
+	public:
+		SnapshotEncoder();
+
+		// Encodes the sim's state at a tick into the output, replacing what it held. The ticks must count up.
+		void Encode(const TraceSim& sim, unsigned int tick, std::vector<unsigned char>& output);
+
+		// The client decoded the snapshot of a tick, the next snapshots are deltas from it. Acks older than the
+		// newest are ignored.
+		void Acknowledge(unsigned int tick);
+
+		// Forgets the client's acks, the next snapshot is full, for a client that lost its state.
+		void ForgetAcks();
+
+		// Wether the last snapshot encoded was a full one.
+		bool WasFull() const;
+
+	private:
+		SnapshotBaseline m_History[SNAPSHOT_HISTORY]; // Of each tick encoded, at tick % SNAPSHOT_HISTORY.
+		unsigned int m_AckedTick;
+		bool m_IsAcked;
+		bool m_WasFull;
+	};
+
+	// Rebuilds a match from the snapshots of a SnapshotEncoder. The client acks every snapshot the decoder applies.
+	class SnapshotDecoder
+	{
+	public:
+		SnapshotDecoder();
+
+		// Applies a snapshot and returns true, or returns false and leaves the state as it was if the snapshot is
+		// older than the state or is a delta from a tick the decoder no longer has. Returns false with the state
+		// lost if the snapshot turns out broken halfway, the state is only rebuilt by a full snapshot then.
+		bool Decode(const unsigned char* data, size_t size);
+
+		// Wether the state has been rebuilt from a full snapshot and not lost since.
+		bool IsValid() const;
+
+		const ReplicaState& GetState() const;
+
+	private:
+		// Reads a bike's trail, in full without a baseline. Returns false if the snapshot ran out.
+		bool DecodeTrail(BitReader& reader, unsigned int player, const SnapshotBaseline* baseline);
+		void Save(SnapshotBaseline& baseline, unsigned int tick) const;
+
+		ReplicaState m_State;
+		SnapshotBaseline m_History[SNAPSHOT_HISTORY]; // Of each tick decoded.
+		bool m_IsValid;
+	};
+}
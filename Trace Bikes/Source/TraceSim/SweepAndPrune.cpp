@@ -0,0 +1,106 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+namespace GameDev2D
+{
+	SweepAndPrune::SweepAndPrune(unsigned int count) :
+		m_SwapCount(0)
+	{
+		BroadphaseBox empty = { 0, 0, 0, 0 };
+		m_Boxes.assign(count, empty);
+		m_Active.assign(count, 0);
+		m_Order.reserve(count);
+	}
+
+	void SweepAndPrune::SetBox(unsigned int index, const BroadphaseBox& box)
+	{
+		m_Boxes[index] = box;
+
+		// A new box goes at the end, the next sort moves it into place.
+		if (!m_Active[index])
+		{
+			m_Order.push_back(index);
+			m_Active[index] = 1;
+		}
+	}
+
+	void SweepAndPrune::RemoveBox(unsigned int index)
+	{
+		if (m_Active[index])
+		{
+			m_Order.erase(std::find(m_Order.begin(), m_Order.end(), index));
+			m_Active[index] = 0;
+		}
+	}
+
+	void SweepAndPrune::Sort()
+	{
+		unsigned int count = (unsigned int)m_Order.size();
+		const BroadphaseBox* boxes = m_Boxes.data();
+		unsigned int* order = m_Order.data();
+
+		// Insertion sort, nearly sorted already.
+		m_SwapCount = 0;
+		for (unsigned int place = 1; place < count; place++)
+		{
+			unsigned int index = order[place];
+			int miny = boxes[index].miny;
+			unsigned int other = place;
+
+			for (; other > 0 && boxes[order[other - 1]].miny > miny; other--)
+				order[other] = order[other - 1];
+
+			order[other] = index;
+			m_SwapCount += place - other;
+		}
+	}
+
+	void SweepAndPrune::FindPairs()
+	{
+		unsigned int count = (unsigned int)m_Order.size();
+		const BroadphaseBox* boxes = m_Boxes.data();
+		const unsigned int* order = m_Order.data();
+
+		// Each box against the boxes after it that start before its top.
+		m_Pairs.clear();
+		for (unsigned int place = 0; place < count; place++)
+		{
+			unsigned int index = order[place];
+			const BroadphaseBox& box = boxes[index];
+			for (unsigned int next = place + 1; next < count && boxes[order[next]].miny <= box.maxy; next++)
+			{
+				unsigned int other = order[next];
+				const BroadphaseBox& otherbox = boxes[other];
+				if (otherbox.maxx < box.minx || otherbox.minx > box.maxx) continue;
+
+				BroadphasePair pair = { std::min(index, other), std::max(index, other) };
+				m_Pairs.push_back(pair);
+			}
+		}
+	}
+
+	unsigned int SweepAndPrune::GetCount() const
+	{
+		return (unsigned int)m_Boxes.size();
+	}
+
+	const BroadphaseBox& SweepAndPrune::GetBox(unsigned int index) const
+	{
+		return m_Boxes[index];
+	}
+
+	bool SweepAndPrune::IsActive(unsigned int index) const
+	{
+		return m_Active[index] != 0;
+	}
+
+	const std::vector<BroadphasePair>& SweepAndPrune::GetPairs() const
+	{
+		return m_Pairs;
+	}
+
+	unsigned int SweepAndPrune::GetSwapCount() const
+	{
+		return m_SwapCount;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+namespace GameDev2D
+{
+	// An axis-aligned box, edges included, in fixed point units.
+	struct BroadphaseBox
+	{
+		int minx;
+		int miny;
+		int maxx;
+		int maxy;
+	};
+
+	// Two boxes that overlap, the lower index first.
+	struct BroadphasePair
+	{
+		unsigned int first;
+		unsigned int second;
+	};
+
+	// Sweep and prune broadphase: the boxes are kept sorted by their bottom edge, and a sweep along y only compares
+	// a box with the boxes that start before its top. The order is kept from one sort to the next and sorted again
+	// with an insertion sort, boxes that only moved a little since only move a few places, so finding the pairs
+	// costs about the boxes plus the pairs whose y ranges overlap, rather than every pair. It sweeps along y since
+	// the bikes start in lanes up the arena, at the same two x positions.
+	class SweepAndPrune
+	{
+	public:
+		SweepAndPrune(unsigned int count = 0);
+
+		// Sets a box and includes it in the pairs.
+		void SetBox(unsigned int index, const BroadphaseBox& box);
+
+		// Leaves a box out of the order and the pairs until it's set again.
+		void RemoveBox(unsigned int index);
+
+		// Sorts the boxes again, after they were set.
+		void Sort();
+
+		// Finds every pair of boxes that overlap, the boxes have to be sorted since they were last set.
+		void FindPairs();
+
+		unsigned int GetCount() const;
+		const BroadphaseBox& GetBox(unsigned int index) const;
+		bool IsActive(unsigned int index) const;
+
+		// The pairs the last search found, in the order of their lower box along y.
+		const std::vector<BroadphasePair>& GetPairs() const;
+
+		// The places boxes moved by in the last sort.
+		unsigned int GetSwapCount() const;
+
+	private:
+		std::vector<BroadphaseBox> m_Boxes;
+		std::vector<unsigned char> m_Active;
+		std::vector<unsigned int> m_Order; // Indices of the boxes set, sorted by their bottom edge.
+		std::vector<BroadphasePair> m_Pairs;
+		unsigned int m_SwapCount;
+	};
+}
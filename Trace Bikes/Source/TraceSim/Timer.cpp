@@ -3,15 +3,23 @@
 namespace GameDev2D
 {
 	Timer::Timer(double duration, bool isrunning) :
-		m_Elapsed(0),
 		m_Duration(duration),
+		m_Elapsed(0),
 		m_IsRunning(isrunning) { }
 
 	Timer::Timer(const Timer& timer) :
-		m_Elapsed(timer.m_Elapsed),
 		m_Duration(timer.m_Duration),
+		m_Elapsed(timer.m_Elapsed),
 		m_IsRunning(timer.m_IsRunning) { }
 
+	Timer& Timer::operator=(const Timer& timer)
+	{
+		m_Duration = timer.m_Duration;
+		m_Elapsed = timer.m_Elapsed;
+		m_IsRunning = timer.m_IsRunning;
+		return *this;
+	}
+
 	void Timer::Update(double delta)
 	{
 		if (m_IsRunning == true)
@@ -50,12 +58,12 @@ namespace GameDev2D
 		m_Duration = duration;
 	}
 
-	float Timer::GetPercentage()
+	float Timer::GetPercentage() const
 	{
 		return (float)(m_Elapsed / m_Duration);
 	}
 
-	bool Timer::IsRunning()
+	bool Timer::IsRunning() const
 	{
 		return m_IsRunning;
 	}
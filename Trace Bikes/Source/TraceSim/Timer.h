@@ -7,6 +7,7 @@ namespace GameDev2D
 	public:
 		Timer(double duration, bool isrunning = false);
 		Timer(const Timer& timer);
+		Timer& operator=(const Timer& timer);
 
 		void Update(double delta);
 
@@ -17,9 +18,9 @@ namespace GameDev2D
 
 		void SetDuration(double duration);
 
-		float GetPercentage();
+		float GetPercentage() const;
 
-		bool IsRunning();
+		bool IsRunning() const;
 
 	private:
 		double m_Duration;
@@ -0,0 +1,1096 @@
+#include "TraceSim.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace GameDev2D
+{
+	const int FIXED_BIKE_SIZE = (int)(BIKE_SIZE * FIXED_UNITS_PER_PIXEL);
+	const int FIXED_ARENA_CELL_SIZE = (int)(ARENA_CELL_SIZE * FIXED_UNITS_PER_PIXEL);
+	const long long FIXED_TRAIL_IGNORE_TIME = (long long)(TRAIL_IGNORE_DISTANCE * FIXED_UNITS_PER_PIXEL); // The bike lays a unit per subtick.
+
+	// Mixes a value into a running hash, a xor, a multiply and a xor-shift like the MurmurHash3 finalizer.
+	static unsigned long long HashValue(unsigned long long hash, long long value)
+	{
+		hash ^= (unsigned long long)value;
+		hash *= 0xFF51AFD7ED558CCDull;
+		return hash ^ (hash >> 33);
+	}
+
+	static unsigned long long HashRun(unsigned long long hash, const TrailRun& run)
+	{
+		hash = HashValue(hash, run.startx);
+		hash = HashValue(hash, run.starty);
+		hash = HashValue(hash, run.endx);
+		hash = HashValue(hash, run.endy);
+		return HashValue(hash, run.time);
+	}
+
+	// The direction of a run or leg along each axis, -1, 0 or 1.
+	static int GetDirection(int start, int end)
+	{
+		return (end > start) - (end < start);
+	}
+
+	TraceSim::TraceSim(float arenawidth, float arenaheight, unsigned int playercount) :
+		m_Timer(ROUND_COUNTDOWN_DURATION),
+		m_RoundState(RoundState::Unknown),
+		m_Round(0),
+		m_TrailLimit(0),
+		m_Time(0),
+		m_LongestStep(0),
+		m_Timeline(0),
+		m_ParentTimeline(0),
+		m_BranchTime(0),
+		m_Broadphase(playercount),
+		m_Arena((int)ceilf(arenawidth / ARENA_CELL_SIZE), (int)ceilf(arenaheight / ARENA_CELL_SIZE)),
+		m_IsArenaStale(false),
+		m_Chunks(ToFixed(arenawidth), ToFixed(arenaheight), FIXED_TRAIL_CHUNK_SHIFT),
+		m_IsChunksStale(false),
+		m_ArenaWidth(arenawidth),
+		m_ArenaHeight(arenaheight),
+		m_FixedArenaWidth(ToFixed(arenawidth)),
+		m_FixedArenaHeight(ToFixed(arenaheight))
+	{
+		m_Bikes.fixedx.resize(playercount);
+		m_Bikes.fixedy.resize(playercount);
+		m_Bikes.directionx.resize(playercount);
+		m_Bikes.directiony.resize(playercount);
+		m_Bikes.x.resize(playercount);
+		m_Bikes.y.resize(playercount);
+		m_Bikes.previousx.resize(playercount);
+		m_Bikes.previousy.resize(playercount);
+		m_Bikes.angle.resize(playercount);
+		m_Bikes.alive.resize(playercount);
+		m_Bikes.turntime.resize(playercount);
+		m_Bikes.crashtime.resize(playercount);
+		m_Bikes.trail.resize(playercount);
+
+		m_Progress.resize(playercount);
+		m_SweepStart.resize(playercount);
+		m_CrashTimes.resize(playercount);
+		m_IsSweepStale.resize(playercount);
+		m_TrailHashes.resize(playercount);
+		m_ArenaRuns.resize(playercount);
+		m_ChunkRuns.resize(playercount);
+		m_ChunkMinColumns.resize(playercount);
+		m_ChunkMinRows.resize(playercount);
+		m_ChunkMaxColumns.resize(playercount);
+		m_ChunkMaxRows.resize(playercount);
+		m_IsChunkDirty.resize(m_Chunks.GetChunkCount());
+		m_OldestRuns.resize(playercount);
+		m_RunCounts.resize(playercount);
+		m_CutOldest.resize(playercount);
+
+		Reset();
+	}
+
+	void TraceSim::Step(double delta, const std::vector<TurnInput>& inputs)
+	{
+		if (m_Timer.IsRunning())
+		{
+			m_Timer.Update(delta);
+
+			if (m_RoundState == RoundState::Starting && m_Timer.GetPercentage() >= 1)
+				StartRound();
+		}
+
+		unsigned int count = m_Bikes.GetCount();
+		const float* x = m_Bikes.x.data();
+		const float* y = m_Bikes.y.data();
+		float* previousx = m_Bikes.previousx.data();
+		float* previousy = m_Bikes.previousy.data();
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			previousx[player] = x[player];
+			previousy[player] = y[player];
+		}
+
+		if (m_RoundState != RoundState::Running)
+		{
+			// A restore to the countdown or the end of a round still has to bring the arena back.
+			if (m_IsArenaStale)
+				UpdateArena();
+			return;
+		}
+
+		long long steplength = llround(delta * FIXED_SUBTICKS_PER_SECOND);
+		m_LongestStep = std::max(m_LongestStep, steplength);
+
+		// Apply the turns in the order they were made, each bike is moved to the time of its turn first.
+		m_Turns.assign(inputs.begin(), inputs.end());
+		std::stable_sort(m_Turns.begin(), m_Turns.end(), [](const TurnInput& a, const TurnInput& b) { return a.time < b.time; });
+
+		std::fill(m_Progress.begin(), m_Progress.end(), 0);
+		std::fill(m_SweepStart.begin(), m_SweepStart.end(), m_Time);
+
+		for (const TurnInput& turn : m_Turns)
+		{
+			if (turn.player >= count || !m_Bikes.alive[turn.player]) continue;
+
+			// A turn can't be rewound past the bike's previous turn, or too far back.
+			long long earliest = std::max(-MAX_TURN_REWIND, m_Bikes.turntime[turn.player] - m_Time);
+			long long time = std::min(std::max((long long)llroundf(turn.time * FIXED_SUBTICKS_PER_SECOND), earliest), steplength);
+
+			MoveBike(turn.player, time - m_Progress[turn.player]);
+			Turn(turn.player, turn.direction, time);
+			m_Progress[turn.player] = time;
+			m_SweepStart[turn.player] = std::min(m_SweepStart[turn.player], m_Time + time);
+		}
+
+		// Move the bikes the rest of the step, crashed bikes have no direction. Then the newest runs follow.
+		int* fixedx = m_Bikes.fixedx.data();
+		int* fixedy = m_Bikes.fixedy.data();
+		const int* directionx = m_Bikes.directionx.data();
+		const int* directiony = m_Bikes.directiony.data();
+		const long long* progress = m_Progress.data();
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			fixedx[player] += directionx[player] * (int)(steplength - progress[player]);
+			fixedy[player] += directiony[player] * (int)(steplength - progress[player]);
+		}
+
+		for (unsigned int player = 0; player < count; player++)
+			UpdateNewestRun(player);
+
+		UpdateChunks();
+		CheckBikesIntersections(m_Time + steplength);
+		UpdatePixelPositions();
+		UpdateArena();
+
+		if (IsRoundOver())
+			EndRound();
+
+		m_Time += steplength;
+	}
+
+	void TraceSim::Reset()
+	{
+		m_RoundState = RoundState::Starting;
+		m_Round++;
+
+		// Even players line up down the left side from the bottom, odd players down the right side from the top.
+		unsigned int count = m_Bikes.GetCount();
+		unsigned int lanes = (count + 1) / 2;
+		int insetx = ToFixed(BIKE_START_INSET_X);
+		int insety = ToFixed(BIKE_START_INSET_Y);
+		int lanespacing = lanes > 1 ? (m_FixedArenaHeight - insety * 2) / (int)(lanes - 1) : 0;
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			int lane = (int)(player / 2) * lanespacing;
+
+			if (player % 2 == 0)
+			{
+				m_Bikes.fixedx[player] = insetx;
+				m_Bikes.fixedy[player] = insety + lane;
+				m_Bikes.angle[player] = RED_BIKE_START_ROT;
+			}
+			else
+			{
+				m_Bikes.fixedx[player] = m_FixedArenaWidth - insetx;
+				m_Bikes.fixedy[player] = m_FixedArenaHeight - insety - lane;
+				m_Bikes.angle[player] = BLUE_BIKE_START_ROT;
+			}
+		}
+
+		m_Time = 0;
+
+		UpdatePixelPositions();
+		m_Bikes.previousx = m_Bikes.x;
+		m_Bikes.previousy = m_Bikes.y;
+		std::fill(m_Bikes.directionx.begin(), m_Bikes.directionx.end(), 0);
+		std::fill(m_Bikes.directiony.begin(), m_Bikes.directiony.end(), 0);
+		std::fill(m_Bikes.alive.begin(), m_Bikes.alive.end(), 0);
+		std::fill(m_Bikes.turntime.begin(), m_Bikes.turntime.end(), 0);
+		std::fill(m_Bikes.crashtime.begin(), m_Bikes.crashtime.end(), 0);
+		std::fill(m_TrailHashes.begin(), m_TrailHashes.end(), 0);
+
+		// The trails keep their buffers, unless the limit changed.
+		for (unsigned int player = 0; player < count; player++)
+		{
+			if (m_Bikes.trail[player].GetLimit() != m_TrailLimit)
+				m_Bikes.trail[player].SetLimit(m_TrailLimit);
+			else
+				m_Bikes.trail[player].Clear();
+			AddRun(player);
+		}
+
+		m_IsArenaStale = true;
+		m_IsChunksStale = true;
+		UpdateArena();
+
+		m_Timer.Reset();
+		m_Timer.Start();
+	}
+
+	void TraceSim::SetTrailLimit(unsigned int limit)
+	{
+		m_TrailLimit = limit;
+	}
+
+	unsigned int TraceSim::GetTrailLimit() const
+	{
+		return m_TrailLimit;
+	}
+
+	SimSnapshot::SimSnapshot() :
+		round(0),
+		timeline(0),
+		roundstate(RoundState::Unknown),
+		time(0),
+		timer(ROUND_COUNTDOWN_DURATION)
+	{
+	}
+
+	void TraceSim::Save(SimSnapshot& snapshot) const
+	{
+		snapshot.round = m_Round;
+		snapshot.timeline = m_Timeline;
+		snapshot.roundstate = m_RoundState;
+		snapshot.time = m_Time;
+		snapshot.timer = m_Timer;
+
+		snapshot.fixedx = m_Bikes.fixedx;
+		snapshot.fixedy = m_Bikes.fixedy;
+		snapshot.directionx = m_Bikes.directionx;
+		snapshot.directiony = m_Bikes.directiony;
+		snapshot.x = m_Bikes.x;
+		snapshot.y = m_Bikes.y;
+		snapshot.previousx = m_Bikes.previousx;
+		snapshot.previousy = m_Bikes.previousy;
+		snapshot.angle = m_Bikes.angle;
+		snapshot.alive = m_Bikes.alive;
+		snapshot.turntime = m_Bikes.turntime;
+		snapshot.crashtime = m_Bikes.crashtime;
+
+		unsigned int count = m_Bikes.GetCount();
+		snapshot.runcounts.resize(count);
+		snapshot.newestruns.resize(count);
+		for (unsigned int player = 0; player < count; player++)
+		{
+			snapshot.runcounts[player] = m_Bikes.trail[player].GetAddedCount();
+			snapshot.newestruns[player] = m_Bikes.trail[player].GetNewest();
+		}
+
+		snapshot.trailhashes = m_TrailHashes;
+	}
+
+	bool TraceSim::Restore(const SimSnapshot& snapshot)
+	{
+		unsigned int count = m_Bikes.GetCount();
+		if (snapshot.round != m_Round || snapshot.runcounts.size() != count) return false;
+
+		// Past the time it was restored, the timeline restored from has been replaced, its snapshots name runs
+		// the trails no longer have.
+		bool iscurrent = snapshot.timeline == m_Timeline;
+		if (!iscurrent && (snapshot.timeline != m_ParentTimeline || snapshot.time > m_BranchTime)) return false;
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			if (!m_Bikes.trail[player].CanCutBack(snapshot.runcounts[player]))
+				return false;
+		}
+
+		// With the arena and the chunks up to date, only the runs that change are taken out and put back.
+		// Otherwise they're rebuilt whole by the next step.
+		bool isincremental = !m_IsArenaStale && !m_IsChunksStale;
+		for (unsigned int player = 0; player < count; player++)
+		{
+			const TrailBuffer& trail = m_Bikes.trail[player];
+			m_CutOldest[player] = ULLONG_MAX;
+			if (isincremental && DropRuns(player, snapshot.runcounts[player], snapshot.newestruns[player]))
+				m_CutOldest[player] = trail.GetAddedCount() - trail.GetCount();
+		}
+
+		m_RoundState = snapshot.roundstate;
+		m_Time = snapshot.time;
+		m_Timer = snapshot.timer;
+
+		m_Bikes.fixedx = snapshot.fixedx;
+		m_Bikes.fixedy = snapshot.fixedy;
+		m_Bikes.directionx = snapshot.directionx;
+		m_Bikes.directiony = snapshot.directiony;
+		m_Bikes.x = snapshot.x;
+		m_Bikes.y = snapshot.y;
+		m_Bikes.previousx = snapshot.previousx;
+		m_Bikes.previousy = snapshot.previousy;
+		m_Bikes.angle = snapshot.angle;
+		m_Bikes.alive = snapshot.alive;
+		m_Bikes.turntime = snapshot.turntime;
+		m_Bikes.crashtime = snapshot.crashtime;
+
+		// Cutting a trail back doesn't touch the runs it drops.
+		for (unsigned int player = 0; player < count; player++)
+		{
+			TrailBuffer& trail = m_Bikes.trail[player];
+			trail.CutBack(snapshot.runcounts[player]);
+			trail.GetNewest() = snapshot.newestruns[player];
+		}
+
+		m_TrailHashes = snapshot.trailhashes;
+
+		if (isincremental)
+		{
+			for (unsigned int player = 0; player < count; player++)
+			{
+				if (m_CutOldest[player] != ULLONG_MAX)
+					RestoreRuns(player, m_CutOldest[player]);
+			}
+			UnfileDroppedRuns();
+			BlockDirtyChunks();
+		}
+		else
+		{
+			m_IsArenaStale = true;
+			m_IsChunksStale = true;
+		}
+
+		m_ParentTimeline = iscurrent ? m_Timeline : m_ParentTimeline;
+		m_BranchTime = snapshot.time;
+		m_Timeline++;
+		return true;
+	}
+
+	const BikeStates& TraceSim::GetBikes() const
+	{
+		return m_Bikes;
+	}
+
+	unsigned int TraceSim::GetPlayerCount() const
+	{
+		return m_Bikes.GetCount();
+	}
+
+	RoundState TraceSim::GetRoundState() const
+	{
+		return m_RoundState;
+	}
+
+	unsigned int TraceSim::GetRound() const
+	{
+		return m_Round;
+	}
+
+	long long TraceSim::GetTime() const
+	{
+		return m_Time;
+	}
+
+	float TraceSim::GetCountdownPercentage() const
+	{
+		return m_Timer.GetPercentage();
+	}
+
+	float TraceSim::GetArenaWidth() const
+	{
+		return m_ArenaWidth;
+	}
+
+	float TraceSim::GetArenaHeight() const
+	{
+		return m_ArenaHeight;
+	}
+
+	size_t TraceSim::GetTrailMemoryUsage() const
+	{
+		size_t bytes = 0;
+
+		for (const TrailBuffer& trail : m_Bikes.trail)
+			bytes += trail.GetCapacity() * sizeof(TrailRun);
+
+		return bytes;
+	}
+
+	const SweepAndPrune& TraceSim::GetBroadphase() const
+	{
+		return m_Broadphase;
+	}
+
+	const TrailChunks& TraceSim::GetTrailChunks() const
+	{
+		return m_Chunks;
+	}
+
+	const BitboardArena& TraceSim::GetArena() const
+	{
+		return m_Arena;
+	}
+
+	unsigned long long TraceSim::GetStateHash() const
+	{
+		// The countdown is the only floating point state, its bits are as repeatable as the deltas that built it.
+		float countdown = m_Timer.GetPercentage();
+		unsigned int countdownbits;
+		memcpy(&countdownbits, &countdown, sizeof(countdownbits));
+
+		unsigned long long hash = HashValue(0, m_Time);
+		hash = HashValue(hash, (long long)m_RoundState);
+		hash = HashValue(hash, countdownbits);
+
+		// Each bike is hashed on its own and then mixed in, the bikes' hashes don't wait on each other.
+		for (unsigned int player = 0; player < m_Bikes.GetCount(); player++)
+		{
+			unsigned long long bikehash = HashValue(m_TrailHashes[player], m_Bikes.fixedx[player]);
+			bikehash = HashValue(bikehash, m_Bikes.fixedy[player]);
+			bikehash = HashValue(bikehash, m_Bikes.directionx[player] * 2 + m_Bikes.directiony[player] * 4 + m_Bikes.alive[player]);
+			bikehash = HashValue(bikehash, m_Bikes.turntime[player]);
+			bikehash = HashValue(bikehash, m_Bikes.crashtime[player]);
+			bikehash = HashValue(bikehash, (long long)m_Bikes.trail[player].GetCount());
+			bikehash = HashRun(bikehash, m_Bikes.trail[player].GetNewest());
+			hash = HashValue(hash, (long long)bikehash);
+		}
+
+		return hash;
+	}
+
+	bool TraceSim::IsBoxHittingTrail(const TrailBuffer& trail, int x, int y, int halfsize, int ignoredistance)
+	{
+		int reach = halfsize + FIXED_BIKE_SIZE / 2;
+
+		for (size_t i = trail.GetCount(); i-- > 0;)
+		{
+			TrailRun run = trail[i];
+
+			// Skip the newest stretch, the run it ends in only counts up to where it starts.
+			if (ignoredistance > 0)
+			{
+				int length = run.GetLength();
+				if (length <= ignoredistance)
+				{
+					ignoredistance -= length;
+					continue;
+				}
+
+				int kept = length - ignoredistance;
+				run.endx = run.startx + (run.endx - run.startx) / length * kept;
+				run.endy = run.starty + (run.endy - run.starty) / length * kept;
+				ignoredistance = 0;
+			}
+
+			if (x >= std::min(run.startx, run.endx) - reach && x <= std::max(run.startx, run.endx) + reach &&
+				y >= std::min(run.starty, run.endy) - reach && y <= std::max(run.starty, run.endy) + reach)
+				return true;
+		}
+
+		return false;
+	}
+
+	void TraceSim::StartRound()
+	{
+		m_RoundState = RoundState::Running;
+
+		std::fill(m_Bikes.alive.begin(), m_Bikes.alive.end(), 1);
+
+		m_Timer.Stop();
+
+		for (unsigned int player = 0; player < m_Bikes.GetCount(); player++)
+			Turn(player, player % 2 == 0 ? Direction::Right : Direction::Left, 0);
+	}
+
+	void TraceSim::EndRound()
+	{
+		m_RoundState = RoundState::GameOver;
+	}
+
+	bool TraceSim::Turn(unsigned int player, Direction direction, long long time)
+	{
+		int directionx = 0;
+		int directiony = 0;
+		float angle = 0.0f;
+
+		switch (direction)
+		{
+		case Direction::Left:
+			directionx = -1;
+			angle = 0.0f;
+			break;
+		case Direction::Right:
+			directionx = 1;
+			angle = 180.0f;
+			break;
+		case Direction::Up:
+			directiony = 1;
+			angle = -90.0f;
+			break;
+		case Direction::Down:
+			directiony = -1;
+			angle = 90.0f;
+			break;
+		}
+
+		// Bikes can only turn at a right angle, never reverse or keep going straight.
+		if (m_Bikes.directionx[player] * directionx + m_Bikes.directiony[player] * directiony != 0)
+			return false;
+
+		m_Bikes.directionx[player] = directionx;
+		m_Bikes.directiony[player] = directiony;
+		m_Bikes.angle[player] = angle;
+		m_Bikes.turntime[player] = m_Time + time;
+
+		// Start a new run at the corner, unless the bike hasn't moved since the last one started.
+		TrailRun& newest = m_Bikes.trail[player].GetNewest();
+		if (newest.GetLength() > 0)
+			AddRun(player);
+		else
+			newest.time = m_Bikes.turntime[player];
+		return true;
+	}
+
+	void TraceSim::AddRun(unsigned int player)
+	{
+		// The newest run won't change anymore, hash it into the finished runs.
+		TrailBuffer& trail = m_Bikes.trail[player];
+		if (!trail.IsEmpty())
+			m_TrailHashes[player] = HashRun(m_TrailHashes[player], trail.GetNewest());
+
+		// A limited trail drops its oldest run to make room, the arena and the chunks let go of it once the bikes
+		// have moved, unless they're rebuilt whole anyway.
+		if (trail.GetLimit() > 0 && trail.GetCount() == trail.GetLimit() && !m_IsArenaStale && !m_IsChunksStale)
+			OpenRun(trail[0]);
+
+		TrailRun run;
+		run.startx = run.endx = m_Bikes.fixedx[player];
+		run.starty = run.endy = m_Bikes.fixedy[player];
+		run.time = m_Bikes.turntime[player];
+		trail.Add(run);
+	}
+
+	bool TraceSim::DropRuns(unsigned int player, unsigned long long runcount, const TrailRun& newest)
+	{
+		const TrailBuffer& trail = m_Bikes.trail[player];
+		const TrailRun& current = trail.GetNewest();
+		if (runcount == trail.GetAddedCount() && current.endx == newest.endx && current.endy == newest.endy) return false;
+
+		// Runs that faded since aren't in the arena or the chunks, they're put back after the cut.
+		unsigned long long oldest = trail.GetAddedCount() - trail.GetCount();
+		for (unsigned long long index = std::max(runcount - 1, oldest); index < trail.GetAddedCount(); index++)
+			OpenRun(trail[(size_t)(index - oldest)]);
+
+		if (runcount - 1 >= oldest && m_ChunkRuns[player] != runcount - 1)
+		{
+			const TrailRun& run = trail[(size_t)(runcount - 1 - oldest)];
+			m_ChunkRuns[player] = runcount - 1;
+			m_ChunkMinColumns[player] = m_Chunks.GetColumn(std::min(run.startx, run.endx));
+			m_ChunkMaxColumns[player] = m_Chunks.GetColumn(std::max(run.startx, run.endx));
+			m_ChunkMinRows[player] = m_Chunks.GetRow(std::min(run.starty, run.endy));
+			m_ChunkMaxRows[player] = m_Chunks.GetRow(std::max(run.starty, run.endy));
+		}
+		return true;
+	}
+
+	void TraceSim::RestoreRuns(unsigned int player, unsigned long long oldest)
+	{
+		const TrailBuffer& trail = m_Bikes.trail[player];
+		unsigned long long newest = trail.GetAddedCount() - 1;
+		unsigned long long first = trail.GetAddedCount() - trail.GetCount();
+
+		for (unsigned long long index = first; index < std::min(oldest, newest + 1); index++)
+		{
+			const TrailRun& run = trail[(size_t)(index - first)];
+			FileRun(player, index);
+			m_Arena.BlockLine(run.startx / FIXED_ARENA_CELL_SIZE, run.starty / FIXED_ARENA_CELL_SIZE, run.endx / FIXED_ARENA_CELL_SIZE, run.endy / FIXED_ARENA_CELL_SIZE);
+		}
+
+		const TrailRun& run = trail.GetNewest();
+		if (newest < oldest)
+		{
+			m_ChunkRuns[player] = newest;
+			m_ChunkMinColumns[player] = m_Chunks.GetColumn(std::min(run.startx, run.endx));
+			m_ChunkMaxColumns[player] = m_Chunks.GetColumn(std::max(run.startx, run.endx));
+			m_ChunkMinRows[player] = m_Chunks.GetRow(std::min(run.starty, run.endy));
+			m_ChunkMaxRows[player] = m_Chunks.GetRow(std::max(run.starty, run.endy));
+		}
+
+		// The newest run may reach past where it was cut short since, its cells aren't all in the dirty chunks.
+		m_ArenaRuns[player] = newest;
+		m_ArenaColumns[player] = run.endx / FIXED_ARENA_CELL_SIZE;
+		m_ArenaRows[player] = run.endy / FIXED_ARENA_CELL_SIZE;
+		m_Arena.BlockLine(run.startx / FIXED_ARENA_CELL_SIZE, run.starty / FIXED_ARENA_CELL_SIZE, m_ArenaColumns[player], m_ArenaRows[player]);
+	}
+
+	void TraceSim::OpenRun(const TrailRun& run)
+	{
+		// A rewind can have blocked cells past where the run ends, and a crash in the step can have filed it
+		// further.
+		int margin = (int)(MAX_TURN_REWIND + m_LongestStep);
+		int mincolumn = (std::min(run.startx, run.endx) - margin) / FIXED_ARENA_CELL_SIZE;
+		int maxcolumn = (std::max(run.startx, run.endx) + margin) / FIXED_ARENA_CELL_SIZE;
+		int minrow = (std::min(run.starty, run.endy) - margin) / FIXED_ARENA_CELL_SIZE;
+		int maxrow = (std::max(run.starty, run.endy) + margin) / FIXED_ARENA_CELL_SIZE;
+		m_Arena.OpenBox(mincolumn, minrow, maxcolumn, maxrow);
+
+		// The cells reach from their first unit to their last, past the margin on the top and right.
+		int columns = m_Chunks.GetColumns();
+		int maxchunkcolumn = m_Chunks.GetColumn((maxcolumn + 1) * FIXED_ARENA_CELL_SIZE - 1);
+		int maxchunkrow = m_Chunks.GetRow((maxrow + 1) * FIXED_ARENA_CELL_SIZE - 1);
+
+		for (int row = m_Chunks.GetRow(minrow * FIXED_ARENA_CELL_SIZE); row <= maxchunkrow; row++)
+		{
+			for (int column = m_Chunks.GetColumn(mincolumn * FIXED_ARENA_CELL_SIZE); column <= maxchunkcolumn; column++)
+			{
+				int cell = row * columns + column;
+				if (m_IsChunkDirty[cell]) continue;
+
+				m_IsChunkDirty[cell] = 1;
+				m_DirtyChunks.push_back(cell);
+			}
+		}
+	}
+
+	void TraceSim::FileRun(unsigned int player, unsigned long long index)
+	{
+		const TrailBuffer& trail = m_Bikes.trail[player];
+		const TrailRun& run = trail[(size_t)(index - (trail.GetAddedCount() - trail.GetCount()))];
+		TrailChunkEntry entry = { player, index };
+
+		for (int row = m_Chunks.GetRow(std::min(run.starty, run.endy)); row <= m_Chunks.GetRow(std::max(run.starty, run.endy)); row++)
+		{
+			for (int column = m_Chunks.GetColumn(std::min(run.startx, run.endx)); column <= m_Chunks.GetColumn(std::max(run.startx, run.endx)); column++)
+				m_Chunks.Add(column, row, entry);
+		}
+	}
+
+	void TraceSim::UnfileDroppedRuns()
+	{
+		unsigned int count = m_Bikes.GetCount();
+		for (unsigned int player = 0; player < count; player++)
+		{
+			m_RunCounts[player] = m_Bikes.trail[player].GetAddedCount();
+			m_OldestRuns[player] = m_RunCounts[player] - m_Bikes.trail[player].GetCount();
+		}
+
+		int columns = m_Chunks.GetColumns();
+		for (int cell : m_DirtyChunks)
+			m_Chunks.Remove(cell % columns, cell / columns, m_OldestRuns, m_RunCounts);
+	}
+
+	void TraceSim::BlockDirtyChunks()
+	{
+		int columns = m_Chunks.GetColumns();
+		for (int cell : m_DirtyChunks)
+		{
+			m_IsChunkDirty[cell] = 0;
+			const std::vector<TrailChunkEntry>* chunk = m_Chunks.GetChunk(cell % columns, cell / columns);
+			if (chunk == nullptr) continue;
+
+			for (const TrailChunkEntry& entry : *chunk)
+			{
+				const TrailBuffer& trail = m_Bikes.trail[entry.player];
+				const TrailRun& run = trail[(size_t)(entry.run - (trail.GetAddedCount() - trail.GetCount()))];
+				m_Arena.BlockLine(run.startx / FIXED_ARENA_CELL_SIZE, run.starty / FIXED_ARENA_CELL_SIZE, run.endx / FIXED_ARENA_CELL_SIZE, run.endy / FIXED_ARENA_CELL_SIZE);
+			}
+		}
+
+		m_DirtyChunks.clear();
+	}
+
+	void TraceSim::MoveBike(unsigned int player, long long subticks)
+	{
+		m_Bikes.fixedx[player] += m_Bikes.directionx[player] * (int)subticks;
+		m_Bikes.fixedy[player] += m_Bikes.directiony[player] * (int)subticks;
+
+		UpdateNewestRun(player);
+	}
+
+	void TraceSim::UpdateNewestRun(unsigned int player)
+	{
+		// The newest run follows the bike, a rewind is never longer than the run since it stops at the last turn.
+		TrailRun& newest = m_Bikes.trail[player].GetNewest();
+		newest.endx = m_Bikes.fixedx[player];
+		newest.endy = m_Bikes.fixedy[player];
+	}
+
+	void TraceSim::UpdatePixelPositions()
+	{
+		unsigned int count = m_Bikes.GetCount();
+		const int* fixedx = m_Bikes.fixedx.data();
+		const int* fixedy = m_Bikes.fixedy.data();
+		float* x = m_Bikes.x.data();
+		float* y = m_Bikes.y.data();
+		float scale = 1.0f / FIXED_UNITS_PER_PIXEL;
+
+		for (unsigned int player = 0; player < count; player++)
+		{
+			x[player] = fixedx[player] * scale;
+			y[player] = fixedy[player] * scale;
+		}
+	}
+
+	void TraceSim::UpdateArena()
+	{
+		if (m_IsArenaStale)
+		{
+			m_Arena.Clear();
+			std::fill(m_ArenaRuns.begin(), m_ArenaRuns.end(), 0);
+			m_ArenaColumns.assign(m_Bikes.GetCount(), -1);
+			m_ArenaRows.assign(m_Bikes.GetCount(), -1);
+			m_IsArenaStale = false;
+		}
+
+		// The cells of the runs that faded this step were opened, the runs still around them are blocked again.
+		if (!m_DirtyChunks.empty())
+			BlockDirtyChunks();
+
+		for (unsigned int player = 0; player < m_Bikes.GetCount(); player++)
+		{
+			// Most steps the bike is still in the cell it was in, after turns the runs since are blocked whole.
+			const TrailBuffer& trail = m_Bikes.trail[player];
+			unsigned long long newest = trail.GetAddedCount() - 1;
+			unsigned long long oldest = trail.GetAddedCount() - trail.GetCount();
+			int column = trail.GetNewest().endx / FIXED_ARENA_CELL_SIZE;
+			int row = trail.GetNewest().endy / FIXED_ARENA_CELL_SIZE;
+			if (m_ArenaRuns[player] == newest && column == m_ArenaColumns[player] && row == m_ArenaRows[player]) continue;
+
+			for (unsigned long long index = std::max(m_ArenaRuns[player], oldest); index <= newest; index++)
+			{
+				const TrailRun& run = trail[(size_t)(index - oldest)];
+				if (index != m_ArenaRuns[player] || m_ArenaColumns[player] < 0)
+				{
+					m_ArenaColumns[player] = run.startx / FIXED_ARENA_CELL_SIZE;
+					m_ArenaRows[player] = run.starty / FIXED_ARENA_CELL_SIZE;
+				}
+
+				m_Arena.BlockLine(m_ArenaColumns[player], m_ArenaRows[player], run.endx / FIXED_ARENA_CELL_SIZE, run.endy / FIXED_ARENA_CELL_SIZE);
+			}
+
+			m_ArenaRuns[player] = newest;
+			m_ArenaColumns[player] = column;
+			m_ArenaRows[player] = row;
+		}
+	}
+
+	void TraceSim::UpdateChunks()
+	{
+		if (m_IsChunksStale)
+		{
+			m_Chunks.Clear();
+			std::fill(m_ChunkRuns.begin(), m_ChunkRuns.end(), 0);
+			std::fill(m_ChunkMinColumns.begin(), m_ChunkMinColumns.end(), INT_MAX);
+			std::fill(m_ChunkMaxColumns.begin(), m_ChunkMaxColumns.end(), INT_MIN);
+			m_IsChunksStale = false;
+		}
+
+		// Runs that faded this step are taken out before the bikes are checked against the chunks.
+		if (!m_DirtyChunks.empty())
+			UnfileDroppedRuns();
+
+		for (unsigned int player = 0; player < m_Bikes.GetCount(); player++)
+		{
+			// Most steps the bike is still in a chunk its newest run is filed in. Runs are axis-aligned, the chunks
+			// they pass through are a line of them from the chunk they start in.
+			const TrailBuffer& trail = m_Bikes.trail[player];
+			unsigned long long newest = trail.GetAddedCount() - 1;
+			unsigned long long oldest = trail.GetAddedCount() - trail.GetCount();
+			int column = m_Chunks.GetColumn(trail.GetNewest().endx);
+			int row = m_Chunks.GetRow(trail.GetNewest().endy);
+			if (m_ChunkRuns[player] == newest && column >= m_ChunkMinColumns[player] && column <= m_ChunkMaxColumns[player] &&
+				row >= m_ChunkMinRows[player] && row <= m_ChunkMaxRows[player]) continue;
+
+			for (unsigned long long index = std::max(m_ChunkRuns[player], oldest); index <= newest; index++)
+			{
+				if (index != m_ChunkRuns[player])
+				{
+					m_ChunkMinColumns[player] = INT_MAX;
+					m_ChunkMaxColumns[player] = INT_MIN;
+				}
+
+				const TrailRun& run = trail[(size_t)(index - oldest)];
+				int mincolumn = m_Chunks.GetColumn(std::min(run.startx, run.endx));
+				int maxcolumn = m_Chunks.GetColumn(std::max(run.startx, run.endx));
+				int minrow = m_Chunks.GetRow(std::min(run.starty, run.endy));
+				int maxrow = m_Chunks.GetRow(std::max(run.starty, run.endy));
+
+				bool isfiled = m_ChunkMinColumns[player] <= m_ChunkMaxColumns[player];
+				if (isfiled && mincolumn >= m_ChunkMinColumns[player] && maxcolumn <= m_ChunkMaxColumns[player] &&
+					minrow >= m_ChunkMinRows[player] && maxrow <= m_ChunkMaxRows[player]) continue;
+
+				// The filed chunks are a line or a cross through the run's first chunk, so the box around them
+				// covers exactly those the run can reach from there.
+				TrailChunkEntry entry = { player, index };
+				for (int row = minrow; row <= maxrow; row++)
+				{
+					for (int column = mincolumn; column <= maxcolumn; column++)
+					{
+						if (isfiled && column >= m_ChunkMinColumns[player] && column <= m_ChunkMaxColumns[player] &&
+							row >= m_ChunkMinRows[player] && row <= m_ChunkMaxRows[player]) continue;
+
+						m_Chunks.Add(column, row, entry);
+					}
+				}
+
+				m_ChunkMinColumns[player] = isfiled ? std::min(m_ChunkMinColumns[player], mincolumn) : mincolumn;
+				m_ChunkMaxColumns[player] = isfiled ? std::max(m_ChunkMaxColumns[player], maxcolumn) : maxcolumn;
+				m_ChunkMinRows[player] = isfiled ? std::min(m_ChunkMinRows[player], minrow) : minrow;
+				m_ChunkMaxRows[player] = isfiled ? std::max(m_ChunkMaxRows[player], maxrow) : maxrow;
+			}
+
+			m_ChunkRuns[player] = newest;
+		}
+	}
+
+	void TraceSim::CheckBikesIntersections(long long stepend)
+	{
+		unsigned int count = m_Bikes.GetCount();
+		std::fill(m_IsSweepStale.begin(), m_IsSweepStale.end(), 1);
+		bool isfound = false;
+
+		while (true)
+		{
+			long long first = NO_CRASH;
+
+			for (unsigned int player = 0; player < count; player++)
+			{
+				if (m_IsSweepStale[player])
+				{
+					m_CrashTimes[player] = m_Bikes.alive[player] ? GetCrashTime(player, stepend) : NO_CRASH;
+					m_IsSweepStale[player] = 0;
+				}
+				first = std::min(first, m_CrashTimes[player]);
+			}
+
+			if (first == NO_CRASH) return;
+
+			// Most steps nobody crashes, the pairs are only needed once somebody does. The boxes are the motion
+			// before anybody stopped.
+			if (!isfound)
+			{
+				for (unsigned int player = 0; player < count; player++)
+				{
+					if (m_Bikes.alive[player])
+						m_Broadphase.SetBox(player, GetMotionBox(player, stepend));
+					else
+						m_Broadphase.RemoveBox(player);
+				}
+
+				m_Broadphase.Sort();
+				m_Broadphase.FindPairs();
+				isfound = true;
+			}
+
+			// The bikes that crashed first are out, it's a tie if that's all of them. They stop where they crashed,
+			// cutting their trails short, and the bikes whose motion came near theirs are swept again.
+			for (unsigned int player = 0; player < count; player++)
+			{
+				if (m_CrashTimes[player] != first) continue;
+
+				MoveBike(player, std::max(first, m_Bikes.turntime[player]) - stepend);
+				m_Bikes.alive[player] = 0;
+				m_Bikes.crashtime[player] = first;
+				m_Bikes.directionx[player] = 0;
+				m_Bikes.directiony[player] = 0;
+			}
+
+			for (const BroadphasePair& pair : m_Broadphase.GetPairs())
+			{
+				if (m_CrashTimes[pair.first] == first)
+					m_IsSweepStale[pair.second] = 1;
+				if (m_CrashTimes[pair.second] == first)
+					m_IsSweepStale[pair.first] = 1;
+			}
+
+			for (unsigned int player = 0; player < count; player++)
+			{
+				if (m_CrashTimes[player] == first)
+					m_CrashTimes[player] = NO_CRASH;
+			}
+
+			// Bikes crashing later in the step never get there if the round is over, put them where they were
+			// when it ended. Otherwise the shortened trails might have been what they hit, sweep them again.
+			if (IsRoundOver())
+			{
+				for (unsigned int player = 0; player < count; player++)
+				{
+					if (m_Bikes.alive[player])
+						MoveBike(player, std::max(first, m_Bikes.turntime[player]) - stepend);
+				}
+				return;
+			}
+		}
+	}
+
+	BroadphaseBox TraceSim::GetMotionBox(unsigned int player, long long stepend) const
+	{
+		// The bike's motion this step is the end of its own trail, from where the bike is back to where the sweep
+		// starts, through the corners between.
+		const TrailBuffer& trail = m_Bikes.trail[player];
+		long long sweepstart = m_SweepStart[player];
+		BroadphaseBox box = { m_Bikes.fixedx[player], m_Bikes.fixedy[player], m_Bikes.fixedx[player], m_Bikes.fixedy[player] };
+
+		for (size_t i = trail.GetCount(); i-- > 0;)
+		{
+			const TrailRun& leg = trail[i];
+			long long start = std::max(leg.time, sweepstart);
+			if (std::min(leg.time + leg.GetLength(), stepend) < start) break;
+
+			int along = (int)(start - leg.time);
+			int x = leg.startx + GetDirection(leg.startx, leg.endx) * along;
+			int y = leg.starty + GetDirection(leg.starty, leg.endy) * along;
+			box.minx = std::min(box.minx, x);
+			box.miny = std::min(box.miny, y);
+			box.maxx = std::max(box.maxx, x);
+			box.maxy = std::max(box.maxy, y);
+
+			if (leg.time <= sweepstart) break;
+		}
+
+		box.minx -= FIXED_BIKE_SIZE / 2;
+		box.miny -= FIXED_BIKE_SIZE / 2;
+		box.maxx += FIXED_BIKE_SIZE / 2;
+		box.maxy += FIXED_BIKE_SIZE / 2;
+		return box;
+	}
+
+	bool TraceSim::IsRoundOver() const
+	{
+		unsigned int alive = 0;
+
+		for (unsigned char bikealive : m_Bikes.alive)
+			alive += bikealive;
+
+		return alive <= (m_Bikes.GetCount() > 1 ? 1u : 0u);
+	}
+
+	long long TraceSim::GetCrashTime(unsigned int player, long long stepend) const
+	{
+		long long crashtime = NO_CRASH;
+		long long sweepstart = m_SweepStart[player];
+		const TrailBuffer& trail = m_Bikes.trail[player];
+
+		// The bike's motion this step is the end of its own trail, newest run first.
+		for (size_t i = trail.GetCount(); i-- > 0;)
+		{
+			const TrailRun& leg = trail[i];
+			long long start = std::max(leg.time, sweepstart);
+			long long end = std::min(leg.time + leg.GetLength(), stepend);
+			if (end < sweepstart) break;
+			if (start > end) continue;
+
+			crashtime = std::min(crashtime, GetBoundsCrashTime(leg, start, end));
+
+			// The box the bike sweeps over, runs that don't come within the trail's width of it can't be hit.
+			int directionx = GetDirection(leg.startx, leg.endx);
+			int directiony = GetDirection(leg.starty, leg.endy);
+			int from = (int)(start - leg.time);
+			int to = (int)(end - leg.time);
+			int minx = leg.startx + std::min(directionx * from, directionx * to) - FIXED_BIKE_SIZE;
+			int maxx = leg.startx + std::max(directionx * from, directionx * to) + FIXED_BIKE_SIZE;
+			int miny = leg.starty + std::min(directiony * from, directiony * to) - FIXED_BIKE_SIZE;
+			int maxy = leg.starty + std::max(directiony * from, directiony * to) + FIXED_BIKE_SIZE;
+
+			// Check the bike against the runs filed in the chunks the box touches, its own trail's minus the newest
+			// stretch. A run through more than one of them is checked again, which finds the same time. Every
+			// filed run is still in its trail: a run that fades marks the chunks around it dirty as it's opened,
+			// and the dropped runs are taken out of those chunks before the bikes are checked.
+			int lastcolumn = m_Chunks.GetColumn(maxx);
+			int lastrow = m_Chunks.GetRow(maxy);
+
+			for (int row = m_Chunks.GetRow(miny); row <= lastrow; row++)
+			{
+				for (int column = m_Chunks.GetColumn(minx); column <= lastcolumn; column++)
+				{
+					const std::vector<TrailChunkEntry>* chunk = m_Chunks.GetChunk(column, row);
+					if (chunk == nullptr) continue;
+
+					for (const TrailChunkEntry& entry : *chunk)
+					{
+						const TrailBuffer& othertrail = m_Bikes.trail[entry.player];
+						const TrailRun& run = othertrail[(size_t)(entry.run - (othertrail.GetAddedCount() - othertrail.GetCount()))];
+						if (std::max(run.startx, run.endx) < minx || std::min(run.startx, run.endx) > maxx ||
+							std::max(run.starty, run.endy) < miny || std::min(run.starty, run.endy) > maxy)
+							continue;
+
+						long long ignoretime = entry.player == player ? FIXED_TRAIL_IGNORE_TIME : 0;
+						crashtime = std::min(crashtime, GetRunCrashTime(leg, start, end, run, ignoretime));
+					}
+				}
+			}
+		}
+
+		return crashtime;
+	}
+
+	long long TraceSim::GetBoundsCrashTime(const TrailRun& leg, long long start, long long end) const
+	{
+		if (leg.GetLength() == 0)
+			return leg.startx < 0 || leg.startx > m_FixedArenaWidth || leg.starty < 0 || leg.starty > m_FixedArenaHeight ? start : NO_CRASH;
+
+		int directionx = GetDirection(leg.startx, leg.endx);
+		int directiony = GetDirection(leg.starty, leg.endy);
+		long long x = leg.startx + directionx * (end - leg.time);
+		long long y = leg.starty + directiony * (end - leg.time);
+
+		// The time the bike reaches the edge it's out past, or the start if it already was.
+		long long crashtime = NO_CRASH;
+		if (x < 0)
+			crashtime = leg.time + leg.startx;
+		else if (x > m_FixedArenaWidth)
+			crashtime = leg.time + (m_FixedArenaWidth - leg.startx);
+		else if (y < 0)
+			crashtime = leg.time + leg.starty;
+		else if (y > m_FixedArenaHeight)
+			crashtime = leg.time + (m_FixedArenaHeight - leg.starty);
+		else
+			return NO_CRASH;
+
+		return std::max(crashtime, start);
+	}
+
+	// Narrows the range of subticks [first, last] to those where a + b * t <= 0, rounding inwards.
+	static void ConstrainCrashTime(long long& first, long long& last, long long a, long long b)
+	{
+		if (b == 0)
+		{
+			if (a > 0)
+				last = LLONG_MIN;
+		}
+		else if (b > 0)
+		{
+			// t <= -a / b, rounded down.
+			long long bound = -a >= 0 ? -a / b : -((a + b - 1) / b);
+			last = std::min(last, bound);
+		}
+		else
+		{
+			// t >= a / -b, rounded up.
+			long long bound = a >= 0 ? (a - b - 1) / -b : -(-a / -b);
+			first = std::max(first, bound);
+		}
+	}
+
+	long long TraceSim::GetRunCrashTime(const TrailRun& leg, long long start, long long end, const TrailRun& run, long long ignoretime)
+	{
+		// Nothing of the run is laid before its start time.
+		long long first = std::max(start, run.time + ignoretime);
+		long long last = end;
+		if (first > last) return NO_CRASH;
+
+		// The run's direction, and the leg's, a bike moves one unit per subtick.
+		int runlength = run.GetLength();
+		long long directionx = runlength > 0 ? GetDirection(run.startx, run.endx) : 1;
+		long long directiony = runlength > 0 ? GetDirection(run.starty, run.endy) : 0;
+
+		long long velocityx = GetDirection(leg.startx, leg.endx);
+		long long velocityy = GetDirection(leg.starty, leg.endy);
+
+		// The bike relative to the start of the run, along and across the run, at round subtick t: a + b * t.
+		long long offsetx = leg.startx - run.startx - velocityx * leg.time;
+		long long offsety = leg.starty - run.starty - velocityy * leg.time;
+		long long along = offsetx * directionx + offsety * directiony;
+		long long alongspeed = velocityx * directionx + velocityy * directiony;
+		long long across = offsety * directionx - offsetx * directiony;
+		long long acrossspeed = velocityy * directionx - velocityx * directiony;
+
+		// The bike's box touches the run's box across it, and along it between the start and the end of what's laid.
+		long long size = FIXED_BIKE_SIZE;
+		ConstrainCrashTime(first, last, across - size, acrossspeed);
+		ConstrainCrashTime(first, last, -across - size, -acrossspeed);
+		ConstrainCrashTime(first, last, -along - size, -alongspeed);
+		ConstrainCrashTime(first, last, along - size - runlength, alongspeed);
+		ConstrainCrashTime(first, last, along - size + run.time + ignoretime, alongspeed - 1);
+
+		return first <= last ? first : NO_CRASH;
+	}
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "BitboardArena.h"
+#include "SweepAndPrune.h"
+#include "Timer.h"
+#include "TrailBuffer.h"
+#include "TrailChunks.h"
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	const unsigned int RED_PLAYER = 0;
+	const unsigned int BLUE_PLAYER = 1;
+	const unsigned int PLAYER_COUNT = 2; // Players in a keyboard match, the sim takes any number.
+
+	const float RED_BIKE_START_ROT = 180; // Even players start on the left like red, odd players on the right like blue.
+	const float BLUE_BIKE_START_ROT = 0;
+
+	const float BIKE_START_INSET_X = 23.0f; // Start positions are inset from the arena corners, the lanes are spread between them.
+	const float BIKE_START_INSET_Y = 9.0f;
+
+	const float BIKE_SPEED = 250.0f;
+	const float BIKE_SIZE = 16.0f; // Collision box of the bike heads, and width of the trails.
+	const float TRAIL_IGNORE_DISTANCE = 72.0f; // A bike can't hit the newest stretch of its own trail, it's still under the bike.
+	const float ARENA_CELL_SIZE = BIKE_SIZE; // The arena's bitboard has a cell per trail width.
+
+	// The simulation runs in fixed point so the same inputs always play out the same, on any machine. Time is
+	// counted in subticks of a fixed tick, and positions in units a bike covers in one subtick at BIKE_SPEED.
+	const long long FIXED_TICK_RATE = 240;
+	const long long FIXED_SUBTICKS = 250; // Per tick, turns and crashes are timed to the subtick.
+	const long long FIXED_SUBTICKS_PER_SECOND = FIXED_TICK_RATE * FIXED_SUBTICKS;
+	const int FIXED_UNITS_PER_PIXEL = 240; // FIXED_SUBTICKS_PER_SECOND / BIKE_SPEED.
+	const int FIXED_TRAIL_CHUNK_SHIFT = 16; // The trails are filed by the chunks of the arena they pass through, 2^16 units (about 273 pixels) square.
+
+	const double ROUND_COUNTDOWN_DURATION = 3.0;
+	const long long NO_CRASH = LLONG_MAX; // Bikes that crash in the same subtick tie.
+	const long long MAX_TURN_REWIND = FIXED_SUBTICKS_PER_SECOND / 10; // A turn can be moved at most this many subticks back in time.
+
+	// Converts between pixels and fixed point units.
+	inline int ToFixed(float pixels) { return (int)lroundf(pixels * FIXED_UNITS_PER_PIXEL); }
+	inline float ToPixels(long long units) { return (float)units / FIXED_UNITS_PER_PIXEL; }
+
+	enum class RoundState
+	{
+		Unknown,
+		Starting,
+		Running,
+		GameOver,
+	};
+
+	enum class Direction
+	{
+		Left,
+		Right,
+		Up,
+		Down,
+	};
+
+	struct TurnInput
+	{
+		unsigned int player;
+		Direction direction;
+		float time; // Seconds into the step the turn was made, negative if it was made before the step started.
+	};
+
+	// The state of every bike, one array per field indexed by player, so the per-bike loops run over contiguous values.
+	struct BikeStates
+	{
+		std::vector<int> fixedx; // Positions in fixed point units, the pixel positions are converted from them.
+		std::vector<int> fixedy;
+		std::vector<int> directionx; // -1, 0 or 1, the bikes move one unit per subtick.
+		std::vector<int> directiony;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> previousx; // Positions before the last step, for render interpolation.
+		std::vector<float> previousy;
+		std::vector<float> angle;
+		std::vector<unsigned char> alive; // Not std::vector<bool>, its packed bits can't be read in a vectorized loop.
+		std::vector<long long> turntime; // Round subtick of the last turn, later turns can't be rewound past it.
+		std::vector<long long> crashtime; // Round subtick the bike crashed, while it isn't alive.
+		std::vector<TrailBuffer> trail; // Grows by one run per turn, the newest run is extended as the bike moves.
+
+		unsigned int GetCount() const { return (unsigned int)fixedx.size(); }
+	};
+
+	// The state of a round at one tick, for rolling the sim back to it. The trails aren't copied: runs are only
+	// ever added to a trail, and once the bike turns away from a run it never changes again, so a snapshot holds
+	// each trail's added run count and its newest run, and shares the rest with the sim. Saving and restoring cost a few
+	// values per bike however long the trails are.
+	struct SimSnapshot
+	{
+		SimSnapshot();
+
+		unsigned int round; // Snapshots are only restored in the round they were saved in.
+		unsigned int timeline; // And only on the timeline they were saved on, or the one it was restored from.
+		RoundState roundstate;
+		long long time;
+		Timer timer;
+
+		// The bikes' fields, as in BikeStates.
+		std::vector<int> fixedx;
+		std::vector<int> fixedy;
+		std::vector<int> directionx;
+		std::vector<int> directiony;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> previousx;
+		std::vector<float> previousy;
+		std::vector<float> angle;
+		std::vector<unsigned char> alive;
+		std::vector<long long> turntime;
+		std::vector<long long> crashtime;
+
+		std::vector<unsigned long long> runcounts;
+		std::vector<TrailRun> newestruns;
+		std::vector<unsigned long long> trailhashes;
+	};
+
+	// Headless simulation of a Trace Bikes match: bike movement, trails, collision and round state.
+	// It only holds plain data and has no dependency on the window, OpenGL or the GameDev2D services,
+	// so it can be stepped far faster than real time on machines without a display.
+	class TraceSim
+	{
+	public:
+		TraceSim(float arenawidth, float arenaheight, unsigned int playercount = PLAYER_COUNT);
+
+		// Advances the round by delta seconds, rounded to a subtick. Each bike is moved to the time of its turns,
+		// rewinding it if the turn was made before the step started, so the corners land where the bikes were when
+		// the keys were pressed.
+		void Step(double delta, const std::vector<TurnInput>& inputs);
+
+		// Puts the bikes back at their start positions and restarts the countdown. Clearing the trails doesn't free
+		// or touch their runs.
+		void Reset();
+
+		// Limits the trails to their newest runs from the next reset on, the older runs fade. Every trail's memory
+		// is then fixed at the limit plus TRAIL_ROLLBACK_RUNS. A limit of 0 keeps the whole trail, and its memory
+		// grows to the longest trail of the match.
+		void SetTrailLimit(unsigned int limit);
+		unsigned int GetTrailLimit() const;
+
+		// Saves the round's state, reusing the snapshot's memory once it has held a snapshot of this sim.
+		void Save(SimSnapshot& snapshot) const;
+
+		// Rolls the round back to a saved state, cutting the trails back to their length then. The runs laid since
+		// are dropped, and taken out of the arena and the chunks along with the cells and chunks around them, which
+		// are blocked and filed again along the runs kept. Each restore starts a new timeline: snapshots saved on
+		// the timeline restored from stay valid up to the snapshot restored, so it can be restored any number of
+		// times, but snapshots from timelines abandoned before that don't. Returns false and leaves the sim as it
+		// is if the snapshot is from another round or timeline, or if limited trails have recycled the runs it needs.
+		bool Restore(const SimSnapshot& snapshot);
+
+		const BikeStates& GetBikes() const;
+		unsigned int GetPlayerCount() const;
+		RoundState GetRoundState() const;
+
+		// Rounds reset so far, and subticks since the round started.
+		unsigned int GetRound() const;
+		long long GetTime() const;
+
+		// Progress of the countdown before the round starts, from 0 to 1.
+		float GetCountdownPercentage() const;
+
+		float GetArenaWidth() const;
+		float GetArenaHeight() const;
+
+		// Bytes allocated for the bikes' trail runs.
+		size_t GetTrailMemoryUsage() const;
+
+		// The chunks of the arena the trails pass through. After a reset it's out of date until the round starts.
+		const TrailChunks& GetTrailChunks() const;
+
+		// The boxes the live bikes swept over in the last step somebody crashed in, and the pairs of them close enough
+		// to touch.
+		const SweepAndPrune& GetBroadphase() const;
+
+		// The arena with a cell per ARENA_CELL_SIZE, blocked wherever a trail passes through. It's kept up to date as
+		// the trails grow, for the AI's queries, and isn't part of the state hash. A turn rewound into a cell that
+		// was already blocked leaves it blocked.
+		const BitboardArena& GetArena() const;
+
+		// A 64-bit hash of the round and every bike and trail, two sims that got the same inputs have the same hash.
+		// Finished trail runs are hashed once, when the bike turns, so this only costs a few values per bike.
+		unsigned long long GetStateHash() const;
+
+		// Returns wether a box overlaps a trail, leaving out the newest ignoredistance of it, in fixed point units.
+		// The box is tested against every run widened to the trail's width, so the cost grows with the turns, not the distance.
+		static bool IsBoxHittingTrail(const TrailBuffer& trail, int x, int y, int halfsize, int ignoredistance);
+
+	private:
+		void StartRound();
+		void EndRound();
+
+		// Returns false if the bike can't turn that way. The time is in subticks from the start of the step.
+		bool Turn(unsigned int player, Direction direction, long long time);
+		void AddRun(unsigned int player);
+
+		// Before a restore cuts a trail back to a run count, opens the cells of the runs it drops and of the run
+		// that will be newest again, as it is now. That run's chunk box is set to where it reaches now, the next
+		// step files it where it reached then. Returns false if the trail doesn't change.
+		bool DropRuns(unsigned int player, unsigned long long runcount, const TrailRun& newest);
+
+		// After the restore, files and blocks the runs that faded since, and blocks the run that's newest again.
+		void RestoreRuns(unsigned int player, unsigned long long oldest);
+
+		// Opens the cells around a run, from before a rewind or a crash cut it short, and marks the chunks they're
+		// in as dirty.
+		void OpenRun(const TrailRun& run);
+
+		// Files a run in the chunks it passes through.
+		void FileRun(unsigned int player, unsigned long long index);
+
+		// Takes the runs the trails no longer have out of the dirty chunks.
+		void UnfileDroppedRuns();
+
+		// Blocks the cells along the runs filed in the dirty chunks, once the dropped runs are out of them.
+		void BlockDirtyChunks();
+
+		// Moves a bike along its direction, extending its newest trail run, or back if subticks is negative, shortening it.
+		void MoveBike(unsigned int player, long long subticks);
+
+		// Extends the bike's newest trail run, and the box around its trail, to the bike.
+		void UpdateNewestRun(unsigned int player);
+
+		// Converts the bikes' fixed point positions to pixels.
+		void UpdatePixelPositions();
+
+		// Blocks the arena's cells along the trails laid since the last update, or along the whole trails after a
+		// reset, and along the runs around those that faded.
+		void UpdateArena();
+
+		// Files the trails laid since the last update in the chunks they pass through, or the whole trails after a
+		// reset, and takes out the runs that faded.
+		void UpdateChunks();
+
+		// Sweeps the bikes along the motion of the step that ends at stepend. Bikes are out in the order they crash
+		// and put back where they crashed, if that ends the round every bike is put back to that time. Bikes that
+		// crash at the same subtick, head-on or into each other's trails, tie.
+		void CheckBikesIntersections(long long stepend);
+
+		// Returns the box around the bike's motion this step, widened by half the bike's size, so the boxes of two
+		// bikes overlap if their motion comes close enough for either to hit what the other laid this step.
+		BroadphaseBox GetMotionBox(unsigned int player, long long stepend) const;
+
+		// The round is over when one bike is left, or none in a match with a single player.
+		bool IsRoundOver() const;
+
+		// Returns the earliest round subtick, from the start of the bike's motion this step until stepend, the bike
+		// crashes into a trail or leaves the arena. Returns NO_CRASH if it doesn't. Only the runs filed in the
+		// chunks around the bike's motion are checked.
+		long long GetCrashTime(unsigned int player, long long stepend) const;
+
+		// Returns the earliest subtick from start to end that a bike moving along leg leaves the arena.
+		long long GetBoundsCrashTime(const TrailRun& leg, long long start, long long end) const;
+
+		// Returns the earliest subtick from start to end that a bike moving along leg touches the part of run that
+		// was laid by then, less what was laid in the last ignoretime. The bike's motion and the growth of the run
+		// are both linear in time, so the contact is a handful of linear inequalities in t.
+		static long long GetRunCrashTime(const TrailRun& leg, long long start, long long end, const TrailRun& run, long long ignoretime);
+
+		BikeStates m_Bikes;
+		Timer m_Timer;
+		RoundState m_RoundState;
+		unsigned int m_Round; // Rounds reset so far, snapshots of earlier rounds are no longer valid.
+		unsigned int m_TrailLimit; // Set on the trails at the next reset.
+		long long m_Time; // Subticks since the round started.
+		long long m_LongestStep; // In subticks, the furthest a crash can cut back a run filed in the chunks.
+
+		// Restores start a new timeline, the one restored from is valid up to the time restored.
+		unsigned int m_Timeline;
+		unsigned int m_ParentTimeline;
+		long long m_BranchTime;
+		std::vector<long long> m_Progress; // Subticks into the step each bike has been moved to.
+		std::vector<long long> m_SweepStart; // Round subtick each bike's motion this step starts at, before the step if a turn was rewound.
+		std::vector<long long> m_CrashTimes;
+		std::vector<TurnInput> m_Turns; // The step's turns in time order.
+
+		// The bikes' motion boxes, set in steps somebody crashes in. A crash cuts short what the bike laid this step,
+		// only the bikes whose motion came near it have to be swept again.
+		SweepAndPrune m_Broadphase;
+		std::vector<unsigned char> m_IsSweepStale;
+
+		// Hash of each trail's finished runs, every run but the newest.
+		std::vector<unsigned long long> m_TrailHashes;
+
+		BitboardArena m_Arena;
+		std::vector<unsigned long long> m_ArenaRuns; // Added count of each trail's run the arena is blocked along,
+		std::vector<int> m_ArenaColumns; // and the cell it's blocked up to.
+		std::vector<int> m_ArenaRows;
+		bool m_IsArenaStale; // Resets take the trails out of the arena, it's cleared and blocked again whole.
+
+		// The chunks each trail's newest run is filed in, a line of chunks through the chunk it starts in, or a
+		// cross of them if a rewind took it back to its start and it turned. Empty before it's filed at all.
+		TrailChunks m_Chunks;
+		std::vector<unsigned long long> m_ChunkRuns; // Added count of each trail's newest filed run.
+		std::vector<int> m_ChunkMinColumns;
+		std::vector<int> m_ChunkMinRows;
+		std::vector<int> m_ChunkMaxColumns;
+		std::vector<int> m_ChunkMaxRows;
+		bool m_IsChunksStale; // Like the arena, the chunks are emptied and the trails filed again whole.
+
+		// Chunks around the runs a restore drops, or a limited trail lets fade, their runs are blocked again once
+		// the trails are cut back or the step ends.
+		std::vector<unsigned char> m_IsChunkDirty;
+		std::vector<int> m_DirtyChunks;
+		std::vector<unsigned long long> m_OldestRuns; // Each trail's oldest run and run count, for taking runs out of the chunks.
+		std::vector<unsigned long long> m_RunCounts;
+		std::vector<unsigned long long> m_CutOldest; // Each trail's oldest run before the restore, ULLONG_MAX if it doesn't change.
+
+		float m_ArenaWidth;
+		float m_ArenaHeight;
+		int m_FixedArenaWidth;
+		int m_FixedArenaHeight;
+	};
+}
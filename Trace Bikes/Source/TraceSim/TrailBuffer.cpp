@@ -0,0 +1,92 @@
+#include "TrailBuffer.h"
+#include <algorithm>
+
+namespace GameDev2D
+{
+	static size_t RoundUpToPowerOfTwo(size_t value)
+	{
+		size_t power = 1;
+		while (power < value)
+			power *= 2;
+		return power;
+	}
+
+	TrailBuffer::TrailBuffer(size_t limit) :
+		m_Mask(0),
+		m_Limit(0),
+		m_AddedCount(0),
+		m_Count(0),
+		m_OldestSlot(0),
+		m_WrittenCount(0)
+	{
+		SetLimit(limit);
+	}
+
+	void TrailBuffer::SetLimit(size_t limit)
+	{
+		size_t capacity = RoundUpToPowerOfTwo(limit > 0 ? limit + TRAIL_ROLLBACK_RUNS : TRAIL_RUN_CAPACITY);
+		if (capacity != m_Runs.size())
+		{
+			m_Runs = std::vector<TrailRun>(capacity);
+			m_Mask = capacity - 1;
+		}
+
+		m_Limit = limit;
+		Clear();
+	}
+
+	size_t TrailBuffer::GetLimit() const
+	{
+		return m_Limit;
+	}
+
+	void TrailBuffer::Add(const TrailRun& run)
+	{
+		// Without a limit the oldest run is never dropped, the runs move to the same slots in a buffer twice the size.
+		if (m_Limit == 0 && m_AddedCount == m_Runs.size())
+		{
+			m_Runs.resize(m_Runs.size() * 2);
+			m_Mask = m_Runs.size() - 1;
+			m_WrittenCount = m_AddedCount;
+		}
+
+		m_Runs[(size_t)m_AddedCount & m_Mask] = run;
+		SetAddedCount(m_AddedCount + 1);
+		m_WrittenCount = std::max(m_WrittenCount, m_AddedCount);
+	}
+
+	void TrailBuffer::Clear()
+	{
+		SetAddedCount(0);
+		m_WrittenCount = 0;
+	}
+
+	bool TrailBuffer::CanCutBack(unsigned long long addedcount) const
+	{
+		// Every run the trail had then must still be in its slot, not written over by a run added since.
+		unsigned long long oldest = addedcount - GetCount(addedcount);
+		return addedcount <= m_WrittenCount && m_WrittenCount - oldest <= m_Runs.size();
+	}
+
+	void TrailBuffer::CutBack(unsigned long long addedcount)
+	{
+		SetAddedCount(addedcount);
+	}
+
+	size_t TrailBuffer::GetCapacity() const
+	{
+		return m_Runs.size();
+	}
+
+	size_t TrailBuffer::GetCount(unsigned long long addedcount) const
+	{
+		return m_Limit > 0 && addedcount > m_Limit ? m_Limit : (size_t)addedcount;
+	}
+
+	void TrailBuffer::SetAddedCount(unsigned long long addedcount)
+	{
+		m_AddedCount = addedcount;
+		m_Count = GetCount(addedcount);
+		m_OldestSlot = (size_t)(addedcount - m_Count);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	const size_t TRAIL_RUN_CAPACITY = 256; // Runs allocated per bike up front, a trail without a limit doubles it when it fills and keeps it.
+	const size_t TRAIL_ROLLBACK_RUNS = 64; // Runs a limited trail holds on to past its limit, for restoring snapshots.
+
+	// A straight stretch of trail from one turn to the next, or to the bike for the newest run, in fixed point units.
+	struct TrailRun
+	{
+		int startx;
+		int starty;
+		int endx;
+		int endy;
+		long long time; // Round subtick the run was started, the bike lays the rest of it at one unit per subtick.
+
+		// Runs are axis-aligned.
+		int GetLength() const { return abs(endx - startx) + abs(endy - starty); }
+	};
+
+	// A bike's trail runs in a ring buffer allocated up front, adding a run and clearing the trail never allocate
+	// or free anything. Runs are indexed from the oldest the trail still has. A trail with a limit keeps only its
+	// newest runs, the older ones fade and their slots are recycled, so its memory is fixed when the limit is set.
+	// Only a limited trail's memory is bounded: without a limit, the buffer doubles when it fills, and keeps its
+	// size across clears, so it grows to the longest trail laid and allocates again only past that.
+	//
+	// Runs are also counted from the last clear, whatever the trail has dropped since, for cutting the trail back
+	// to an earlier count. Runs past the limit stay in the buffer until their slots are reused, so a limited trail
+	// can still be cut back after up to TRAIL_ROLLBACK_RUNS more runs were added.
+	class TrailBuffer
+	{
+	public:
+		// A limit of 0 keeps every run.
+		TrailBuffer(size_t limit = 0);
+
+		// Reallocates the buffer if the limit needs a different size, and clears the trail.
+		void SetLimit(size_t limit);
+		size_t GetLimit() const;
+
+		// Adds a run after the newest, dropping the oldest past the limit.
+		void Add(const TrailRun& run);
+
+		void Clear();
+
+		// Defined here, the collision checks index the trails in their innermost loops.
+		size_t GetCount() const { return m_Count; }
+		bool IsEmpty() const { return m_Count == 0; }
+
+		// Runs added since the last clear. The oldest run the trail still has was added as run
+		// GetAddedCount() - GetCount().
+		unsigned long long GetAddedCount() const { return m_AddedCount; }
+
+		// Returns wether the trail can be cut back to the runs it had when that many had been added.
+		bool CanCutBack(unsigned long long addedcount) const;
+
+		// Drops the runs added after the count, bringing back runs that had faded since if there's a limit. The
+		// runs brought back are as they were when they were added, the newest may need to be set again.
+		void CutBack(unsigned long long addedcount);
+
+		TrailRun& operator[](size_t index) { return m_Runs[(m_OldestSlot + index) & m_Mask]; }
+		const TrailRun& operator[](size_t index) const { return m_Runs[(m_OldestSlot + index) & m_Mask]; }
+
+		TrailRun& GetNewest() { return m_Runs[(size_t)(m_AddedCount - 1) & m_Mask]; }
+		const TrailRun& GetNewest() const { return m_Runs[(size_t)(m_AddedCount - 1) & m_Mask]; }
+
+		// Runs the buffer has room for.
+		size_t GetCapacity() const;
+
+	private:
+		// The runs the trail has once that many were added.
+		size_t GetCount(unsigned long long addedcount) const;
+		void SetAddedCount(unsigned long long addedcount);
+
+		std::vector<TrailRun> m_Runs; // A power of two in size, a run's slot is its added count masked.
+		size_t m_Mask;
+		size_t m_Limit;
+		unsigned long long m_AddedCount;
+		size_t m_Count;
+		size_t m_OldestSlot; // The oldest run's added count, masked when indexing.
+		unsigned long long m_WrittenCount; // Runs written since the last clear, more than added after a cut back.
+	};
+}
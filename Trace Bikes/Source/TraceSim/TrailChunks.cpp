@@ -0,0 +1,89 @@
+#include "TrailChunks.h"
+#include <algorithm>
+
+namespace GameDev2D
+{
+	TrailChunks::TrailChunks(int width, int height, int chunkshift) :
+		m_UsedCount(0),
+		m_ChunkShift(chunkshift),
+		m_Columns(std::max((width >> chunkshift) + 1, 1)),
+		m_Rows(std::max((height >> chunkshift) + 1, 1))
+	{
+		m_Directory.assign((size_t)m_Columns * m_Rows, -1);
+	}
+
+	void TrailChunks::Clear()
+	{
+		for (size_t index = 0; index < m_UsedCount; index++)
+		{
+			m_Directory[m_UsedCells[index]] = -1;
+			m_Chunks[index].clear();
+		}
+
+		m_UsedCells.clear();
+		m_UsedCount = 0;
+	}
+
+	void TrailChunks::Add(int column, int row, const TrailChunkEntry& entry)
+	{
+		int cell = row * m_Columns + column;
+
+		// A chunk a trail reaches for the first time takes the next list, allocating one only past the most
+		// chunks used so far.
+		if (m_Directory[cell] < 0)
+		{
+			if (m_UsedCount == m_Chunks.size())
+				m_Chunks.push_back(std::vector<TrailChunkEntry>());
+
+			m_Directory[cell] = (int)m_UsedCount++;
+			m_UsedCells.push_back(cell);
+		}
+
+		m_Chunks[m_Directory[cell]].push_back(entry);
+	}
+
+	void TrailChunks::Remove(int column, int row, const std::vector<unsigned long long>& oldestruns, const std::vector<unsigned long long>& runcounts)
+	{
+		int index = m_Directory[row * m_Columns + column];
+		if (index < 0) return;
+
+		// A chunk that empties stays in use, the trail is likely to come back through it.
+		std::vector<TrailChunkEntry>& chunk = m_Chunks[index];
+		chunk.erase(std::remove_if(chunk.begin(), chunk.end(),
+			[&oldestruns, &runcounts](const TrailChunkEntry& entry)
+			{
+				return entry.run < oldestruns[entry.player] || entry.run >= runcounts[entry.player];
+			}), chunk.end());
+	}
+
+	size_t TrailChunks::GetUsedCount() const
+	{
+		return m_UsedCount;
+	}
+
+	size_t TrailChunks::GetChunkCount() const
+	{
+		return m_Directory.size();
+	}
+
+	int TrailChunks::GetColumns() const
+	{
+		return m_Columns;
+	}
+
+	int TrailChunks::GetRows() const
+	{
+		return m_Rows;
+	}
+
+	size_t TrailChunks::GetMemoryUsage() const
+	{
+		size_t bytes = m_Directory.capacity() * sizeof(int) + m_UsedCells.capacity() * sizeof(int) +
+			m_Chunks.capacity() * sizeof(std::vector<TrailChunkEntry>);
+
+		for (const std::vector<TrailChunkEntry>& chunk : m_Chunks)
+			bytes += chunk.capacity() * sizeof(TrailChunkEntry);
+
+		return bytes;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <stddef.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	// A trail run filed in a chunk, by its bike and its added count.
+	struct TrailChunkEntry
+	{
+		unsigned int player;
+		unsigned long long run;
+	};
+
+	// The arena split into square chunks, each listing the trail runs that pass through it, so a collision check
+	// only looks at the runs in the chunks around the bike, however big the arena and however long the trails. A
+	// chunk's list is only allocated once a trail reaches it, and cleared chunks keep their lists for reuse, so the
+	// memory grows with the area the trails cover rather than the arena's.
+	class TrailChunks
+	{
+	public:
+		// The width and height are in fixed point units, the chunks are 2 to the power of chunkshift units square.
+		TrailChunks(int width, int height, int chunkshift);
+
+		// Empties the chunks in use, only visiting those.
+		void Clear();
+
+		// Files a run in a chunk, a run is filed in every chunk it passes through.
+		void Add(int column, int row, const TrailChunkEntry& entry);
+
+		// Takes the runs the trails no longer have out of a chunk, those added before a trail's oldest run or at or
+		// after its run count.
+		void Remove(int column, int row, const std::vector<unsigned long long>& oldestruns, const std::vector<unsigned long long>& runcounts);
+
+		// Defined here, the collision checks look up chunks for every stretch a bike moves. The chunk a position is
+		// in, positions outside the arena are clamped into the chunks along its edges.
+		int GetColumn(int x) const { return std::min(std::max(x >> m_ChunkShift, 0), m_Columns - 1); }
+		int GetRow(int y) const { return std::min(std::max(y >> m_ChunkShift, 0), m_Rows - 1); }
+
+		// Returns the runs filed in a chunk, or nullptr if no trail passes through it.
+		const std::vector<TrailChunkEntry>* GetChunk(int column, int row) const
+		{
+			int index = m_Directory[row * m_Columns + column];
+			return index >= 0 ? &m_Chunks[index] : nullptr;
+		}
+
+		// Chunks a trail passes through, and the chunks the arena has.
+		size_t GetUsedCount() const;
+		size_t GetChunkCount() const;
+		int GetColumns() const;
+		int GetRows() const;
+
+		// Bytes allocated for the directory and the chunks' lists, including lists kept for reuse.
+		size_t GetMemoryUsage() const;
+
+	private:
+		std::vector<int> m_Directory; // Index of each chunk's list in m_Chunks, -1 while no trail passes through it.
+		std::vector<std::vector<TrailChunkEntry>> m_Chunks; // The first m_UsedCount are in use, the rest wait to be reused.
+		std::vector<int> m_UsedCells; // Directory index of each chunk in use, for clearing.
+		size_t m_UsedCount;
+		int m_ChunkShift;
+		int m_Columns;
+		int m_Rows;
+	};
+}
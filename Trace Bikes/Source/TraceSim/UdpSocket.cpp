@@ -0,0 +1,225 @@
+#include "UdpSocket.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#include <mutex>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#endif
+
+namespace GameDev2D
+{
+#ifdef _WIN32
+	// Winsock is started once, by the first socket opened, and left running until the process exits.
+	static bool StartWinsock()
+	{
+		static std::once_flag started;
+		static bool isstarted = false;
+
+		std::call_once(started, []()
+		{
+			WSADATA data;
+			isstarted = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+		});
+
+		return isstarted;
+	}
+
+	static void CloseSocketHandle(intptr_t handle) { closesocket((SOCKET)handle); }
+#else
+	static void CloseSocketHandle(intptr_t handle) { close((int)handle); }
+#endif
+
+	static sockaddr_in ToSocketAddress(const NetAddress& address)
+	{
+		sockaddr_in socketaddress;
+		memset(&socketaddress, 0, sizeof(socketaddress));
+		socketaddress.sin_family = AF_INET;
+		socketaddress.sin_addr.s_addr = htonl(address.ip);
+		socketaddress.sin_port = htons(address.port);
+		return socketaddress;
+	}
+
+	UdpSocket::UdpSocket() :
+		m_Handle(-1),
+		m_Port(0)
+	{
+	}
+
+	UdpSocket::~UdpSocket()
+	{
+		Close();
+	}
+
+	bool UdpSocket::Open(unsigned short port, bool isloopback)
+	{
+		Close();
+
+#ifdef _WIN32
+		if (!StartWinsock()) return false;
+
+		SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (handle == INVALID_SOCKET) return false;
+
+		u_long isnonblocking = 1;
+		bool isready = ioctlsocket(handle, FIONBIO, &isnonblocking) == 0;
+#else
+		int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (handle < 0) return false;
+
+		bool isready = fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+
+		// Thousands of matches send in bursts at every tick, bigger buffers drop fewer of them.
+		int buffersize = 4 * 1024 * 1024;
+		setsockopt(handle, SOL_SOCKET, SO_RCVBUF, (const char*)&buffersize, sizeof(buffersize));
+		setsockopt(handle, SOL_SOCKET, SO_SNDBUF, (const char*)&buffersize, sizeof(buffersize));
+
+		NetAddress address = { isloopback ? NET_LOOPBACK_IP : 0, port };
+		sockaddr_in socketaddress = ToSocketAddress(address);
+		isready = isready && bind(handle, (const sockaddr*)&socketaddress, sizeof(socketaddress)) == 0;
+
+		// The port the system picked, if it was asked for any.
+		socklen_t addresssize = sizeof(socketaddress);
+		isready = isready && getsockname(handle, (sockaddr*)&socketaddress, &addresssize) == 0;
+
+		if (!isready)
+		{
+			CloseSocketHandle((intptr_t)handle);
+			return false;
+		}
+
+		m_Handle = (intptr_t)handle;
+		m_Port = ntohs(socketaddress.sin_port);
+		return true;
+	}
+
+	void UdpSocket::Close()
+	{
+		if (m_Handle == -1) return;
+
+		CloseSocketHandle(m_Handle);
+		m_Handle = -1;
+		m_Port = 0;
+	}
+
+	bool UdpSocket::IsOpen() const
+	{
+		return m_Handle != -1;
+	}
+
+	unsigned short UdpSocket::GetPort() const
+	{
+		return m_Port;
+	}
+
+	bool UdpSocket::SendTo(const NetAddress& address, const void* data, size_t size)
+	{
+		sockaddr_in socketaddress = ToSocketAddress(address);
+
+#ifdef _WIN32
+		return sendto((SOCKET)m_Handle, (const char*)data, (int)size, 0, (const sockaddr*)&socketaddress, sizeof(socketaddress)) == (int)size;
+#else
+		return sendto((int)m_Handle, data, size, 0, (const sockaddr*)&socketaddress, sizeof(socketaddress)) == (ssize_t)size;
+#endif
+	}
+
+	int UdpSocket::ReceiveFrom(NetAddress& address, void* buffer, size_t capacity)
+	{
+		sockaddr_in socketaddress;
+		socklen_t addresssize = sizeof(socketaddress);
+
+#ifdef _WIN32
+		// Windows hands back the port unreachable a datagram sent earlier brought back as an error, it's skipped.
+		int size;
+		do
+		{
+			size = recvfrom((SOCKET)m_Handle, (char*)buffer, (int)capacity, 0, (sockaddr*)&socketaddress, &addresssize);
+		}
+		while (size < 0 && WSAGetLastError() == WSAECONNRESET);
+
+		if (size < 0 && WSAGetLastError() == WSAEMSGSIZE) size = (int)capacity;
+#else
+		int size = (int)recvfrom((int)m_Handle, buffer, capacity, MSG_TRUNC, (sockaddr*)&socketaddress, &addresssize);
+		if (size > (int)capacity) size = (int)capacity;
+#endif
+		if (size < 0) return -1;
+
+		address.ip = ntohl(socketaddress.sin_addr.s_addr);
+		address.port = ntohs(socketaddress.sin_port);
+		return size;
+	}
+
+	intptr_t UdpSocket::GetHandle() const
+	{
+		return m_Handle;
+	}
+
+	UdpPoller::UdpPoller() :
+		m_Epoll(-1)
+	{
+#ifdef __linux__
+		m_Epoll = epoll_create1(0);
+#endif
+	}
+
+	UdpPoller::~UdpPoller()
+	{
+#ifdef __linux__
+		if (m_Epoll >= 0)
+			close(m_Epoll);
+#endif
+	}
+
+	void UdpPoller::Add(const UdpSocket& socket)
+	{
+		m_Handles.push_back(socket.GetHandle());
+
+#ifdef __linux__
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = (int)socket.GetHandle();
+		epoll_ctl(m_Epoll, EPOLL_CTL_ADD, (int)socket.GetHandle(), &event);
+#endif
+	}
+
+	int UdpPoller::Wait(int timeout)
+	{
+#ifdef __linux__
+		// The sockets that are ready aren't needed, they're all drained until empty.
+		epoll_event events[16];
+		int ready = epoll_wait(m_Epoll, events, 16, timeout);
+		return ready > 0 ? ready : 0;
+#else
+#ifdef _WIN32
+		std::vector<WSAPOLLFD> sockets(m_Handles.size());
+#else
+		std::vector<pollfd> sockets(m_Handles.size());
+#endif
+		for (size_t index = 0; index < m_Handles.size(); index++)
+		{
+			sockets[index].fd = (decltype(sockets[index].fd))m_Handles[index];
+			sockets[index].events = POLLIN;
+			sockets[index].revents = 0;
+		}
+
+#ifdef _WIN32
+		int ready = WSAPoll(sockets.data(), (ULONG)sockets.size(), timeout);
+#else
+		int ready = poll(sockets.data(), (nfds_t)sockets.size(), timeout);
+#endif
+		return ready > 0 ? ready : 0;
+#endif
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace GameDev2D
+{
+	const unsigned int NET_LOOPBACK_IP = 0x7F000001; // 127.0.0.1
+	const size_t NET_MAX_DATAGRAM = 1200; // Datagrams this size or smaller fit any path's MTU.
+
+	// An IPv4 address and port, in host byte order.
+	struct NetAddress
+	{
+		unsigned int ip;
+		unsigned short port;
+	};
+
+	inline bool IsSameAddress(const NetAddress& a, const NetAddress& b) { return a.ip == b.ip && a.port == b.port; }
+
+	// A non-blocking UDP socket over IPv4.
+	class UdpSocket
+	{
+	public:
+		UdpSocket();
+		~UdpSocket();
+
+		// Binds to a port on the loopback address, or on every address. Port 0 takes any free port. Returns false if
+		// the socket couldn't be opened or bound.
+		bool Open(unsigned short port, bool isloopback);
+		void Close();
+
+		bool IsOpen() const;
+
+		// The port the socket is bound to.
+		unsigned short GetPort() const;
+
+		// Returns false if the datagram wasn't sent. A full send buffer drops it, like a network would.
+		bool SendTo(const NetAddress& address, const void* data, size_t size);
+
+		// Returns the size of the next datagram waiting, or -1 if there's none or the socket failed. Datagrams bigger
+		// than the buffer are cut short.
+		int ReceiveFrom(NetAddress& address, void* buffer, size_t capacity);
+
+		// The socket's handle, a SOCKET on Windows and a file descriptor elsewhere.
+		intptr_t GetHandle() const;
+
+	private:
+		UdpSocket(const UdpSocket&);
+		UdpSocket& operator=(const UdpSocket&);
+
+		intptr_t m_Handle; // -1 while closed.
+		unsigned short m_Port;
+	};
+
+	// Waits on a set of sockets until one of them has a datagram waiting. It's epoll on Linux, the kernel keeps the
+	// set and only hands back the sockets that are ready. Elsewhere it's poll, or WSAPoll on Windows, which pass the
+	// whole set on every wait.
+	class UdpPoller
+	{
+	public:
+		UdpPoller();
+		~UdpPoller();
+
+		// The socket must stay open while it's in the set.
+		void Add(const UdpSocket& socket);
+
+		// Waits up to timeout milliseconds, 0 doesn't wait. Returns the sockets that are ready, or 0 on a timeout.
+		int Wait(int timeout);
+
+	private:
+		UdpPoller(const UdpPoller&);
+		UdpPoller& operator=(const UdpPoller&);
+
+		std::vector<intptr_t> m_Handles;
+		int m_Epoll; // -1 where there's no epoll.
+	};
+}
@@ -0,0 +1,147 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace GameDev2D
+{
+	// The pool and queue of the worker running on this thread, tasks submitted from a task go to its own queue.
+	static thread_local const WorkStealingPool* s_WorkerPool = nullptr;
+	static thread_local unsigned int s_WorkerIndex = 0;
+
+	WorkStealingPool::WorkStealingPool(unsigned int threadcount) :
+		m_QueuedCount(0),
+		m_PendingCount(0),
+		m_NextWorker(0),
+		m_StealCount(0),
+		m_IsStopping(false)
+	{
+		if (threadcount == 0)
+			threadcount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (unsigned int index = 0; index < threadcount; index++)
+			m_Workers.push_back(new Worker());
+
+		for (unsigned int index = 0; index < threadcount; index++)
+			m_Threads.push_back(std::thread(&WorkStealingPool::Run, this, index));
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		Wait();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_TaskQueued.notify_all();
+
+		for (std::thread& thread : m_Threads)
+			thread.join();
+
+		for (Worker* worker : m_Workers)
+			delete worker;
+	}
+
+	void WorkStealingPool::Submit(const Task& task)
+	{
+		unsigned int index = s_WorkerPool == this ? s_WorkerIndex : m_NextWorker++ % m_Workers.size();
+		m_PendingCount++;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Workers[index]->mutex);
+			m_Workers[index]->tasks.push_back(task);
+		}
+
+		// Counted under the pool's mutex, so a worker can't miss it between checking the count and sleeping.
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_QueuedCount++;
+		}
+		m_TaskQueued.notify_one();
+	}
+
+	void WorkStealingPool::Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_TasksDone.wait(lock, [this] { return m_PendingCount.load() == 0; });
+	}
+
+	unsigned int WorkStealingPool::GetThreadCount() const
+	{
+		return (unsigned int)m_Threads.size();
+	}
+
+	unsigned long long WorkStealingPool::GetStealCount() const
+	{
+		return m_StealCount.load();
+	}
+
+	void WorkStealingPool::Run(unsigned int index)
+	{
+		s_WorkerPool = this;
+		s_WorkerIndex = index;
+
+		unsigned int seed = index + 1;
+		Task task;
+
+		while (true)
+		{
+			if (PopTask(index, task) || StealTask(index, task, seed))
+			{
+				task();
+				task = nullptr;
+
+				if (m_PendingCount.fetch_sub(1) == 1)
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_TasksDone.notify_all();
+				}
+				continue;
+			}
+
+			// The count can be ahead of the queues for a moment, the worker then looks through them again.
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_TaskQueued.wait(lock, [this] { return m_IsStopping || m_QueuedCount.load() > 0; });
+			if (m_IsStopping && m_QueuedCount.load() <= 0)
+				return;
+		}
+	}
+
+	bool WorkStealingPool::PopTask(unsigned int index, Task& task)
+	{
+		Worker* worker = m_Workers[index];
+		std::lock_guard<std::mutex> lock(worker->mutex);
+		if (worker->tasks.empty()) return false;
+
+		task = std::move(worker->tasks.back());
+		worker->tasks.pop_back();
+		m_QueuedCount--;
+		return true;
+	}
+
+	bool WorkStealingPool::StealTask(unsigned int index, Task& task, unsigned int& seed)
+	{
+		unsigned int count = (unsigned int)m_Workers.size();
+
+		// Starting at a random victim, so the idle workers don't all line up on the same queue.
+		seed = seed * 1664525u + 1013904223u;
+		unsigned int start = (seed >> 8) % count;
+
+		for (unsigned int offset = 0; offset < count; offset++)
+		{
+			unsigned int victim = (start + offset) % count;
+			if (victim == index) continue;
+
+			Worker* worker = m_Workers[victim];
+			std::lock_guard<std::mutex> lock(worker->mutex);
+			if (worker->tasks.empty()) continue;
+
+			task = std::move(worker->tasks.front());
+			worker->tasks.pop_front();
+			m_QueuedCount--;
+			m_StealCount++;
+			return true;
+		}
+
+		return false;
+	}
+}
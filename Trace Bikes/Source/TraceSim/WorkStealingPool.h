@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GameDev2D
+{
+	// A fixed set of worker threads, each with its own queue of tasks. Submitted tasks are handed to the queues in
+	// turn, a worker takes its newest task first and, once its queue is empty, steals the oldest task of another
+	// worker. Tasks that take longer than others don't leave the rest of the workers idle, and the workers only
+	// contend on a queue when one of them runs dry.
+	class WorkStealingPool
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		// A thread count of 0 starts one worker per hardware thread.
+		WorkStealingPool(unsigned int threadcount = 0);
+		~WorkStealingPool();
+
+		// Can be called from any thread, including from a task.
+		void Submit(const Task& task);
+
+		// Blocks until every task submitted so far has finished. Must not be called from a task.
+		void Wait();
+
+		unsigned int GetThreadCount() const;
+
+		// Tasks taken from another worker's queue since the pool started.
+		unsigned long long GetStealCount() const;
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void Run(unsigned int index);
+
+		// Take the newest task from the worker's own queue, or the oldest task from another's.
+		bool PopTask(unsigned int index, Task& task);
+		bool StealTask(unsigned int index, Task& task, unsigned int& seed);
+
+		std::vector<Worker*> m_Workers; // Workers hold a mutex, they can't be moved when the vector grows.
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex; // Guards the waits on the condition variables.
+		std::condition_variable m_TaskQueued;
+		std::condition_variable m_TasksDone;
+		std::atomic<int> m_QueuedCount; // Tasks in the queues, a worker sleeps until there's one.
+		std::atomic<unsigned int> m_PendingCount; // Tasks submitted and not finished.
+		std::atomic<unsigned int> m_NextWorker;
+		std::atomic<unsigned long long> m_StealCount;
+		bool m_IsStopping;
+	};
+}
@@ -1,5 +1,7 @@
 #include <GameDev2D.h>
 #include "Game.h"
+#include "Benchmarks/Benchmarks.h"
+#include "TraceSim/MatchServer.h"
 
 // Function signatures.
 void Init();
@@ -8,14 +10,22 @@ void Update(double delta);
 void Draw();
 void HandleLeftMouseClick(float mouseX, float mouseY);
 void HandleRightMouseClick(float mouseX, float mouseY);
+void HandleKeyDown(GameDev2D::Keyboard::Key key);
 void HandleKeyPress(GameDev2D::Keyboard::Key key);
 
 GameDev2D::Game* game = nullptr;
 
 int WINAPI WinMain(HINSTANCE aCurrentInstance, HINSTANCE aPreviousInstance, LPSTR aCommandLine, int aCommandShow)
 {
-    GameDev2D::Run(Init, Shutdown, Update, Draw);
-    return 0;
+	// Benchmarks and the headless server run instead of the game when requested on the command line.
+	if (GameDev2D::RunBenchmarkFromCommandLine(aCommandLine))
+		return 0;
+
+	if (GameDev2D::RunServerFromCommandLine(aCommandLine))
+		return 0;
+
+	GameDev2D::Run(Init, Shutdown, Update, Draw);
+	return 0;
 }
 
 void Init()
@@ -23,6 +33,7 @@ void Init()
 	// Register input callbacks.
 	GameDev2D::RegisterLeftMouseClickCallback(HandleLeftMouseClick);
 	GameDev2D::RegisterRightMouseClickCallback(HandleRightMouseClick);
+	GameDev2D::RegisterKeyDownCallback(HandleKeyDown);
 	GameDev2D::RegisterKeyPressedCallback(HandleKeyPress);
 
 	// Create the game instance.
@@ -70,6 +81,14 @@ void HandleRightMouseClick(float mouseX, float mouseY)
 	}
 }
 
+void HandleKeyDown(GameDev2D::Keyboard::Key key)
+{
+	if (game != nullptr)
+	{
+		game->HandleKeyDown(key);
+	}
+}
+
 void HandleKeyPress(GameDev2D::Keyboard::Key key)
 {
 	if (game != nullptr)